@@ -0,0 +1,226 @@
+// Host microbenchmarks for the hot kernels: BMP row decoding, page-band
+// rendering, status bar layout, JSON parsing and NDEF. Built by
+// `pio run -e native-bench` in place of main.cpp; see bench/README.md.
+#include <Arduino.h>
+#include <HostSim.h>
+#include <MemoryStream.h>
+#include <stdio.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "AllocCounter.h"
+#include "BMPHandler.h"
+#include "DisplayManager.h"
+#include "FetchScheduler.h"
+#include "Location.h"
+#include "Ndef.h"
+#include "NTP.h"
+#include "OpenWeather.h"
+#include "QRCodeManager.h"
+#include "fixtures.h"
+
+// Globals main.cpp normally provides to the display code
+LocationManager locationManager;
+NTPClient ntpClient;
+OpenWeather weather;
+FetchScheduler scheduler;
+int srcWeather = -1;
+
+static const int ROWS = 420;                       // Content area height
+static const int ROW_PIXELS = 800;
+static const int ROW_BYTES_1BIT = 100;             // 800 bits, already a multiple of 4
+
+struct BenchResult {
+    const char* name;
+    uint32_t iterations;      // Per timed batch
+    double nsPerOp;           // Median over the batches
+    double nsPerPixel;        // 0 when the kernel has no pixel count
+    double mbPerSec;          // 0 when the kernel has no byte count
+    double allocsPerRun;
+};
+
+static std::vector<BenchResult> results;
+static const char* benchFilter = nullptr;
+static uint32_t batchMs = 50;
+static const int BATCHES = 7;
+
+static uint64_t hostNanos() {
+    // Host clock on purpose: millis() is scaled by SIM_TIME_SCALE
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Runs body in batches of at least batchMs and records the median time per call.
+// pixels/bytes describe one call and turn the time into ns/pixel and MB/s.
+template <typename F>
+static void bench(const char* name, uint32_t pixels, uint32_t bytes, F body) {
+    if (benchFilter && !strstr(name, benchFilter)) return;
+
+    body();   // Warm-up: first-call statics (JSON filters, font lookups) are not measured
+
+    uint32_t iterations = 1;
+    for (;;) {
+        uint64_t start = hostNanos();
+        for (uint32_t i = 0; i < iterations; i++) body();
+        if (hostNanos() - start >= (uint64_t)batchMs * 1000000 / 4 || iterations >= (1u << 24)) break;
+        iterations *= 2;
+    }
+    iterations *= 4;
+
+    double perOp[BATCHES];
+    uint32_t allocs = 0;
+    for (int b = 0; b < BATCHES; b++) {
+        AllocCounter::begin();
+        uint64_t start = hostNanos();
+        for (uint32_t i = 0; i < iterations; i++) body();
+        perOp[b] = (double)(hostNanos() - start) / iterations;
+        allocs += AllocCounter::end();
+    }
+    std::sort(perOp, perOp + BATCHES);
+
+    BenchResult r;
+    r.name = name;
+    r.iterations = iterations;
+    r.nsPerOp = perOp[BATCHES / 2];
+    r.nsPerPixel = pixels ? r.nsPerOp / pixels : 0;
+    r.mbPerSec = bytes ? bytes / r.nsPerOp * 1000.0 : 0;    // bytes/ns * 1e9 / 1e6
+    r.allocsPerRun = (double)allocs / ((double)iterations * BATCHES);
+    results.push_back(r);
+
+    HostSim::muteSerial(false);
+    Serial.printf("%-22s %10.0f ns/op", name, r.nsPerOp);
+    if (pixels) Serial.printf(" %8.2f ns/px", r.nsPerPixel);
+    if (bytes) Serial.printf(" %8.1f MB/s", r.mbPerSec);
+    Serial.printf(" %6.2f allocs/run\n", r.allocsPerRun);
+    HostSim::muteSerial(true);
+}
+
+// Tag memory (TLV from page 4) -> first URI record, as NFCManager reads it back
+static bool decodeUri(const uint8_t* mem, size_t length, char* uri, size_t uriSize) {
+    const uint8_t* message;
+    size_t messageLength;
+    if (!NdefReader::findMessage(mem, length, message, messageLength)) return false;
+    NdefReader reader(message, messageLength);
+    NdefRecord record;
+    while (reader.next(record)) {
+        if (ndefDecodeUri(record, uri, uriSize)) return true;
+    }
+    return false;
+}
+
+// A fixture that stops parsing would turn its benchmark into an error-path timing
+static void requireFixture(bool ok, const char* what) {
+    if (ok) return;
+    HostSim::muteSerial(false);
+    Serial.printf("❌ Fixture check failed: %s\n", what);
+    fflush(stdout);
+    _exit(1);
+}
+
+static bool writeJson(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    struct utsname host;
+    uname(&host);
+    fprintf(f, "{\n  \"schema\": 1,\n  \"host\": \"%s %s\",\n  \"compiler\": \"%s\",\n  \"batch_ms\": %u,\n",
+            host.machine, host.release, __VERSION__, batchMs);
+    fprintf(f, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"iterations\": %u, \"ns_per_op\": %.1f, \"ns_per_pixel\": %.4f, "
+                   "\"mb_per_s\": %.2f, \"allocs_per_run\": %.3f}%s\n",
+                r.name, r.iterations, r.nsPerOp, r.nsPerPixel, r.mbPerSec, r.allocsPerRun,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+void setup() {
+    setenv("SIM_FRAMES", "0", 0);    // Frame dumps would dominate the render timings
+    benchFilter = getenv("BENCH_FILTER");
+    batchMs = (uint32_t)atol(HostSim::env("BENCH_BATCH_MS", "50"));
+    const char* jsonPath = HostSim::env("BENCH_JSON", "bench.json");
+
+    Serial.printf("⏱️ Benchmarks: %d batches of >= %u ms each, median reported\n", BATCHES, batchMs);
+    HostSim::muteSerial(true);
+    display.init(0);
+    display.setRotation(0);
+
+    // ---- BMP row kernels (one content area worth of rows, first page band active) ----
+    std::vector<uint8_t> rows1(ROWS * ROW_BYTES_1BIT);
+    std::vector<uint8_t> rows8(ROWS * ROW_PIXELS);
+    fillFixture(rows1.data(), rows1.size(), 0x1badb002);
+    fillFixture(rows8.data(), rows8.size(), 0x8badf00d);
+
+    display.setFullWindow();
+    display.firstPage();
+    bench("bmp_row_1bit", ROWS * ROW_PIXELS, rows1.size(), [&] {
+        for (int y = ROWS - 1; y >= 0; y--) {
+            bmpDrawRow1(display, &rows1[(ROWS - 1 - y) * ROW_BYTES_1BIT], ROW_PIXELS, STATUS_BAR_HEIGHT + y);
+        }
+    });
+    bench("gray_threshold_8bit", ROWS * ROW_PIXELS, rows8.size(), [&] {
+        for (int y = 0; y < ROWS; y++) bmpDrawRow8(display, &rows8[y * ROW_PIXELS], ROW_PIXELS, MAIN_CONTENT_Y + y);
+    });
+
+    // ---- Status bar layout (fonts, text bounds, icons) into the current page ----
+    bench("status_bar_layout", display.width() * STATUS_BAR_HEIGHT, 0, [] {
+        updateStatusBar(false);
+    });
+
+    // ---- Full page-band renders, elision defeated so every call draws all pages ----
+    const uint32_t screenPixels = (uint32_t)display.width() * display.height();
+    bench("render_dashboard", screenPixels, 0, [] {
+        invalidateFrame();
+        showDashboard();
+    });
+    bench("render_qrcode", screenPixels, 0, [] {
+        invalidateFrame();
+        showQRCode("WIFI:T:nopass;S:ThumbstackTech;;");
+    });
+    bench("render_welcome", screenPixels, 0, [] {
+        invalidateFrame();
+        showWelcomeMessage();
+    });
+
+    // ---- JSON parsing (streamed with the production filters) ----
+    MemoryStream weatherProbe(WEATHER_JSON, sizeof(WEATHER_JSON) - 1);
+    MemoryStream locationProbe(LOCATION_JSON, sizeof(LOCATION_JSON) - 1);
+    requireFixture(weather.parseWeatherData(weatherProbe), "weather JSON");
+    requireFixture(locationManager.parseIPGeolocation(locationProbe), "location JSON");
+    bench("json_weather", 0, sizeof(WEATHER_JSON) - 1, [] {
+        MemoryStream body(WEATHER_JSON, sizeof(WEATHER_JSON) - 1);
+        weather.parseWeatherData(body);
+    });
+    bench("json_location", 0, sizeof(LOCATION_JSON) - 1, [] {
+        MemoryStream body(LOCATION_JSON, sizeof(LOCATION_JSON) - 1);
+        locationManager.parseIPGeolocation(body);
+    });
+
+    // ---- NDEF ----
+    static uint8_t tlv[256];
+    NdefWriter sizing(tlv, sizeof(tlv));
+    sizing.addUri(NDEF_URL);
+    const size_t tlvLength = sizing.finish();
+    char uri[128];
+    requireFixture(tlvLength && decodeUri(tlv, tlvLength, uri, sizeof(uri)) && !strcmp(uri, NDEF_URL), "NDEF URI");
+    bench("ndef_encode", 0, tlvLength, [] {
+        NdefWriter writer(tlv, sizeof(tlv));
+        writer.addUri(NDEF_URL);
+        writer.finish();
+    });
+    bench("ndef_decode", 0, tlvLength, [&] {
+        decodeUri(tlv, tlvLength, uri, sizeof(uri));
+    });
+
+    HostSim::muteSerial(false);
+    bool written = writeJson(jsonPath);
+    Serial.printf(written ? "✅ Results written to %s\n" : "❌ Could not write %s\n", jsonPath);
+    fflush(stdout);
+    _exit(written ? 0 : 1);
+}
+
+void loop() {}
@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Fixed inputs for bench.cpp. Change them only together with the baseline
+// results, otherwise runs stop being comparable.
+
+// Full api.openweathermap.org /data/2.5/weather reply (metric)
+static const char WEATHER_JSON[] = R"({"coord":{"lon":4.8897,"lat":52.374},)"
+    R"("weather":[{"id":803,"main":"Clouds","description":"broken clouds","icon":"04d"}],)"
+    R"("base":"stations","main":{"temp":14.2,"feels_like":13.61,"temp_min":13.12,"temp_max":15.03,)"
+    R"("pressure":1016,"humidity":71,"sea_level":1016,"grnd_level":1015},"visibility":10000,)"
+    R"("wind":{"speed":5.66,"deg":240,"gust":8.23},"clouds":{"all":75},"dt":1729330800,)"
+    R"("sys":{"type":2,"id":2012219,"country":"NL","sunrise":1729318261,"sunset":1729355537},)"
+    R"("timezone":7200,"id":2759794,"name":"Amsterdam","cod":200})";
+
+// Full ipinfo.io/<ip>/json reply
+static const char LOCATION_JSON[] = R"({"ip":"203.0.113.7","hostname":"host-203-0-113-7.example.net",)"
+    R"("city":"Amsterdam","region":"North Holland","country":"NL","loc":"52.3740,4.8897",)"
+    R"("org":"AS64496 Example Networks B.V.","postal":"1012","timezone":"Europe/Amsterdam",)"
+    R"("readme":"https://ipinfo.io/missingauth"})";
+
+// A typical provisioned URL (the NFC tag and the Type 4 emulation carry this)
+static const char NDEF_URL[] = "https://dash.example.com/device/ESP32-4C11AE6B7F20?token=9f86d081884c7d65";
+
+// Deterministic pseudo-random bytes (xorshift32), so fixtures are identical on every host
+static inline void fillFixture(uint8_t* buf, size_t len, uint32_t seed) {
+    for (size_t i = 0; i < len; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        buf[i] = (uint8_t)seed;
+    }
+}
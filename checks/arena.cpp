@@ -0,0 +1,129 @@
+// Refresh-arena use of each view against its ArenaBudget. Every view runs
+// inside an outer ArenaScope whose used() takes in the view's own nested
+// scope, so this is the peak the view's scope measured, not the static sum.
+#include <SPIFFS.h>
+#include <string>
+#include <vector>
+#include "800x420.h"
+#include "800x480.h"
+#include "BMPHandler.h"
+#include "calender.h"
+#include "check.h"
+#include "Config.h"
+#include "ContentSync.h"
+#include "DisplayManager.h"
+#include "Location.h"
+#include "OpenWeather.h"
+#include "RefreshArena.h"
+#include "SelfBench.h"
+
+// Fields the filters keep, at the longest the device stores
+static const char WEATHER_THREE_CONDITIONS[] = R"({"weather":[{"id":500,"main":"Rain","icon":"10d"},)"
+    R"({"id":701,"main":"Mist","icon":"50d"},{"id":741,"main":"Fog","icon":"50d"}],)"
+    R"("main":{"temp":-12.75,"humidity":100},"name":"Longyearbyen","cod":200})";
+static const char LOCATION_LONGEST[] = R"({"ip":"203.0.113.7","city":"Llanfairpwllgwyngyllgogerychwyrn",)"
+    R"("region":"Isle of Anglesey, North Wales, UK","country":"GB","loc":"-53.2200000,-124.1700000"})";
+static const char MANIFEST[] = R"({"ttl":900,"pages":[)"
+    R"({"id":"content","url":"/image_800x420.bmp","hash":"9f2c4e1a","size":33662,"format":"bmp1","ttl":600,"dwell":30},)"
+    R"({"id":"calendar","url":"/calendar.bmp","hash":"51be07d3","size":48062,"ttl":3600,"dwell":60}]})";
+
+// 1-bit BMP (bottom-up, white = 1) with a black frame
+static std::string bmp1(int width, int height) {
+    const int rowSize = ((width + 31) / 32) * 4;
+    BMPHeader header = {};
+    header.signature = 0x4D42;
+    header.dataOffset = sizeof(BMPHeader) + 24 + 8;    // Rest of BITMAPINFOHEADER + 2-entry palette
+    header.fileSize = header.dataOffset + rowSize * height;
+    header.headerSize = 40;
+    header.width = width;
+    header.height = height;
+    header.planes = 1;
+    header.bitsPerPixel = 1;
+
+    std::string file((const char*)&header, sizeof(header));
+    file.append(24, '\0');
+    file.append("\0\0\0\0\xFF\xFF\xFF\0", 8);
+    std::vector<char> row(rowSize);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            bool black = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+            if (black) row[x / 8] &= ~(0x80 >> (x % 8));
+            else row[x / 8] |= 0x80 >> (x % 8);
+        }
+        file.append(row.data(), rowSize);
+    }
+    return file;
+}
+
+static bool parseWeather() {
+    OpenWeather w;
+    MemoryStream body(WEATHER_THREE_CONDITIONS);
+    return w.parseWeatherData(body);
+}
+
+static bool parseLocation() {
+    LocationManager l;
+    MemoryStream body(LOCATION_LONGEST);
+    return l.parseIPGeolocation(body);
+}
+
+static bool downloadContent() { return ContentManager::downloadContentBMP(CONTENT_BMP_URL_DEFAULT); }
+static bool downloadCalendar() { return CalendarManager::downloadCalendarBMP(CALENDAR_BMP_URL_DEFAULT); }
+static bool downloadFullScreen() { return FullScreenManager::downloadFullScreenBMP(FULLSCREEN_BMP_URL_DEFAULT); }
+static bool drawContent() { ContentManager::displayContent(); return true; }
+static bool drawCalendar() { CalendarManager::displayCalendar(); return true; }
+static bool drawFullScreen() { FullScreenManager::displayFullScreen(); return true; }
+static bool benchDisplay() { return SelfBench::run("bench display"); }
+static bool benchSpiffs() { SelfBench::run("bench spiffs"); return true; }
+static bool benchHttp() { SelfBench::run("bench http"); return true; }
+
+struct ArenaView {
+    const char* name;
+    bool (*run)();
+    size_t budget;
+};
+
+// Downloads first: the page draws read the files they leave on SPIFFS.
+// The streamed dashboard (ArenaBudget::DASHBOARD) is inline in main.cpp and
+// is not linked into the checks.
+static const ArenaView VIEWS[] = {
+    {"content download",    downloadContent,           ArenaBudget::PAGE_DOWNLOAD},
+    {"calendar download",   downloadCalendar,          ArenaBudget::PAGE_DOWNLOAD},
+    {"fullscreen download", downloadFullScreen,        ArenaBudget::PAGE_DOWNLOAD},
+    {"content draw",        drawContent,               ArenaBudget::PAGE_DRAW},
+    {"calendar draw",       drawCalendar,              ArenaBudget::PAGE_DRAW},
+    {"fullscreen draw",     drawFullScreen,            ArenaBudget::PAGE_DRAW},
+    {"manifest",            ContentSync::fetchManifest, ArenaBudget::MANIFEST},
+    {"location",            parseLocation,             ArenaBudget::LOCATION},
+    {"weather",             parseWeather,              ArenaBudget::WEATHER},
+    {"bench display",       benchDisplay,              ArenaBudget::SELF_BENCH},
+    {"bench spiffs",        benchSpiffs,               ArenaBudget::PAGE_DOWNLOAD},
+    {"bench http",          benchHttp,                 ArenaBudget::PAGE_DOWNLOAD},
+};
+
+void checkArenaBudgets() {
+    display.init(0);
+    SPIFFS.begin(true);
+    FixtureServer::serve("/image_800x420.bmp", bmp1(800, 420));
+    FixtureServer::serve("/calendar.bmp", bmp1(800, 480));
+    FixtureServer::serve("/image_800x480.bmp", bmp1(800, 480));
+    FixtureServer::serve("/manifest.json", MANIFEST);
+
+    for (const ArenaView& view : VIEWS) {
+        size_t used;
+        bool ok;
+        {
+            ArenaScope outer("checks", RefreshArena::CAPACITY);
+            ok = view.run();
+            used = outer.used();
+        }
+        if (!ok) Check::fail(__FILE__, __LINE__, "%s did not complete", view.name);
+        else if (!used) Check::fail(__FILE__, __LINE__, "%s did not use the arena", view.name);
+        else if (used > view.budget) {
+            Check::fail(__FILE__, __LINE__, "%s used %u arena bytes, budget %u", view.name, (unsigned)used,
+                        (unsigned)view.budget);
+        } else Check::pass();
+    }
+    CHECK_EQ(RefreshArena::used(), 0);
+    FixtureServer::clear();
+}
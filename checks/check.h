@@ -0,0 +1,74 @@
+#pragma once
+// Assertions for the host checks. A failed check prints where it is and the
+// values involved, and the suite carries on; checks.cpp counts the failures.
+#include <Arduino.h>
+#include <MemoryStream.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+class Check {
+public:
+    static void pass() { _passed++; }
+    static void fail(const char* file, int line, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+    static void bytes(const char* file, int line, const char* what, const uint8_t* actual, size_t actualLength,
+                      const uint8_t* expected, size_t expectedLength);
+
+    static void reset() { _passed = _failed = 0; }
+    static unsigned passed() { return _passed; }
+    static unsigned failed() { return _failed; }
+
+private:
+    static unsigned _passed;
+    static unsigned _failed;
+};
+
+#define CHECK(cond) \
+    do { \
+        if (cond) Check::pass(); \
+        else Check::fail(__FILE__, __LINE__, "%s", #cond); \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        long long actual_ = (long long)(actual), expected_ = (long long)(expected); \
+        if (actual_ == expected_) Check::pass(); \
+        else Check::fail(__FILE__, __LINE__, "%s is %lld, expected %lld", #actual, actual_, expected_); \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        double actual_ = (actual), expected_ = (expected); \
+        if (fabs(actual_ - expected_) <= (tolerance)) Check::pass(); \
+        else Check::fail(__FILE__, __LINE__, "%s is %g, expected %g", #actual, actual_, expected_); \
+    } while (0)
+
+#define CHECK_STR(actual, expected) \
+    do { \
+        const char* actual_ = (actual); \
+        const char* expected_ = (expected); \
+        if (actual_ && !strcmp(actual_, expected_)) Check::pass(); \
+        else Check::fail(__FILE__, __LINE__, "%s is \"%s\", expected \"%s\"", #actual, actual_ ? actual_ : "(null)", \
+                         expected_); \
+    } while (0)
+
+#define CHECK_BYTES(actual, actualLength, expected, expectedLength) \
+    Check::bytes(__FILE__, __LINE__, #actual, (const uint8_t*)(actual), (actualLength), \
+                 (const uint8_t*)(expected), (expectedLength))
+
+// Loopback HTTP server that SIM_HTTP points at; serves the bodies the suites
+// register by path and 404 for anything else
+class FixtureServer {
+public:
+    static bool start();   // Before the first HTTP request
+    static void serve(const char* path, const std::string& body);
+    static void clear();
+};
+
+// The suites, one per file
+void checkJsonParsers();
+void checkArenaBudgets();
+void checkNfcReads();
+void checkNdefCodec();
+void checkType4Tag();
+void checkDhtDecoder();
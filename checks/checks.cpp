@@ -0,0 +1,102 @@
+// Host checks: drives parsers, codecs and state machines with recorded inputs
+// and asserts on what comes out. Built by `pio run -e native-checks` in place
+// of main.cpp; see checks/README.md.
+#include <Arduino.h>
+#include <HostSim.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "check.h"
+#include "FetchScheduler.h"
+#include "Location.h"
+#include "NTP.h"
+#include "OpenWeather.h"
+
+// Globals main.cpp normally provides to the display code
+LocationManager locationManager;
+NTPClient ntpClient;
+OpenWeather weather;
+FetchScheduler scheduler;
+int srcWeather = -1;
+
+unsigned Check::_passed = 0;
+unsigned Check::_failed = 0;
+
+void Check::fail(const char* file, int line, const char* fmt, ...) {
+    _failed++;
+    char message[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+    HostSim::muteSerial(false);
+    Serial.printf("❌ %s:%d: %s\n", file, line, message);
+    HostSim::muteSerial(true);
+}
+
+void Check::bytes(const char* file, int line, const char* what, const uint8_t* actual, size_t actualLength,
+                  const uint8_t* expected, size_t expectedLength) {
+    size_t i = 0;
+    while (i < actualLength && i < expectedLength && actual[i] == expected[i]) i++;
+    if (i == actualLength && i == expectedLength) {
+        pass();
+        return;
+    }
+    if (i < actualLength && i < expectedLength) {
+        fail(file, line, "%s differs at byte %u: %02X, expected %02X", what, (unsigned)i, actual[i], expected[i]);
+    } else {
+        fail(file, line, "%s is %u bytes, expected %u", what, (unsigned)actualLength, (unsigned)expectedLength);
+    }
+}
+
+struct CheckSuite {
+    const char* name;
+    void (*run)();
+};
+
+static const CheckSuite SUITES[] = {
+    {"json", checkJsonParsers},
+    {"arena", checkArenaBudgets},
+    {"nfc", checkNfcReads},
+    {"ndef", checkNdefCodec},
+    {"type4", checkType4Tag},
+    {"dht", checkDhtDecoder},
+};
+
+void setup() {
+    setenv("SIM_FRAMES", "0", 0);
+    const char* filter = getenv("CHECK_FILTER");
+
+    if (!FixtureServer::start()) {
+        Serial.println("❌ Could not start the fixture server");
+        fflush(stdout);
+        _exit(1);
+    }
+
+    HostSim::muteSerial(true);
+    int failed = 0, ran = 0;
+    for (const CheckSuite& suite : SUITES) {
+        if (filter && !strstr(suite.name, filter)) continue;
+        Check::reset();
+        suite.run();
+        ran++;
+
+        HostSim::muteSerial(false);
+        if (Check::failed()) {
+            Serial.printf("❌ %-10s %u of %u checks failed\n", suite.name, Check::failed(),
+                          Check::passed() + Check::failed());
+            failed++;
+        } else {
+            Serial.printf("✅ %-10s %u checks\n", suite.name, Check::passed());
+        }
+        HostSim::muteSerial(true);
+    }
+
+    HostSim::muteSerial(false);
+    if (failed) Serial.printf("❌ %d of %d suites failed\n", failed, ran);
+    else Serial.printf("✅ All %d suites passed\n", ran);
+    fflush(stdout);
+    _exit(failed ? 1 : 0);
+}
+
+void loop() {}
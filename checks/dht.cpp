@@ -0,0 +1,100 @@
+// DHT22 frames replayed through dhtDecode(): pulse widths as the RMT capture in
+// DHT22.cpp records them, the sensor's 80/80 us response first
+#include <vector>
+#include "check.h"
+#include "DhtDecoder.h"
+
+// 65.2 %RH, 23.4 C
+static const DhtPulse FRAME_OK[] = {
+    {80, 80}, {53, 22}, {48, 23}, {52, 22}, {55, 25}, {47, 23}, {53, 28}, {48, 69}, {48, 28}, {47, 75},
+    {48, 25}, {56, 22}, {56, 28}, {47, 69}, {47, 74}, {49, 26}, {53, 24}, {55, 23}, {56, 26}, {55, 24},
+    {48, 25}, {52, 23}, {55, 23}, {56, 22}, {56, 25}, {54, 74}, {53, 71}, {54, 75}, {54, 27}, {51, 69},
+    {49, 25}, {48, 75}, {51, 29}, {52, 29}, {51, 75}, {48, 67}, {55, 72}, {49, 71}, {49, 29}, {53, 22},
+    {48, 27}
+};
+
+// 40.5 %RH, -10.1 C (sign in the top bit)
+static const DhtPulse FRAME_NEGATIVE[] = {
+    {80, 83}, {56, 29}, {56, 29}, {48, 23}, {51, 29}, {48, 22}, {51, 29}, {51, 28}, {52, 66}, {54, 71},
+    {49, 23}, {54, 22}, {50, 70}, {49, 25}, {53, 72}, {54, 23}, {49, 73}, {53, 74}, {51, 24}, {53, 26},
+    {53, 27}, {53, 25}, {49, 23}, {49, 24}, {50, 25}, {47, 29}, {56, 68}, {51, 70}, {47, 24}, {53, 27},
+    {56, 75}, {52, 24}, {55, 75}, {47, 29}, {55, 72}, {53, 72}, {53, 67}, {54, 72}, {47, 25}, {48, 69},
+    {54, 68}
+};
+
+static const size_t RESPONSE = 1;   // Pulses before the 40 data bits
+
+static std::vector<DhtPulse> frameOk() {
+    return std::vector<DhtPulse>(FRAME_OK, FRAME_OK + sizeof(FRAME_OK) / sizeof(FRAME_OK[0]));
+}
+
+static DhtDecodeResult decode(const std::vector<DhtPulse>& pulses, float& temperature, float& humidity) {
+    return dhtDecode(pulses.data(), pulses.size(), temperature, humidity);
+}
+
+static void checkValidFrames() {
+    float t = 0, h = 0;
+    CHECK_EQ(decode(frameOk(), t, h), DHT_OK);
+    CHECK_NEAR(t, 23.4, 0.001);
+    CHECK_NEAR(h, 65.2, 0.001);
+
+    CHECK_EQ(dhtDecode(FRAME_NEGATIVE, sizeof(FRAME_NEGATIVE) / sizeof(FRAME_NEGATIVE[0]), t, h), DHT_OK);
+    CHECK_NEAR(t, -10.1, 0.001);
+    CHECK_NEAR(h, 40.5, 0.001);
+
+    // Only the last 40 pulses are data: a missed response or a leading glitch doesn't matter
+    std::vector<DhtPulse> pulses = frameOk();
+    pulses.erase(pulses.begin());
+    CHECK_EQ(decode(pulses, t, h), DHT_OK);
+    pulses.insert(pulses.begin(), {{3, 2}, {80, 80}});
+    CHECK_EQ(decode(pulses, t, h), DHT_OK);
+    CHECK_NEAR(t, 23.4, 0.001);
+
+    // The edges of the timing windows still decode
+    pulses = frameOk();
+    pulses[RESPONSE + 0] = {35, 15};    // 0 bit, shortest low and high
+    pulses[RESPONSE + 6] = {75, 90};    // 1 bit, longest low and high
+    CHECK_EQ(decode(pulses, t, h), DHT_OK);
+    CHECK_NEAR(h, 65.2, 0.001);
+}
+
+static void checkRejectedFrames() {
+    float t = 99, h = 99;
+
+    // A 0 read as a 1 (humidity bit 10) no longer matches the checksum
+    std::vector<DhtPulse> pulses = frameOk();
+    pulses[RESPONSE + 10].highUs = 70;
+    CHECK_EQ(decode(pulses, t, h), DHT_BAD_CHECKSUM);
+    pulses = frameOk();
+    pulses[RESPONSE + 39].highUs = 70;   // Checksum's own last bit
+    CHECK_EQ(decode(pulses, t, h), DHT_BAD_CHECKSUM);
+
+    // Widths outside the datasheet windows, e.g. a missed edge merging two phases
+    static const DhtPulse BAD[] = {{34, 25}, {76, 25}, {50, 14}, {50, 91}, {50, 150}, {0, 0}};
+    for (const DhtPulse& bad : BAD) {
+        pulses = frameOk();
+        pulses[RESPONSE + 20] = bad;
+        CHECK_EQ(decode(pulses, t, h), DHT_BAD_TIMING);
+    }
+    pulses = frameOk();
+    pulses.back().highUs = 200;   // Line never went low after the last bit
+    CHECK_EQ(decode(pulses, t, h), DHT_BAD_TIMING);
+
+    // Capture cut short, or no answer at all
+    pulses = frameOk();
+    pulses.resize(30);
+    CHECK_EQ(decode(pulses, t, h), DHT_TOO_FEW_PULSES);
+    pulses = frameOk();
+    pulses.erase(pulses.begin(), pulses.begin() + RESPONSE + 1);   // 39 data bits
+    CHECK_EQ(decode(pulses, t, h), DHT_TOO_FEW_PULSES);
+    CHECK_EQ(dhtDecode(nullptr, 0, t, h), DHT_TOO_FEW_PULSES);
+
+    // A rejected frame leaves the outputs alone
+    CHECK_NEAR(t, 99, 0);
+    CHECK_NEAR(h, 99, 0);
+}
+
+void checkDhtDecoder() {
+    checkValidFrames();
+    checkRejectedFrames();
+}
@@ -0,0 +1,146 @@
+// Weather and location replies through the production streaming filters:
+// captured bodies, API error bodies, missing fields and oversized input
+#include <string>
+#include "check.h"
+#include "Location.h"
+#include "OpenWeather.h"
+
+// api.openweathermap.org /data/2.5/weather?units=metric, as captured
+static const char WEATHER_OK[] = R"({"coord":{"lon":4.8897,"lat":52.374},)"
+    R"("weather":[{"id":803,"main":"Clouds","description":"broken clouds","icon":"04d"}],)"
+    R"("base":"stations","main":{"temp":14.2,"feels_like":13.61,"temp_min":13.12,"temp_max":15.03,)"
+    R"("pressure":1016,"humidity":71,"sea_level":1016,"grnd_level":1015},"visibility":10000,)"
+    R"("wind":{"speed":5.66,"deg":240,"gust":8.23},"clouds":{"all":75},"dt":1729330800,)"
+    R"("sys":{"type":2,"id":2012219,"country":"NL","sunrise":1729318261,"sunset":1729355537},)"
+    R"("timezone":7200,"id":2759794,"name":"Amsterdam","cod":200})";
+static const char WEATHER_FROST[] = R"({"weather":[{"id":800,"main":"Clear","icon":"01n"}],)"
+    R"("main":{"temp":-3,"humidity":88},"name":"Tromsø","cod":200})";
+static const char WEATHER_BAD_KEY[] =
+    R"({"cod":401, "message": "Invalid API key. Please see https://openweathermap.org/faq#error401 for more info."})";
+static const char WEATHER_BAD_COORDS[] = R"({"cod":"400","message":"wrong latitude"})";
+static const char WEATHER_NO_ICON[] = R"({"main":{"temp":9.5},"cod":200})";
+
+// ipinfo.io/<ip>/json, as captured
+static const char LOCATION_OK[] = R"({"ip":"203.0.113.7","hostname":"host-203-0-113-7.example.net",)"
+    R"("city":"Amsterdam","region":"North Holland","country":"NL","loc":"52.3740,4.8897",)"
+    R"("org":"AS64496 Example Networks B.V.","postal":"1012","timezone":"Europe/Amsterdam",)"
+    R"("readme":"https://ipinfo.io/missingauth"})";
+static const char LOCATION_BAD_IP[] =
+    R"({"status":404,"error":{"title":"Wrong ip","message":"Please provide a valid IP address"}})";
+static const char LOCATION_BOGON[] = R"({"ip":"10.0.0.1","bogon":true})";
+static const char LOCATION_NO_COUNTRY[] = R"({"ip":"203.0.113.7","city":"Amsterdam","loc":"52.3740,4.8897"})";
+static const char LOCATION_NO_LOC[] = R"({"ip":"203.0.113.7","city":"Amsterdam","country":"NL"})";
+static const char LOCATION_BAD_LOC[] = R"({"city":"Amsterdam","country":"NL","loc":"52.3740"})";
+static const char RATE_LIMITED[] = "Too Many Requests";
+
+static bool parseWeather(OpenWeather& target, const char* body, size_t length) {
+    MemoryStream stream(body, length);
+    return target.parseWeatherData(stream);
+}
+
+static bool parseWeather(OpenWeather& target, const std::string& body) {
+    return parseWeather(target, body.data(), body.size());
+}
+
+static bool parseLocation(LocationManager& target, const char* body, size_t length) {
+    MemoryStream stream(body, length);
+    return target.parseIPGeolocation(stream);
+}
+
+static bool parseLocation(LocationManager& target, const std::string& body) {
+    return parseLocation(target, body.data(), body.size());
+}
+
+// Fields the filters drop, enough of them to dwarf the JSON pools
+static std::string padding(int entries) {
+    std::string json = R"("domains":{"total":)" + std::to_string(entries) + R"(,"domains":[)";
+    for (int i = 0; i < entries; i++) {
+        json += std::string(i ? "," : "") + "\"host" + std::to_string(i) + ".example.com\"";
+    }
+    return json + "]}";
+}
+
+static void checkWeather() {
+    OpenWeather w;
+    CHECK(parseWeather(w, WEATHER_OK));
+    CHECK_NEAR(w.getTemperature(), 14.2, 0.001);
+    CHECK_STR(w.getWeatherIcon(), "04d");
+
+    CHECK(parseWeather(w, WEATHER_FROST));
+    CHECK_NEAR(w.getTemperature(), -3.0, 0.001);
+    CHECK_STR(w.getWeatherIcon(), "01n");
+
+    // Error replies and bodies without a temperature leave the last reading alone
+    CHECK(!parseWeather(w, WEATHER_BAD_KEY));
+    CHECK(!parseWeather(w, WEATHER_BAD_COORDS));
+    CHECK(!parseWeather(w, RATE_LIMITED));
+    CHECK(!parseWeather(w, ""));
+    CHECK(!parseWeather(w, WEATHER_OK, sizeof(WEATHER_OK) / 2));     // Connection dropped mid-body
+    CHECK_NEAR(w.getTemperature(), -3.0, 0.001);
+    CHECK_STR(w.getWeatherIcon(), "01n");
+
+    // The icon is optional
+    CHECK(parseWeather(w, WEATHER_NO_ICON));
+    CHECK_NEAR(w.getTemperature(), 9.5, 0.001);
+    CHECK_STR(w.getWeatherIcon(), "");
+
+    // Tens of KB the filter drops still parse; kept data that outgrows the pool is rejected
+    std::string big = std::string(WEATHER_OK, sizeof(WEATHER_OK) - 2) + "," + padding(1500) + "}";
+    CHECK(big.size() > 25000);
+    CHECK(parseWeather(w, big));
+    CHECK_NEAR(w.getTemperature(), 14.2, 0.001);
+
+    std::string conditions = R"({"weather":[)";
+    for (int i = 0; i < 12; i++) conditions += std::string(i ? "," : "") + R"({"id":701,"main":"Mist","icon":"50d"})";
+    conditions += R"(],"main":{"temp":4.1},"cod":200})";
+    CHECK(!parseWeather(w, conditions));
+    CHECK_NEAR(w.getTemperature(), 14.2, 0.001);
+}
+
+static void checkLocation() {
+    LocationManager l;
+    CHECK(parseLocation(l, LOCATION_OK));
+    const LocationData& loc = l.getCurrentLocation();
+    CHECK_STR(loc.city.c_str(), "Amsterdam");
+    CHECK_STR(loc.country.c_str(), "NL");
+    CHECK_STR(loc.region.c_str(), "North Holland");
+    CHECK_NEAR(loc.latitude, 52.374, 0.0001);
+    CHECK_NEAR(loc.longitude, 4.8897, 0.0001);
+
+    // Rejected replies keep the last good location
+    CHECK(!parseLocation(l, LOCATION_BAD_IP));
+    CHECK(!parseLocation(l, LOCATION_BOGON));
+    CHECK(!parseLocation(l, LOCATION_NO_COUNTRY));
+    CHECK(!parseLocation(l, RATE_LIMITED));
+    CHECK(!parseLocation(l, ""));
+    CHECK(!parseLocation(l, LOCATION_OK, sizeof(LOCATION_OK) / 2));
+    CHECK_STR(loc.city.c_str(), "Amsterdam");
+    CHECK_NEAR(loc.latitude, 52.374, 0.0001);
+
+    // Coordinates are optional and only taken as a "lat,lon" pair
+    LocationManager noLoc;
+    CHECK(parseLocation(noLoc, LOCATION_NO_LOC));
+    CHECK_STR(noLoc.getCurrentLocation().country.c_str(), "NL");
+    CHECK_NEAR(noLoc.getCurrentLocation().latitude, 0, 0);
+    CHECK(parseLocation(noLoc, LOCATION_BAD_LOC));
+    CHECK_NEAR(noLoc.getCurrentLocation().latitude, 0, 0);
+    CHECK_NEAR(noLoc.getCurrentLocation().longitude, 0, 0);
+
+    // Dropped fields may be any size; a long name is cut to the field, one past the pool is rejected
+    std::string big = std::string(LOCATION_OK, sizeof(LOCATION_OK) - 2) + "," + padding(1500) + "}";
+    CHECK(parseLocation(l, big));
+    CHECK_STR(loc.city.c_str(), "Amsterdam");
+
+    std::string longCity = R"({"city":")" + std::string(40, 'x') + R"(","country":"NL"})";
+    CHECK(parseLocation(l, longCity));
+    CHECK_EQ(loc.city.length(), loc.city.capacity());
+
+    std::string hugeCity = R"({"city":")" + std::string(600, 'x') + R"(","country":"DE"})";
+    CHECK(!parseLocation(l, hugeCity));
+    CHECK_STR(loc.country.c_str(), "NL");
+}
+
+void checkJsonParsers() {
+    checkWeather();
+    checkLocation();
+}
@@ -0,0 +1,304 @@
+// NDEF codec: URI prefix codes both ways, short and long records and TLVs,
+// multi-record messages, control TLVs ahead of the message, capability
+// containers, writer overflow and malformed records
+#include <string>
+#include "check.h"
+#include "Ndef.h"
+
+// First record of the message in a TLV image
+static bool firstRecord(const uint8_t* tlv, size_t length, NdefRecord& record) {
+    const uint8_t* message;
+    size_t messageLength;
+    if (!NdefReader::findMessage(tlv, length, message, messageLength)) return false;
+    NdefReader reader(message, messageLength);
+    return reader.next(record);
+}
+
+// The identifier code addUri() picked, and whether the URI expands back unchanged
+static int uriCode(const char* uri, bool& roundTrips) {
+    uint8_t tlv[96];
+    NdefWriter writer(tlv, sizeof(tlv));
+    writer.addUri(uri);
+    NdefRecord record;
+    char decoded[96];
+    roundTrips = false;
+    if (!writer.finish() || !firstRecord(tlv, sizeof(tlv), record)) return -1;
+    roundTrips = ndefDecodeUri(record, decoded, sizeof(decoded)) && !strcmp(decoded, uri);
+    return record.payload[0];
+}
+
+static void checkUriPrefixes() {
+    // "https://thumbstack.example/c/": well-known, short, code 04
+    static const uint8_t SHORT_URI[] = {0x03, 0x1A, 0xD1, 0x01, 0x16, 0x55, 0x04, 't', 'h', 'u', 'm', 'b',
+                                        's', 't', 'a', 'c', 'k', '.', 'e', 'x', 'a', 'm', 'p', 'l', 'e', '/',
+                                        'c', '/', 0xFE, 0x00, 0x00, 0x00};
+    uint8_t tlv[64];
+    NdefWriter writer(tlv, sizeof(tlv));
+    CHECK(writer.addUri("https://thumbstack.example/c/"));
+    size_t length = writer.finish();
+    CHECK_BYTES(tlv, length, SHORT_URI, sizeof(SHORT_URI));
+
+    // Longest matching prefix wins
+    static const struct { const char* uri; int code; } CASES[] = {
+        {"https://www.thumbstack.example/", 0x02},   // Not "https://" (04)
+        {"https://thumbstack.example/", 0x04},
+        {"http://www.thumbstack.example/", 0x01},    // Not "http://" (03)
+        {"ftp://ftp.thumbstack.example/", 0x08},     // Not "ftp://" (0D)
+        {"sips:desk@thumbstack.example", 0x16},      // Not "sip:" (15)
+        {"urn:epc:id:sgtin:0614141.107346.2017", 0x1E},   // Not "urn:epc:" (22) or "urn:" (13)
+        {"urn:epc:0614141", 0x22},
+        {"urn:nfc:sn:handover", 0x23},
+        {"tel:+31201234567", 0x05},
+        {"geo:52.37,4.89", 0x00},                    // No prefix: stored whole
+        {"", 0x00},
+    };
+    for (const auto& c : CASES) {
+        bool roundTrips;
+        int code = uriCode(c.uri, roundTrips);
+        if (code != c.code) Check::fail(__FILE__, __LINE__, "\"%s\" got code %d, expected %d", c.uri, code, c.code);
+        else if (!roundTrips) Check::fail(__FILE__, __LINE__, "\"%s\" did not expand back", c.uri);
+        else Check::pass();
+    }
+
+    // RFU codes expand to nothing: the payload is taken as it is
+    uint8_t rfu[] = {0xD1, 0x01, 0x05, 0x55, 0x24, 'a', 'b', 'c', 'd'};
+    NdefRecord record;
+    char decoded[16];
+    CHECK(NdefReader(rfu, sizeof(rfu)).next(record));
+    CHECK(ndefDecodeUri(record, decoded, sizeof(decoded)));
+    CHECK_STR(decoded, "abcd");
+    rfu[4] = 0xFF;
+    CHECK(NdefReader(rfu, sizeof(rfu)).next(record));
+    CHECK(ndefDecodeUri(record, decoded, sizeof(decoded)));
+    CHECK_STR(decoded, "abcd");
+
+    // The output has to hold the prefix, the rest and the terminator
+    rfu[4] = 0x04;
+    CHECK(NdefReader(rfu, sizeof(rfu)).next(record));
+    CHECK(ndefDecodeUri(record, decoded, strlen("https://abcd") + 1));
+    CHECK_STR(decoded, "https://abcd");
+    CHECK(!ndefDecodeUri(record, decoded, strlen("https://abcd")));
+
+    // Only well-known "U" records are URIs
+    static const uint8_t TEXT[] = {0xD1, 0x01, 0x03, 0x54, 0x00, 'h', 'i'};
+    CHECK(NdefReader(TEXT, sizeof(TEXT)).next(record));
+    CHECK(!ndefDecodeUri(record, decoded, sizeof(decoded)));
+    static const uint8_t EMPTY_URI[] = {0xD1, 0x01, 0x00, 0x55};
+    CHECK(NdefReader(EMPTY_URI, sizeof(EMPTY_URI)).next(record));
+    CHECK(!ndefDecodeUri(record, decoded, sizeof(decoded)));
+}
+
+static void checkLongRecords() {
+    // 300 characters after the prefix: 301-byte payload, no SR, 4-byte length
+    std::string uri = "https://thumbstack.example/";
+    uri.append(300 - (uri.size() - 8), 'x');
+    uint8_t tlv[400];
+    NdefWriter writer(tlv, sizeof(tlv));
+    CHECK(writer.addUri(uri.c_str()));
+    size_t length = writer.finish();
+
+    static const uint8_t LONG_HEAD[] = {0x03, 0xFF, 0x01, 0x34,                 // TLV, 308-byte message
+                                        0xC1, 0x01, 0x00, 0x00, 0x01, 0x2D,     // MB|ME, no SR, 301
+                                        0x55, 0x04};
+    CHECK_BYTES(tlv, sizeof(LONG_HEAD), LONG_HEAD, sizeof(LONG_HEAD));
+    CHECK_EQ(tlv[4 + 308], TLV_TERMINATOR);
+    CHECK_EQ(length, 316);   // Padded to whole pages
+    CHECK_EQ(NdefReader::requiredBytes(tlv, length), 4 + 308);
+
+    NdefRecord record;
+    char decoded[400];
+    CHECK(firstRecord(tlv, length, record));
+    CHECK_EQ(record.payloadLength, 301);
+    CHECK(ndefDecodeUri(record, decoded, sizeof(decoded)));
+    CHECK_STR(decoded, uri.c_str());
+
+    // SR up to a 255-byte payload
+    uint8_t payload[256];
+    memset(payload, 0x5A, sizeof(payload));
+    static const uint8_t TYPE[] = {'T'};
+    NdefWriter at255(tlv, sizeof(tlv));
+    at255.addRecord(NDEF_TNF_WELL_KNOWN, TYPE, 1, payload, 255);
+    CHECK(at255.finish());
+    CHECK_EQ(tlv[4], NDEF_MB | NDEF_ME | NDEF_SR | NDEF_TNF_WELL_KNOWN);
+    NdefWriter at256(tlv, sizeof(tlv));
+    at256.addRecord(NDEF_TNF_WELL_KNOWN, TYPE, 1, payload, 256);
+    CHECK(at256.finish());
+    CHECK_EQ(tlv[4], NDEF_MB | NDEF_ME | NDEF_TNF_WELL_KNOWN);
+    CHECK(firstRecord(tlv, sizeof(tlv), record));
+    CHECK_EQ(record.payloadLength, 256);
+
+    // A 254-byte message still has the 1-byte TLV length; 255 needs 0xFF + 2 bytes
+    NdefWriter message254(tlv, sizeof(tlv));
+    message254.addRecord(NDEF_TNF_WELL_KNOWN, TYPE, 1, payload, 250);
+    CHECK(message254.finish());
+    const uint8_t head254[] = {TLV_NDEF, 0xFE};
+    CHECK_BYTES(tlv, 2, head254, sizeof(head254));
+    NdefWriter message255(tlv, sizeof(tlv));
+    message255.addRecord(NDEF_TNF_WELL_KNOWN, TYPE, 1, payload, 251);
+    CHECK(message255.finish());
+    const uint8_t head255[] = {TLV_NDEF, 0xFF, 0x00, 0xFF};
+    CHECK_BYTES(tlv, 4, head255, sizeof(head255));
+    CHECK(firstRecord(tlv, sizeof(tlv), record));
+    CHECK_EQ(record.payloadLength, 251);
+}
+
+static void checkMultiRecord() {
+    uint8_t tlv[128];
+    NdefWriter writer(tlv, sizeof(tlv));
+    static const uint8_t MIME[] = {'t', 'e', 'x', 't', '/', 'p', 'l', 'a', 'i', 'n'};
+    CHECK(writer.addText("Hello", "en"));
+    CHECK(writer.addUri("https://thumbstack.example/c/42"));
+    CHECK(writer.addRecord(0x02, MIME, sizeof(MIME), (const uint8_t*)"x", 1));
+    size_t length = writer.finish();
+    CHECK(length);
+
+    // MB only on the first header, ME only on the last
+    const uint8_t* message;
+    size_t messageLength;
+    CHECK(NdefReader::findMessage(tlv, length, message, messageLength));
+    CHECK_EQ(messageLength, 12 + 28 + 14);
+    CHECK_EQ(message[0], NDEF_MB | NDEF_SR | NDEF_TNF_WELL_KNOWN);
+    CHECK_EQ(message[12], NDEF_SR | NDEF_TNF_WELL_KNOWN);
+    CHECK_EQ(message[40], NDEF_ME | NDEF_SR | 0x02);
+
+    NdefReader reader(message, messageLength);
+    NdefRecord record;
+    char decoded[64];
+    CHECK(reader.next(record));
+    static const uint8_t TEXT_PAYLOAD[] = {0x02, 'e', 'n', 'H', 'e', 'l', 'l', 'o'};
+    CHECK_EQ(record.type[0], 'T');
+    CHECK_BYTES(record.payload, record.payloadLength, TEXT_PAYLOAD, sizeof(TEXT_PAYLOAD));
+    CHECK(reader.next(record));
+    CHECK(ndefDecodeUri(record, decoded, sizeof(decoded)));
+    CHECK_STR(decoded, "https://thumbstack.example/c/42");
+    CHECK(reader.next(record));
+    CHECK_EQ(record.tnf, 0x02);
+    CHECK_BYTES(record.type, record.typeLength, MIME, sizeof(MIME));
+    CHECK(!reader.next(record));
+
+    // Reading stops at ME whatever follows it
+    uint8_t trailing[] = {0xD1, 0x01, 0x02, 0x55, 0x04, 'a', 0xD1, 0x01, 0x02, 0x55, 0x04, 'b'};
+    NdefReader stops(trailing, sizeof(trailing));
+    CHECK(stops.next(record));
+    CHECK(!stops.next(record));
+
+    // An ID field sits between the type and the payload
+    static const uint8_t WITH_ID[] = {0xD9, 0x01, 0x03, 0x02, 0x55, 'i', 'd', 0x04, 'a', 'b'};
+    CHECK(NdefReader(WITH_ID, sizeof(WITH_ID)).next(record));
+    CHECK_BYTES(record.id, record.idLength, "id", 2);
+    CHECK(ndefDecodeUri(record, decoded, sizeof(decoded)));
+    CHECK_STR(decoded, "https://ab");
+}
+
+static void checkControlTlvs() {
+    // NTAG216 style: lock control, memory control, a NULL, then the message
+    static const uint8_t MEM[] = {TLV_LOCK_CONTROL, 0x03, 0xA0, 0x0C, 0x34,
+                                  TLV_MEMORY_CONTROL, 0x03, 0xD0, 0x00, 0x00,
+                                  TLV_NULL,
+                                  TLV_NDEF, 0x06, 0xD1, 0x01, 0x02, 0x55, 0x04, 'a',
+                                  TLV_TERMINATOR};
+    const uint8_t* message;
+    size_t messageLength;
+    CHECK(NdefReader::findMessage(MEM, sizeof(MEM), message, messageLength));
+    CHECK(message == MEM + 13);
+    CHECK_EQ(messageLength, 6);
+    CHECK_EQ(NdefReader::requiredBytes(MEM, sizeof(MEM)), 19);
+
+    // A control TLV with the 3-byte length form
+    static const uint8_t LONG_LOCK[] = {TLV_LOCK_CONTROL, 0xFF, 0x00, 0x02, 0xAA, 0xBB,
+                                        TLV_NDEF, 0x03, 0xD1, 0x01, 0x00, TLV_TERMINATOR};
+    CHECK(NdefReader::findMessage(LONG_LOCK, sizeof(LONG_LOCK), message, messageLength));
+    CHECK(message == LONG_LOCK + 8);
+    CHECK_EQ(messageLength, 3);
+
+    // Only the first page read so far: the size is known before the message is in
+    CHECK_EQ(NdefReader::requiredBytes(MEM, 16), 19);
+    CHECK(!NdefReader::findMessage(MEM, 16, message, messageLength));
+    // ...but not while the NDEF TLV's header is still missing
+    CHECK_EQ(NdefReader::requiredBytes(MEM, 12), 0);
+    CHECK_EQ(NdefReader::requiredBytes(LONG_LOCK, 2), 0);
+
+    // Terminator or nothing but NULLs: no message
+    static const uint8_t EMPTY[] = {TLV_NULL, TLV_NULL, TLV_TERMINATOR, TLV_NDEF, 0x03, 0xD1, 0x01, 0x00};
+    CHECK(!NdefReader::findMessage(EMPTY, sizeof(EMPTY), message, messageLength));
+    CHECK_EQ(NdefReader::requiredBytes(EMPTY, sizeof(EMPTY)), 0);
+    static const uint8_t BLANK[16] = {};
+    CHECK_EQ(NdefReader::requiredBytes(BLANK, sizeof(BLANK)), 0);
+}
+
+static void checkCapabilityContainer() {
+    static const uint8_t NTAG213[4] = {0xE1, 0x10, 0x12, 0x00};
+    static const uint8_t NTAG215[4] = {0xE1, 0x10, 0x3E, 0x00};
+    static const uint8_t NTAG216[4] = {0xE1, 0x10, 0x6D, 0x00};
+    static const uint8_t BLANK[4] = {0x00, 0x00, 0x00, 0x00};
+    static const uint8_t ERASED[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+    CHECK_EQ(ndefTagDataSize(NTAG213), 144);
+    CHECK_EQ(ndefTagDataSize(NTAG215), 496);
+    CHECK_EQ(ndefTagDataSize(NTAG216), 872);
+    CHECK_EQ(ndefTagDataSize(BLANK), 0);
+    CHECK_EQ(ndefTagDataSize(ERASED), 0);
+}
+
+static void checkWriterOverflow() {
+    uint8_t tlv[32];
+    memset(tlv, 0xA5, sizeof(tlv));
+
+    // The record itself does not fit
+    NdefWriter tooSmall(tlv, 16);
+    CHECK(!tooSmall.addUri("https://thumbstack.example/c/42"));
+    CHECK(tooSmall.overflowed());
+    CHECK(!tooSmall.addUri("https://a"));   // Stays overflowed
+    CHECK_EQ(tooSmall.finish(), 0);
+    CHECK_EQ(tlv[16], 0xA5);               // Nothing written past the capacity
+
+    // "https://a" is a 6-byte message: 2 + 6 + terminator = 9, padded to 12
+    NdefWriter noPadding(tlv, 10);
+    CHECK(noPadding.addUri("https://a"));
+    CHECK_EQ(noPadding.finish(), 0);
+    NdefWriter exact(tlv, 12);
+    CHECK(exact.addUri("https://a"));
+    CHECK_EQ(exact.finish(), 12);
+
+    NdefWriter empty(tlv, sizeof(tlv));
+    CHECK_EQ(empty.finish(), 0);
+    NdefWriter noRoom(tlv, 3);
+    CHECK(!noRoom.addUri(""));
+    CHECK_EQ(noRoom.finish(), 0);
+}
+
+static void checkMalformed() {
+    NdefRecord record;
+
+    static const uint8_t CHUNKED[] = {0xB1, 0x01, 0x02, 0x55, 0x04, 'a'};   // MB|CF|SR
+    CHECK(!NdefReader(CHUNKED, sizeof(CHUNKED)).next(record));
+
+    static const uint8_t SHORT_PAYLOAD[] = {0xD1, 0x01, 0x0A, 0x55, 0x04, 'a', 'b'};   // 10 announced, 3 there
+    CHECK(!NdefReader(SHORT_PAYLOAD, sizeof(SHORT_PAYLOAD)).next(record));
+    static const uint8_t SHORT_TYPE[] = {0xD1, 0x08, 0x00, 'U'};
+    CHECK(!NdefReader(SHORT_TYPE, sizeof(SHORT_TYPE)).next(record));
+    static const uint8_t SHORT_LENGTH[] = {0xC1, 0x01, 0x00, 0x00};   // 4-byte length cut off
+    CHECK(!NdefReader(SHORT_LENGTH, sizeof(SHORT_LENGTH)).next(record));
+    static const uint8_t HUGE_LENGTH[] = {0xC1, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x55, 0x04};
+    CHECK(!NdefReader(HUGE_LENGTH, sizeof(HUGE_LENGTH)).next(record));
+    static const uint8_t NO_ID_LENGTH[] = {0xD9, 0x01, 0x01};   // IL without its length byte
+    CHECK(!NdefReader(NO_ID_LENGTH, sizeof(NO_ID_LENGTH)).next(record));
+    static const uint8_t HEADER_ONLY[] = {0xD1, 0x01};
+    CHECK(!NdefReader(HEADER_ONLY, sizeof(HEADER_ONLY)).next(record));
+
+    // A TLV whose 3-byte length is cut off
+    static const uint8_t SHORT_TLV[] = {TLV_NDEF, 0xFF, 0x01};
+    const uint8_t* message;
+    size_t messageLength;
+    CHECK(!NdefReader::findMessage(SHORT_TLV, sizeof(SHORT_TLV), message, messageLength));
+    CHECK_EQ(NdefReader::requiredBytes(SHORT_TLV, sizeof(SHORT_TLV)), 0);
+}
+
+void checkNdefCodec() {
+    checkUriPrefixes();
+    checkLongRecords();
+    checkMultiRecord();
+    checkControlTlvs();
+    checkCapabilityContainer();
+    checkWriterOverflow();
+    checkMalformed();
+}
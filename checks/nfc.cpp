@@ -0,0 +1,139 @@
+// NTAG page reads on the simulated PN532: how many InDataExchange frames READ
+// and FAST_READ take, that the pages come back in order whatever the split,
+// and that a known tag is only confirmed when its whole NDEF TLV matches
+#include <HostSim.h>
+#include <stdio.h>
+#include <string>
+#include "check.h"
+#include "Ndef.h"
+#include "NFC.h"
+
+static const int TAG_PAGES = 135;   // NTAG215, as the simulator emulates
+static const uint8_t CANARY = 0xA5;
+
+static uint8_t tagByte(int offset) {
+    return (uint8_t)(offset * 7 + 3);
+}
+
+// The test pattern, or with tlv set a formatted tag holding it from page 4
+static bool writeTagImage(const std::string& path, const uint8_t* tlv = nullptr, size_t tlvLength = 0) {
+    uint8_t image[TAG_PAGES * 4];
+    for (int i = 0; i < (int)sizeof(image); i++) image[i] = tagByte(i);
+    if (tlv) {
+        static const uint8_t cc[4] = {0xE1, 0x10, 0x3E, 0x00};   // NTAG215: 496 bytes of NDEF data
+        memcpy(image + 12, cc, sizeof(cc));
+        memcpy(image + 16, tlv, tlvLength);
+    }
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(image, 1, sizeof(image), f) == sizeof(image);
+    return fclose(f) == 0 && ok;
+}
+
+// Pages from..from+count of the image, with nothing written past them
+static bool holdsPages(const uint8_t* buffer, int from, int count, size_t bufferSize) {
+    for (int i = 0; i < count * 4; i++) {
+        if (buffer[i] != tagByte(from * 4 + i)) return false;
+    }
+    for (size_t i = count * 4; i < bufferSize; i++) {
+        if (buffer[i] != CANARY) return false;
+    }
+    return true;
+}
+
+void checkNfcReads() {
+    const std::string tagPath = HostSim::outDir() + "/checks_tag.bin";
+    HostSim::makeDirs(HostSim::outDir());
+    CHECK(writeTagImage(tagPath));
+    setenv("SIM_NFC_TAG", tagPath.c_str(), 1);
+
+    NFCManager manager;
+    Adafruit_PN532& pn532 = manager.nfc;
+    uint8_t buffer[30 * 4 + 16];
+    uint32_t sent;
+
+    // Wire frames of one call; the manager's own count must agree
+    auto start = [&] {
+        memset(buffer, CANARY, sizeof(buffer));
+        manager._exchanges = 0;
+        sent = pn532.simExchanges();
+    };
+    auto frames = [&] { return pn532.simExchanges() - sent; };
+
+    // READ: 4 pages per frame
+    start();
+    CHECK(manager.readBlock(4, buffer));
+    CHECK_EQ(frames(), 1);
+    CHECK(holdsPages(buffer, 4, 4, sizeof(buffer)));
+
+    // FAST_READ: up to 12 pages per frame, then a short final range
+    start();
+    CHECK(manager.fastRead(4, 12, buffer));
+    CHECK_EQ(frames(), 1);
+    CHECK(holdsPages(buffer, 4, 12, sizeof(buffer)));
+
+    start();
+    CHECK(manager.fastRead(4, 13, buffer));
+    CHECK_EQ(frames(), 2);
+    CHECK(holdsPages(buffer, 4, 13, sizeof(buffer)));
+
+    start();
+    CHECK(manager.readPages(8, 30, buffer));
+    CHECK_EQ(frames(), 3);                       // 12 + 12 + 6
+    CHECK_EQ(manager._exchanges, frames());
+    CHECK(holdsPages(buffer, 8, 30, sizeof(buffer)));
+
+    // A range past the end of the tag fails rather than wrapping
+    start();
+    CHECK(!manager.fastRead(TAG_PAGES - 5, 12, buffer));
+
+    // Without FAST_READ: one NAK'd frame, reselect, then READs, the last one cut
+    // to the 2 pages still missing
+    setenv("SIM_NFC_FAST_READ", "0", 1);
+    start();
+    CHECK(manager.readPages(8, 30, buffer));
+    CHECK_EQ(frames(), 1 + 8);
+    CHECK_EQ(manager._exchanges, frames());
+    CHECK(holdsPages(buffer, 8, 30, sizeof(buffer)));
+
+    start();
+    CHECK(manager.readPages(4, 1, buffer));
+    CHECK_EQ(frames(), 1 + 1);
+    CHECK(holdsPages(buffer, 4, 1, sizeof(buffer)));
+    unsetenv("SIM_NFC_FAST_READ");
+
+    // Known tag: the head (page 3 READ) and the rest (FAST_READ) are both compared
+    static const char URL[] = "https://thumbstack.example/card/3f9a2c71d04b8e65";
+    static const char URL_OTHER[] = "https://thumbstock.example/card/3f9a2c71d04b8e65";
+    static const char URL_LONG[] =
+        "https://thumbstack.example/card/3f9a2c71d04b8e65?utm_source=nfc&utm_medium=card&utm_campaign=conference-"
+        "booth-2024&ref=0123456789abcdef0123456789abcdef";
+    uint8_t expected[256], other[256], longTlv[256];
+    NdefWriter writer(expected, sizeof(expected));
+    writer.addUri(URL);
+    size_t length = writer.finish();
+    NdefWriter otherWriter(other, sizeof(other));
+    otherWriter.addUri(URL_OTHER);
+    CHECK_EQ(otherWriter.finish(), length);
+    NdefWriter longWriter(longTlv, sizeof(longTlv));
+    longWriter.addUri(URL_LONG);
+    size_t longLength = longWriter.finish();
+    CHECK(longLength > 12 + 2 * 48);
+
+    CHECK(writeTagImage(tagPath, expected, length));
+    start();
+    CHECK(manager.confirmProvisioned(expected, length));
+    CHECK_EQ(frames(), 2);
+    start();
+    CHECK(!manager.confirmProvisioned(other, length));   // Differs only between head and tail
+
+    CHECK(writeTagImage(tagPath, longTlv, longLength));
+    start();
+    CHECK(manager.confirmProvisioned(longTlv, longLength));
+    CHECK_EQ(frames(), 1 + (longLength - 12 + 47) / 48);
+    longTlv[longLength / 2] ^= 1;
+    CHECK(!manager.confirmProvisioned(longTlv, longLength));
+
+    unsetenv("SIM_NFC_TAG");
+    remove(tagPath.c_str());
+}
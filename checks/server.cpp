@@ -0,0 +1,87 @@
+// Loopback HTTP server for the checks. The simulated HTTPClient sends every
+// request to SIM_HTTP whatever the URL's host, so pointing SIM_HTTP here lets
+// the download paths run against fixtures without tools/content_server.py.
+#include <arpa/inet.h>
+#include <map>
+#include <mutex>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include "check.h"
+
+static std::mutex bodiesLock;
+static std::map<std::string, std::string> bodies;   // Path -> body
+
+static void answer(int fd) {
+    std::string request;
+    char buffer[512];
+    while (request.find("\r\n\r\n") == std::string::npos) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) return;
+        request.append(buffer, n);
+    }
+
+    // "GET /path HTTP/1.0"; the query string is not part of the lookup
+    size_t start = request.find(' ') + 1;
+    std::string path = request.substr(start, request.find_first_of(" ?", start) - start);
+    std::string reply;
+    {
+        std::lock_guard<std::mutex> lock(bodiesLock);
+        auto found = bodies.find(path);
+        if (found == bodies.end()) {
+            reply = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+        } else {
+            reply = "HTTP/1.0 200 OK\r\nContent-Length: " + std::to_string(found->second.size()) + "\r\n\r\n" +
+                    found->second;
+        }
+    }
+    for (size_t sent = 0; sent < reply.size();) {
+        ssize_t n = send(fd, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        sent += n;
+    }
+}
+
+bool FixtureServer::start() {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) return false;
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;   // Any free port
+    socklen_t length = sizeof(addr);
+    if (bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 4) != 0 ||
+        getsockname(listener, (sockaddr*)&addr, &length) != 0) {
+        close(listener);
+        return false;
+    }
+
+    // Read once by HostSim on the first request, so this has to run before any
+    char setting[32];
+    snprintf(setting, sizeof(setting), "127.0.0.1:%u", ntohs(addr.sin_port));
+    setenv("SIM_HTTP", setting, 1);
+
+    std::thread([listener] {
+        for (;;) {
+            int fd = accept(listener, nullptr, nullptr);
+            if (fd < 0) continue;
+            answer(fd);
+            close(fd);
+        }
+    }).detach();
+    return true;
+}
+
+void FixtureServer::serve(const char* path, const std::string& body) {
+    std::lock_guard<std::mutex> lock(bodiesLock);
+    bodies[path] = body;
+}
+
+void FixtureServer::clear() {
+    std::lock_guard<std::mutex> lock(bodiesLock);
+    bodies.clear();
+}
@@ -0,0 +1,140 @@
+// Emulated Type 4 tag driven with the APDUs a phone sends to read an NDEF tag
+// (the NFC Forum T4T detection and read procedure), plus the error paths
+#include <string.h>
+#include <vector>
+#include "check.h"
+#include "Type4Tag.h"
+
+static const std::vector<uint8_t> SELECT_APP = {0x00, 0xA4, 0x04, 0x00, 0x07, 0xD2, 0x76, 0x00,
+                                                0x00, 0x85, 0x01, 0x01, 0x00};
+static const std::vector<uint8_t> SELECT_CC = {0x00, 0xA4, 0x00, 0x0C, 0x02, 0xE1, 0x03};
+static const std::vector<uint8_t> READ_CC = {0x00, 0xB0, 0x00, 0x00, 0x0F};
+static const std::vector<uint8_t> SELECT_NDEF = {0x00, 0xA4, 0x00, 0x0C, 0x02, 0xE1, 0x04};
+static const std::vector<uint8_t> READ_NLEN = {0x00, 0xB0, 0x00, 0x00, 0x02};
+static const std::vector<uint8_t> UPDATE_NLEN = {0x00, 0xD6, 0x00, 0x00, 0x02, 0x00, 0x00};
+
+static const uint8_t OK[] = {0x90, 0x00};
+
+// CCLEN 15, mapping 2.0, MLe 59, MLc 52, NDEF file E104 of 258 bytes, read-only
+static const uint8_t CC_FILE[] = {0x00, 0x0F, 0x20, 0x00, 0x3B, 0x00, 0x34, 0x04, 0x06,
+                                  0xE1, 0x04, 0x01, 0x02, 0x00, 0xFF, 0x90, 0x00};
+
+// "https://thumbstack.example/c/42": well-known URI record, prefix code 04
+static const uint8_t MESSAGE[] = {0xD1, 0x01, 0x18, 0x55, 0x04, 't', 'h', 'u', 'm', 'b', 's', 't', 'a', 'c',
+                                  'k', '.', 'e', 'x', 'a', 'm', 'p', 'l', 'e', '/', 'c', '/', '4', '2'};
+
+static std::vector<uint8_t> readBinary(uint16_t offset, uint8_t le) {
+    return {0x00, 0xB0, (uint8_t)(offset >> 8), (uint8_t)offset, le};
+}
+
+struct Exchange {
+    uint8_t bytes[Type4Tag::MAX_READ + 2];
+    size_t length;
+
+    Exchange(Type4Tag& tag, const std::vector<uint8_t>& apdu) {
+        length = tag.process(apdu.data(), apdu.size(), bytes, sizeof(bytes));
+    }
+    uint16_t sw() const { return length >= 2 ? (bytes[length - 2] << 8) | bytes[length - 1] : 0; }
+};
+
+static void checkReaderSession() {
+    Type4Tag tag;
+    CHECK(tag.setUri("https://thumbstack.example/c/42"));
+    tag.reset();
+
+    Exchange app(tag, SELECT_APP);
+    CHECK_BYTES(app.bytes, app.length, OK, sizeof(OK));
+    Exchange ccFile(tag, SELECT_CC);
+    CHECK_BYTES(ccFile.bytes, ccFile.length, OK, sizeof(OK));
+    Exchange cc(tag, READ_CC);
+    CHECK_BYTES(cc.bytes, cc.length, CC_FILE, sizeof(CC_FILE));
+    Exchange ndefFile(tag, SELECT_NDEF);
+    CHECK_BYTES(ndefFile.bytes, ndefFile.length, OK, sizeof(OK));
+
+    Exchange nlen(tag, READ_NLEN);
+    const uint8_t expectedNlen[] = {0x00, sizeof(MESSAGE), 0x90, 0x00};
+    CHECK_BYTES(nlen.bytes, nlen.length, expectedNlen, sizeof(expectedNlen));
+    CHECK(!tag.served());   // NLEN alone is not the message
+
+    Exchange message(tag, readBinary(2, sizeof(MESSAGE)));
+    CHECK_EQ(message.sw(), 0x9000);
+    CHECK_BYTES(message.bytes, message.length - 2, MESSAGE, sizeof(MESSAGE));
+    CHECK(tag.served());
+
+    // A new reader starts with nothing selected and nothing served
+    tag.reset();
+    CHECK(!tag.served());
+}
+
+static void checkLongMessage() {
+    Type4Tag tag;
+    char uri[160] = "https://thumbstack.example/";
+    size_t prefix = strlen(uri);
+    memset(uri + prefix, 'x', sizeof(uri) - prefix - 1);
+    CHECK(tag.setUri(uri));
+    Exchange(tag, SELECT_APP);
+    Exchange(tag, SELECT_NDEF);
+
+    // Le 0 asks for everything: capped at MLe, read on from there
+    Exchange first(tag, readBinary(0, 0));
+    CHECK_EQ(first.length, Type4Tag::MAX_READ + 2);
+    CHECK_EQ(first.sw(), 0x9000);
+    uint16_t nlen = (first.bytes[0] << 8) | first.bytes[1];
+    CHECK_EQ(nlen, 4 + 1 + (sizeof(uri) - 1 - 8));   // Short record header, prefix code, rest of the URI
+
+    size_t total = Type4Tag::MAX_READ;
+    while (total < 2u + nlen) {
+        Exchange next(tag, readBinary(total, Type4Tag::MAX_READ));
+        CHECK_EQ(next.sw(), 0x9000);
+        if (next.length <= 2) break;
+        total += next.length - 2;
+    }
+    CHECK_EQ(total, 2 + nlen);
+
+    // The end of the file reads empty; one past it is a wrong offset
+    Exchange atEnd(tag, readBinary(2 + nlen, 16));
+    CHECK_BYTES(atEnd.bytes, atEnd.length, OK, sizeof(OK));
+    CHECK_EQ(Exchange(tag, readBinary(2 + nlen + 1, 16)).sw(), 0x6B00);
+    CHECK_EQ(Exchange(tag, readBinary(0x7FFF, 1)).sw(), 0x6B00);
+}
+
+static void checkRejected() {
+    Type4Tag tag;
+    CHECK(tag.setUri("https://thumbstack.example/c/42"));
+
+    // READ BINARY before any file is selected
+    CHECK_EQ(Exchange(tag, READ_NLEN).sw(), 0x6986);
+    Exchange(tag, SELECT_APP);
+    CHECK_EQ(Exchange(tag, READ_NLEN).sw(), 0x6986);
+
+    // Offset past the end of the CC file
+    Exchange(tag, SELECT_CC);
+    CHECK_EQ(Exchange(tag, readBinary(sizeof(CC_FILE) - 2 + 1, 1)).sw(), 0x6B00);
+
+    // Read-only: writes are refused whatever is selected
+    CHECK_EQ(Exchange(tag, UPDATE_NLEN).sw(), 0x6982);
+    Exchange(tag, SELECT_NDEF);
+    Exchange refused(tag, UPDATE_NLEN);
+    const uint8_t securityStatus[] = {0x69, 0x82};
+    CHECK_BYTES(refused.bytes, refused.length, securityStatus, sizeof(securityStatus));
+    CHECK(!tag.served());
+
+    // Files are only found inside the NDEF application
+    tag.reset();
+    CHECK_EQ(Exchange(tag, SELECT_NDEF).sw(), 0x6A82);
+    const std::vector<uint8_t> otherApp = {0x00, 0xA4, 0x04, 0x00, 0x07, 0xA0, 0x00, 0x00, 0x00, 0x03, 0x10, 0x10};
+    CHECK_EQ(Exchange(tag, otherApp).sw(), 0x6A82);
+    CHECK_EQ(Exchange(tag, SELECT_NDEF).sw(), 0x6A82);
+
+    // Malformed and unsupported commands
+    CHECK_EQ(Exchange(tag, {0x00, 0xA4}).sw(), 0x6700);
+    CHECK_EQ(Exchange(tag, {0x00, 0xA4, 0x04, 0x00, 0x07, 0xD2, 0x76}).sw(), 0x6700);
+    CHECK_EQ(Exchange(tag, {0x80, 0xB0, 0x00, 0x00, 0x02}).sw(), 0x6E00);
+    CHECK_EQ(Exchange(tag, {0x00, 0xCA, 0x00, 0x00, 0x00}).sw(), 0x6D00);
+}
+
+void checkType4Tag() {
+    checkReaderSession();
+    checkLongMessage();
+    checkRejected();
+}
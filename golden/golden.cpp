@@ -0,0 +1,274 @@
+// Golden-image render checks: draws every view on the host simulator, splits
+// the panel into black and red planes and compares them with the PBMs in
+// golden/images. Each view also has a CPU-time and allocation budget.
+// Built by `pio run -e native-golden` in place of main.cpp; see golden/README.md.
+#include <Arduino.h>
+#include <HostSim.h>
+#include <MemoryStream.h>
+#include <SPIFFS.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "800x420.h"
+#include "800x480.h"
+#include "AllocCounter.h"
+#include "BMPHandler.h"
+#include "calender.h"
+#include "Config.h"
+#include "DisplayManager.h"
+#include "FetchScheduler.h"
+#include "Location.h"
+#include "NTP.h"
+#include "OpenWeather.h"
+#include "QRCodeManager.h"
+
+// Globals main.cpp normally provides to the display code
+LocationManager locationManager;
+NTPClient ntpClient;
+OpenWeather weather;
+FetchScheduler scheduler;
+int srcWeather = -1;
+
+// Reading shown in the status bar; "temp" lands at display.width() - 200
+static const char WEATHER_FIXTURE[] =
+    R"({"weather":[{"icon":"04d"}],"main":{"temp":14.2,"humidity":71},"name":"Amsterdam"})";
+
+// Wall clock for every run: Wednesday 18-09-2024 12:34 UTC, with the longest day name
+static const char FIXED_EPOCH[] = "1726662840";
+
+static bool fetchWeatherFixture() {
+    MemoryStream body(WEATHER_FIXTURE);
+    return weather.parseWeatherData(body);
+}
+
+struct GoldenView {
+    const char* name;
+    void (*render)();
+    uint32_t cpuBudgetUs;     // Host CPU time of one render (thread time, best of 3)
+    uint32_t allocBudget;     // Heap allocations of one render
+};
+
+static void renderQr() { showQRCode("WIFI:T:nopass;S:ThumbstackTech;;"); }
+
+// CPU budgets sit 3-8x over a desktop x86-64 run so only real regressions trip
+// them (GOLDEN_BUDGET_SCALE stretches them on slower machines). None of the views
+// may allocate.
+static const GoldenView VIEWS[] = {
+    {"welcome",    showWelcomeMessage,                    6000, 0},
+    {"qr",         renderQr,                             25000, 0},
+    {"dashboard",  showDashboard,                         2000, 0},
+    {"content",    ContentManager::displayContent,      150000, 0},
+    {"calendar",   CalendarManager::displayCalendar,    150000, 0},
+    {"fullscreen", FullScreenManager::displayFullScreen, 150000, 0},
+};
+
+// 1-bit BMP (bottom-up, white = 1) with an orientation marker: a black block
+// top-left, a black triangle bottom-right and a 1 px frame. A flipped or
+// mirrored decode moves the block and the triangle.
+static bool writeFixtureBmp(const char* path, int width, int height) {
+    const int rowSize = ((width + 31) / 32) * 4;
+    BMPHeader header = {};
+    header.signature = 0x4D42;
+    header.dataOffset = sizeof(BMPHeader) + 24 + 8;    // Rest of BITMAPINFOHEADER + 2-entry palette
+    header.fileSize = header.dataOffset + rowSize * height;
+    header.headerSize = 40;
+    header.width = width;
+    header.height = height;
+    header.planes = 1;
+    header.bitsPerPixel = 1;
+
+    File file = SPIFFS.open(path, "w");
+    if (!file) return false;
+    file.write((const uint8_t*)&header, sizeof(header));
+    uint8_t infoTail[24] = {}, palette[8] = {0, 0, 0, 0, 255, 255, 255, 0};
+    file.write(infoTail, sizeof(infoTail));
+    file.write(palette, sizeof(palette));
+
+    std::vector<uint8_t> row(rowSize);
+    for (int stored = 0; stored < height; stored++) {
+        int y = height - 1 - stored;
+        std::fill(row.begin(), row.end(), 0);
+        for (int x = 0; x < width; x++) {
+            bool black = (x < 160 && y < 80) || (x + y > width + height - 200) ||
+                         x == 0 || y == 0 || x == width - 1 || y == height - 1;
+            if (!black) row[x / 8] |= 0x80 >> (x % 8);
+        }
+        file.write(row.data(), rowSize);
+    }
+    file.close();
+    return true;
+}
+
+// One colour of the panel as a P4 bitmap (1 = ink)
+static std::vector<uint8_t> plane(const std::vector<uint8_t>& ram, uint8_t colour, int width, int height) {
+    const int stride = (width + 7) / 8;
+    std::vector<uint8_t> bits(stride * height, 0);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (ram[y * width + x] == colour) bits[y * stride + x / 8] |= 0x80 >> (x % 8);
+        }
+    }
+    return bits;
+}
+
+static bool writePbm(const std::string& path, const std::vector<uint8_t>& bits, int width, int height) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    fprintf(f, "P4\n%d %d\n", width, height);
+    fwrite(bits.data(), 1, bits.size(), f);
+    return fclose(f) == 0;
+}
+
+static bool readPbm(const std::string& path, std::vector<uint8_t>& bits, int width, int height) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    int w = 0, h = 0;
+    bool ok = fscanf(f, "P4 %d %d", &w, &h) == 2 && fgetc(f) != EOF && w == width && h == height;
+    if (ok) {
+        bits.resize(((width + 7) / 8) * height);
+        ok = fread(bits.data(), 1, bits.size(), f) == bits.size();
+    }
+    fclose(f);
+    return ok;
+}
+
+// Differing pixels and their bounding box
+struct PlaneDiff {
+    uint32_t pixels = 0;
+    int x0 = INT16_MAX, y0 = INT16_MAX, x1 = -1, y1 = -1;
+};
+
+static PlaneDiff diffPlanes(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, int width, int height) {
+    PlaneDiff d;
+    const int stride = (width + 7) / 8;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t mask = 0x80 >> (x % 8);
+            if ((a[y * stride + x / 8] ^ b[y * stride + x / 8]) & mask) {
+                d.pixels++;
+                d.x0 = std::min(d.x0, x);
+                d.y0 = std::min(d.y0, y);
+                d.x1 = std::max(d.x1, x);
+                d.y1 = std::max(d.y1, y);
+            }
+        }
+    }
+    return d;
+}
+
+static uint64_t threadCpuMicros() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// Renders one view, checks its budgets and both colour planes; true if it passed
+static bool checkView(const GoldenView& view, const std::string& goldenDir, const std::string& outDir,
+                      bool update, double budgetScale) {
+    uint64_t bestCpu = UINT64_MAX;
+    uint32_t allocs = 0;
+    for (int run = 0; run < 3; run++) {
+        invalidateFrame();
+        AllocCounter::begin();
+        uint64_t start = threadCpuMicros();
+        view.render();
+        bestCpu = std::min(bestCpu, threadCpuMicros() - start);
+        allocs = std::max(allocs, AllocCounter::end());
+    }
+
+    const int width = display.width(), height = display.height();
+    const std::vector<uint8_t>& ram = display.simRam();
+    bool passed = true;
+    HostSim::muteSerial(false);
+
+    uint32_t cpuBudget = (uint32_t)(view.cpuBudgetUs * budgetScale);
+    if (bestCpu > cpuBudget) {
+        Serial.printf("❌ %s: %llu us CPU, budget %u us\n", view.name, (unsigned long long)bestCpu, cpuBudget);
+        passed = false;
+    }
+    if (allocs > view.allocBudget) {
+        Serial.printf("❌ %s: %u allocations, budget %u\n", view.name, allocs, view.allocBudget);
+        passed = false;
+    }
+
+    static const struct { const char* suffix; uint8_t colour; } PLANES[] = {{"black", SIM_BLACK}, {"red", SIM_RED}};
+    for (const auto& p : PLANES) {
+        std::vector<uint8_t> actual = plane(ram, p.colour, width, height);
+        std::string file = std::string(view.name) + "." + p.suffix + ".pbm";
+        std::vector<uint8_t> golden;
+
+        if (update) {
+            if (!writePbm(goldenDir + "/" + file, actual, width, height)) {
+                Serial.printf("❌ %s: cannot write %s/%s\n", view.name, goldenDir.c_str(), file.c_str());
+                passed = false;
+            }
+            continue;
+        }
+        if (!readPbm(goldenDir + "/" + file, golden, width, height)) {
+            Serial.printf("❌ %s: no golden %s/%s (bless it with GOLDEN_UPDATE=1)\n", view.name,
+                          goldenDir.c_str(), file.c_str());
+            passed = false;
+            continue;
+        }
+        PlaneDiff d = diffPlanes(golden, actual, width, height);
+        if (d.pixels) {
+            writePbm(outDir + "/" + file, actual, width, height);
+            Serial.printf("❌ %s: %s plane differs in %u px within %d,%d..%d,%d (actual in %s/%s)\n", view.name,
+                          p.suffix, d.pixels, d.x0, d.y0, d.x1, d.y1, outDir.c_str(), file.c_str());
+            passed = false;
+        }
+    }
+
+    if (passed) {
+        Serial.printf("✅ %-10s %6llu us CPU (budget %u), %u allocs\n", view.name, (unsigned long long)bestCpu,
+                      cpuBudget, allocs);
+    }
+    HostSim::muteSerial(true);
+    return passed;
+}
+
+void setup() {
+    setenv("SIM_FRAMES", "0", 0);
+    setenv("SIM_EPOCH", FIXED_EPOCH, 1);   // Before the first clock read, see HostSim's wall clock
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    const std::string goldenDir = HostSim::env("GOLDEN_DIR", "golden/images");
+    const std::string outDir = HostSim::outDir() + "/golden";
+    const bool update = atoi(HostSim::env("GOLDEN_UPDATE", "0")) != 0;
+    const double budgetScale = atof(HostSim::env("GOLDEN_BUDGET_SCALE", "1"));
+    HostSim::makeDirs(update ? goldenDir : outDir);
+
+    HostSim::muteSerial(true);
+    display.init(0);
+    display.setRotation(0);
+
+    // Fixed inputs: images on SPIFFS, one weather reading, the pinned clock
+    SPIFFS.begin(true);
+    bool fixtures = writeFixtureBmp(CONTENT_BMP_PATH, 800, 420) && writeFixtureBmp(CALENDAR_BMP_PATH, 800, 480) &&
+                    writeFixtureBmp(FULLSCREEN_BMP_PATH, 800, 480);
+    srcWeather = scheduler.addSource("weather", fetchWeatherFixture, WEATHER_TTL_MS, WEATHER_STALE_MS);
+    fixtures = scheduler.refreshNow(srcWeather) && fixtures;
+    HostSim::muteSerial(false);
+    if (!fixtures) {
+        Serial.println("❌ Could not set up the fixtures");
+        fflush(stdout);
+        _exit(1);
+    }
+    HostSim::muteSerial(true);
+
+    int failed = 0;
+    for (const GoldenView& view : VIEWS) {
+        if (!checkView(view, goldenDir, outDir, update, budgetScale)) failed++;
+    }
+
+    HostSim::muteSerial(false);
+    if (update) Serial.printf("📝 Goldens written to %s\n", goldenDir.c_str());
+    const unsigned viewCount = sizeof(VIEWS) / sizeof(VIEWS[0]);
+    if (failed) Serial.printf("❌ %d of %u views failed\n", failed, viewCount);
+    else Serial.printf("✅ All %u views passed\n", viewCount);
+    fflush(stdout);
+    _exit(failed ? 1 : 0);
+}
+
+void loop() {}
@@ -4,13 +4,15 @@
 #include <HTTPClient.h>
 #include <SPIFFS.h>
 #include "DisplayManager.h"
+#include "Config.h"
 
 class ContentManager {
 public:
-    static void downloadContentBMP();
+    static bool downloadContentBMP(const char* url = nullptr);  // nullptr = default URL
     static void displayContent();
+    static void displayContentRegion(int16_t x, int16_t y, int16_t w, int16_t h);  // image coordinates
     
 private:
     static const char* CONTENT_BMP_URL;
-    static void drawBMPFromFile(const char* filename);
+    static bool drawBMPFromFile(const char* filename, int16_t rowFrom = 0, int16_t rowTo = -1);  // false = bailed out
 };
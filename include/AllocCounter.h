@@ -0,0 +1,13 @@
+#pragma once
+#include <Arduino.h>
+
+// Counts heap allocations (malloc/calloc/realloc) made by one task between
+// begin() and end(). Hooked in with the linker's --wrap option, see build_flags
+// in platformio.ini. Used to check that the steady-state refresh path never
+// touches the heap.
+class AllocCounter {
+public:
+    static void begin();        // Start counting allocations made by the calling task
+    static uint32_t end();      // Stop and return how many were made
+    static uint32_t total();    // Allocations by any task since boot
+};
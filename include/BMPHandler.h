@@ -0,0 +1,38 @@
+#pragma once
+#include <Arduino.h>
+#include <GxEPD2_3C.h>
+
+// BMP header structure (file header + start of BITMAPINFOHEADER)
+struct BMPHeader {
+    uint16_t signature;
+    uint32_t fileSize;
+    uint32_t reserved;
+    uint32_t dataOffset;
+    uint32_t headerSize;
+    int32_t width;
+    int32_t height;
+    uint16_t planes;
+    uint16_t bitsPerPixel;
+} __attribute__((packed));
+
+// Bytes per stored row (rows are padded to 4 bytes)
+inline int bmpRowSize(const BMPHeader& header) {
+    return ((header.width * header.bitsPerPixel + 31) / 32) * 4;
+}
+
+// Draws one stored 1-bit row (MSB first, set bit = white) at display row y
+template <typename Display>
+inline void bmpDrawRow1(Display& display, const uint8_t* row, int width, int16_t y) {
+    for (int x = 0; x < width; x++) {
+        bool pixel = (row[x / 8] >> (7 - (x % 8))) & 1;
+        display.drawPixel(x, y, pixel ? GxEPD_WHITE : GxEPD_BLACK);
+    }
+}
+
+// Draws one 8-bit grayscale row, thresholded to black/white, at display row y
+template <typename Display>
+inline void bmpDrawRow8(Display& display, const uint8_t* row, int width, int16_t y, uint8_t threshold = 128) {
+    for (int x = 0; x < width; x++) {
+        display.drawPixel(x, y, row[x] < threshold ? GxEPD_BLACK : GxEPD_WHITE);
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <Arduino.h>
+#include <time.h>
+
+enum ClimateResolution : uint8_t {
+    CLIMATE_MINUTE = 0,       // Last 24 h, RTC RAM
+    CLIMATE_HOUR,             // Last 24 h, RTC RAM (hour page summaries)
+    CLIMATE_QUARTER_HOUR,     // Last 30 days, SPIFFS
+    CLIMATE_RESOLUTION_COUNT
+};
+
+struct ClimateBucket {
+    time_t start;             // 0 = no samples in this bucket
+    float minTemp, maxTemp, avgTemp;
+    float minHumidity, maxHumidity, avgHumidity;
+};
+
+// Indoor climate history from the DHT22, in fixed memory. Minute averages for the
+// last 24 h sit in RTC RAM (survives deep sleep and soft resets) as hour pages:
+// a 16-bit keyframe plus 8-bit deltas per minute, each page with a min/max/sum
+// summary. Every closed quarter hour is appended to a 30-day ring file on SPIFFS,
+// 16 records (4 h) per flash write. Every bucket lookup is constant time.
+class ClimateLog {
+public:
+    static void begin();
+    static void poll();                           // From loop(): folds in new DHT22 samples
+    static bool getBucket(ClimateResolution resolution, uint16_t ago, ClimateBucket& bucket);  // ago 0 = current
+    static uint16_t bucketCount(ClimateResolution resolution);
+    static uint32_t revision();                   // Bumped whenever an hour closes (sparkline redraw)
+    static void printStats();
+};
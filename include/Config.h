@@ -0,0 +1,96 @@
+#pragma once
+#include <time.h>
+
+// ---- Servers ----
+// Content server (Node app serving page BMPs, the manifest and the NFC business card)
+#define CONTENT_SERVER   "http://192.168.1.4:3000"
+// Dashboard renderer (Flask app producing status/dashboard BMPs)
+#define DASHBOARD_SERVER "http://192.168.1.4:5000"
+
+// ---- Content manifest ----
+// One compact JSON document listing every page's URL, hash, size, format, TTL and dwell.
+// Set to 0 to fall back to unconditionally downloading every page (useful for A/B traffic tests).
+#ifndef USE_CONTENT_MANIFEST
+#define USE_CONTENT_MANIFEST 1
+#endif
+const char* const MANIFEST_URL = CONTENT_SERVER "/manifest.json";
+
+// ---- Page assets (legacy fixed URLs, used when the manifest is unavailable) ----
+const char* const CONTENT_BMP_URL_DEFAULT    = CONTENT_SERVER "/image_800x420.bmp";
+const char* const CALENDAR_BMP_URL_DEFAULT   = CONTENT_SERVER "/calendar.bmp";
+const char* const FULLSCREEN_BMP_URL_DEFAULT = CONTENT_SERVER "/image_800x480.bmp";
+const char* const DASHBOARD_BMP_URL          = DASHBOARD_SERVER "/dashboard";
+const char* const WAKE_IMAGE_URL             = DASHBOARD_SERVER "/wake_image";
+const char* const NFC_CARD_URL               = CONTENT_SERVER "/Bcard";
+
+// Local SPIFFS copies of each page
+const char* const CONTENT_BMP_PATH    = "/content.bmp";
+const char* const CALENDAR_BMP_PATH   = "/calendar.bmp";
+const char* const FULLSCREEN_BMP_PATH = "/fullscreen.bmp";
+
+// ---- Defaults when the manifest does not say otherwise ----
+const unsigned long DEFAULT_MANIFEST_TTL_S = 300;    // Re-check manifest every 5 minutes
+const unsigned long DEFAULT_PAGE_TTL_S     = 3600;   // Re-check a page at most hourly
+const unsigned long DEFAULT_PAGE_DWELL_S   = 60;     // Show each page for 60 seconds
+
+// ---- Fetch scheduler: how long each source stays fresh, then usable-but-stale ----
+const unsigned long LOCATION_TTL_MS   = 6UL * 3600000UL;   // A fixed display rarely moves
+const unsigned long LOCATION_STALE_MS = 24UL * 3600000UL;
+const uint32_t LOCATION_CACHE_TTL_S   = 7UL * 24UL * 3600UL;  // Re-resolve even if the public IP is unchanged
+const unsigned long WEATHER_TTL_MS    = 30UL * 60000UL;    // OpenWeather updates ~every 10 min
+const unsigned long WEATHER_STALE_MS  = 3UL * 3600000UL;
+const unsigned long TIME_TTL_MS       = 6UL * 3600000UL;   // SNTP keeps syncing in the background
+const unsigned long TIME_STALE_MS     = 24UL * 3600000UL;
+const unsigned long PAGE_STALE_MS     = 24UL * 3600000UL;
+
+// ---- Clock ----
+const time_t MIN_VALID_EPOCH = 1609459200;                      // 2021-01-01; earlier means never set
+const unsigned long NTP_MIN_SYNC_INTERVAL_MS = 3600000UL;       // Until the drift has been measured
+const unsigned long NTP_MAX_SYNC_INTERVAL_MS = 24UL * 3600000UL;
+const unsigned long NTP_MAX_CLOCK_ERROR_MS = 1000;              // Resync before drift could exceed this
+
+// Minute refreshes start early by their measured latency to land within this much after the boundary
+const unsigned long REFRESH_TARGET_TOLERANCE_MS = 1000;
+
+// ---- NFC ----
+const int NFC_IRQ_PIN = -1;                           // PN532 IRQ line; -1 = not wired, poll instead
+const unsigned long NFC_POLL_MIN_MS = 200;            // Poll interval while a tag is (or was just) present
+const unsigned long NFC_POLL_MAX_MS = 2000;           // Backed off to this while no tag shows up
+const uint32_t NFC_WRITE_ATTEMPTS = 3;
+const uint32_t NFC_BENCH_READS = 20;                  // Reads per kind in `bench nfc`
+const unsigned long NFC_BENCH_TAG_WAIT_MS = 3000;     // `bench nfc` waits this long for a tag
+
+// Emulate a Type 4 tag serving the URL from RAM instead of writing physical NTAGs
+#ifndef NFC_EMULATE_TAG
+#define NFC_EMULATE_TAG 0
+#endif
+
+// ---- DHT22 ----
+const unsigned long DHT_SAMPLE_INTERVAL_MS = 2500;   // The sensor allows one conversion per 2 s
+const unsigned long DHT_WARMUP_MS = 2000;            // Power-up settling before the first reading
+
+// ---- Network trace (see NetTrace.h) ----
+#define NET_TRACE_OFF 0
+#define NET_TRACE_CAPTURE_SPIFFS 1       // Record every HTTP exchange to NET_TRACE_PATH
+#define NET_TRACE_CAPTURE_SERIAL 2       // ...or as "NT:" hex lines on Serial
+#define NET_TRACE_REPLAY 3               // Serve every request from NET_TRACE_PATH
+#ifndef NET_TRACE
+#define NET_TRACE NET_TRACE_OFF
+#endif
+const char* const NET_TRACE_PATH = "/net.trace";
+const uint32_t NET_TRACE_MAX_BYTES = 400UL * 1024UL;   // SPIFFS capture stops here (a page BMP is ~48 KB)
+const bool NET_TRACE_REPLAY_REALTIME = true;           // false = chunks are ready as soon as they are read
+
+// ---- Serial bench commands (see SelfBench.h) ----
+const uint32_t SELF_BENCH_SPIFFS_BYTES = 64UL * 1024UL;             // Written, read back and removed
+const char* const SELF_BENCH_HTTP_URL = FULLSCREEN_BMP_URL_DEFAULT; // `bench http` without a URL
+const unsigned long SELF_BENCH_HTTP_STALL_MS = 10000;               // Give up when the body stops coming
+
+// ---- Telemetry ----
+const unsigned long HEAP_SNAPSHOT_INTERVAL_MS = 15UL * 60000UL;   // Heap/stack snapshot over serial
+
+// Metrics endpoint for a fleet collector (see Metrics.h); 0 keeps the port closed
+#ifndef METRICS_ENABLED
+#define METRICS_ENABLED 1
+#endif
+const uint16_t METRICS_PORT = 80;
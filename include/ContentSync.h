@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Changed area of a page, in image coordinates
+struct DirtyRect {
+    int16_t x, y, w, h;
+
+    bool isEmpty() const { return w <= 0 || h <= 0; }
+    void add(int16_t rx, int16_t ry, int16_t rw, int16_t rh) {
+        if (isEmpty()) { x = rx; y = ry; w = rw; h = rh; return; }
+        int16_t x2 = max<int16_t>(x + w, rx + rw);
+        int16_t y2 = max<int16_t>(y + h, ry + rh);
+        x = min(x, rx);
+        y = min(y, ry);
+        w = x2 - x;
+        h = y2 - y;
+    }
+};
+
+// One page as advertised by the content manifest
+struct ManifestEntry {
+    String id;                  // "content", "calendar", "fullscreen"
+    String url;                 // Absolute, or relative to CONTENT_SERVER
+    String hash;                // Server-side content hash (opaque to the device)
+    uint32_t size;              // Expected body size in bytes
+    String format;              // e.g. "bmp1" (1-bit BMP)
+    String tiles;               // Optional tile endpoint for delta sync (see TileSync.h)
+    uint32_t ttl;               // Seconds between re-checks of this page
+    uint32_t dwell;             // Seconds to keep this page on screen
+    unsigned long lastChecked;  // millis() of the last sync attempt
+    DirtyRect dirty;            // Area changed by the last sync (whole page after a full download)
+};
+
+// Traffic counters since boot (bodies only, HTTP headers are not counted)
+struct SyncStats {
+    uint32_t requests;      // HTTP requests issued (manifest + pages)
+    uint32_t bytes;         // Response body bytes received
+    uint32_t notModified;   // Manifest fetches answered with 304
+    uint32_t downloads;     // Page bodies downloaded
+    uint32_t skipped;       // Page syncs satisfied by the local cache
+    uint32_t tileUpdates;   // Page syncs satisfied by patching changed tiles
+};
+
+enum SyncResult {
+    SYNC_FAILED,
+    SYNC_UNCHANGED,
+    SYNC_UPDATED
+};
+
+class ContentSync {
+public:
+    static const int MAX_PAGES = 8;
+
+    static bool fetchManifest();
+    static SyncResult syncPage(const char* id);
+
+    static bool hasManifest();
+    static unsigned long getDwellMs(const char* id);
+    static unsigned long getTtlMs(const char* id);
+    static unsigned long getManifestTtlMs();
+    static DirtyRect getDirtyRect(const char* id);
+    static const SyncStats& getStats();
+    static void printStats();
+
+private:
+    static ManifestEntry entrySlots[2][MAX_PAGES];  // Current manifest and the one being parsed
+    static ManifestEntry* entries;                  // Points into entrySlots
+    static int entryCount;
+    static bool manifestValid;
+    static String manifestETag;
+    static unsigned long manifestFetchedAt;
+    static unsigned long manifestTtlMs;
+    static SyncStats stats;
+
+    static ManifestEntry* findEntry(const char* id);
+    static bool parseManifest(const String& payload);
+    static bool downloadPage(const char* id, const char* url);
+    static const char* localPathFor(const char* id);
+    static bool loadLocalHash(const char* id, String& hash);
+    static void saveLocalHash(const char* id, const String& hash);
+    static void clearLocalHash(const char* id);
+};
@@ -3,19 +3,35 @@
 
 #include <Arduino.h>
 
+struct DhtSample {
+    uint32_t atMs;          // millis() when the frame was captured
+    float temperature;      // Median-filtered, °C
+    float humidity;         // Median-filtered, %RH
+};
+
+// The DHT22 is sampled by a background task: the start pulse is timed with
+// vTaskDelay and the reply is captured by the RMT peripheral, so interrupts
+// stay enabled and the CPU never spins on the data line. Filtered samples go
+// into a single-producer ring; readers only look at its newest slot.
 class DHT22Manager {
 public:
     static const uint8_t DHT_PIN = 15;  // DHT22 data pin
-    static bool begin();
-    static float getTemperature();
+    static bool begin();                // Starts sampling in the background, never blocks
+    static bool hasReading();
+    static bool getLatest(DhtSample& sample);
+    static float getTemperature();      // Latest filtered value, NAN until the first reading
     static float getHumidity();
-    static bool update();
+    static void printStats();
 
 private:
-    static float temperature;
-    static float humidity;
-    static unsigned long lastReadTime;
-    static const unsigned long READ_INTERVAL = 2000;  // Read every 2 seconds
+    static const uint8_t RING_SIZE = 16;
+
+    static DhtSample ring[RING_SIZE];
+    static volatile uint32_t head;      // Samples published so far; slot = head % RING_SIZE
+
+    static void taskEntry(void* arg);
+    static void sample();
+    static void publish(float temperature, float humidity);
 };
 
 #endif // DHT22_H
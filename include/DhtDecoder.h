@@ -0,0 +1,23 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// DHT22 single-wire frame decoding from captured pulse widths. Plain C++ with
+// no Arduino dependencies, so recorded pulse trains can be replayed on the host.
+
+// One low phase and the high phase that follows it, in microseconds
+struct DhtPulse {
+    uint16_t lowUs;
+    uint16_t highUs;
+};
+
+enum DhtDecodeResult : uint8_t {
+    DHT_OK = 0,
+    DHT_TOO_FEW_PULSES,     // Sensor didn't answer or the capture was cut short
+    DHT_BAD_TIMING,         // A bit's pulses are outside the datasheet windows
+    DHT_BAD_CHECKSUM
+};
+
+// The last 40 pulses are the data bits (a 0 is ~26 us high, a 1 ~70 us);
+// anything before them is the sensor's 80/80 us response
+DhtDecodeResult dhtDecode(const DhtPulse* pulses, size_t count, float& temperature, float& humidity);
@@ -2,6 +2,8 @@
 #include <GxEPD2_3C.h>
 #include <SPI.h>
 #include <Fonts/FreeMonoBold9pt7b.h>
+#include "FrameHash.h"
+#include "Metrics.h"
 
 // Function declarations
 void performFullRefresh();
@@ -10,6 +12,22 @@ void updateStatusBar(bool refreshDisplay);  // Remove default argument from decl
 void updateTimeDisplay();
 void showDashboard();
 
+// Redraw elision: every view hashes what it is about to draw and skips the SPI
+// transfer and panel refresh when the panel already shows that frame. The hash
+// only counts as shown once commitFrame() follows the last nextPage(); a draw
+// that bails out part way calls invalidateFrame() instead.
+struct RefreshCounters {
+    uint32_t executed;   // Refreshes sent to the panel
+    uint32_t elided;     // Refreshes skipped because the frame was unchanged
+};
+bool beginFrame(uint64_t frameHash, const char* viewName);  // false = already on the panel
+void commitFrame();                                          // The frame begun is now on the panel
+void invalidateFrame();                                      // Panel content unknown (e.g. after a clean)
+void hashStatusBar(FrameHasher& hasher);                     // Mix in everything updateStatusBar() draws;
+                                                             // also fixes the time and indoor reading drawn
+void hashFile(FrameHasher& hasher, const char* path);        // Mix in an image file's bytes
+const RefreshCounters& getRefreshCounters();
+
 // Refresh intervals (in milliseconds)
 const unsigned long TIME_REFRESH_INTERVAL = 60000;   // 1 minute
 const unsigned long FULL_REFRESH_INTERVAL = 3600000; // 1 hour
@@ -41,7 +59,63 @@ using EpdPanel = GxEPD2_750c_Z08;  // 800x480, 3-color, older variant
 #else
 using EpdPanel = GxEPD2_750c_Z90;  // 800x480, 3-color, Waveshare V2
 #endif
-extern GxEPD2_3C<EpdPanel, 16> display;
+
+// The paged driver with each frame timed for Metrics: drawing between page
+// writes (render), the page writes themselves (SPI) and the final refresh. The
+// last nextPage() writes one more page, then refreshes and waits out BUSY; the
+// average page write is counted as SPI and the rest as refresh.
+template <typename Panel, const uint16_t PageHeight>
+class TimedDisplay : public GxEPD2_3C<Panel, PageHeight> {
+public:
+    typedef GxEPD2_3C<Panel, PageHeight> Base;
+    using Base::Base;
+
+    void setFullWindow() {
+        Base::setFullWindow();
+        _partial = false;
+    }
+
+    void setPartialWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+        Base::setPartialWindow(x, y, w, h);
+        _partial = true;
+    }
+
+    void firstPage() {
+        Base::firstPage();
+        _frameStart = micros();
+        _spiUs = 0;
+        _pages = 0;
+    }
+
+    bool nextPage() {
+        uint32_t start = micros();
+        bool more = Base::nextPage();
+        uint32_t took = micros() - start;
+        if (more) {
+            _spiUs += took;
+            _pages++;
+            return true;
+        }
+        uint32_t lastPageUs = _pages ? _spiUs / _pages : 0;
+        uint32_t renderUs = start - _frameStart - _spiUs;
+        Metrics::recordFrame(_partial, renderUs, _spiUs + lastPageUs, took > lastPageUs ? took - lastPageUs : 0);
+        return false;
+    }
+
+    // Streamed frames: drawing happened before this, SPI and refresh are not told apart
+    void display(bool partialUpdateMode = false) {
+        uint32_t start = micros();
+        Base::display(partialUpdateMode);
+        Metrics::recordFrame(partialUpdateMode, 0, 0, micros() - start);
+    }
+
+private:
+    bool _partial = false;
+    uint32_t _frameStart = 0;
+    uint32_t _spiUs = 0;
+    uint16_t _pages = 0;
+};
+extern TimedDisplay<EpdPanel, 16> display;
 
 void setupPowerEnable();
 void initDisplay();
@@ -0,0 +1,60 @@
+#pragma once
+#include <Arduino.h>
+
+// One network-backed data source (location, weather, time, an image page...)
+struct FetchSource {
+    const char* name;
+    bool (*fetch)();               // One attempt, no internal retries or sleeps
+    unsigned long ttlMs;           // Data is fresh for this long after a success
+    unsigned long staleMs;         // ...then still usable this much longer while revalidating
+    unsigned long backoffBaseMs;   // First retry delay after a failure
+    unsigned long backoffMaxMs;    // Retry delay cap
+    uint8_t failureBudget;         // Consecutive failures before waiting a full TTL
+
+    // Runtime state
+    bool hasData;
+    unsigned long lastSuccess;     // millis() of the last successful fetch
+    unsigned long nextAttempt;     // millis() when the next attempt is due
+    uint8_t failures;              // Consecutive failures
+    bool paused;                   // Skipped by tick(); nothing shows its data any more
+    uint32_t attempts;
+    uint32_t successes;
+};
+
+// Runs at most one due fetch per tick() so retries never block loop() for
+// longer than a single attempt. Failures back off exponentially with +-50%
+// jitter; after failureBudget consecutive failures the source waits a full
+// TTL before trying again.
+class FetchScheduler {
+public:
+    static const int MAX_SOURCES = 8;
+
+    FetchScheduler();
+    int addSource(const char* name, bool (*fetch)(), unsigned long ttlMs, unsigned long staleMs,
+                  unsigned long backoffBaseMs = 5000, unsigned long backoffMaxMs = 600000,
+                  uint8_t failureBudget = 5);
+    void setTtl(int id, unsigned long ttlMs);
+
+    int tick();                 // Returns the id of the source refreshed this tick, or -1
+    bool refreshNow(int id);    // Immediate single attempt (e.g. at boot)
+    void markCached(int id);    // Data restored from persistent storage: usable now, revalidated next tick
+    void pause(int id);         // No more background fetches; refreshNow() still works
+
+    bool isFresh(int id) const;
+    bool isUsable(int id) const;    // Fresh or within the stale-while-revalidate window
+
+    int sourceCount() const { return _count; }
+    const FetchSource& getSource(int id) const { return _sources[id]; }
+
+    void recordLoopTime(unsigned long ms);
+    void printStats() const;
+
+private:
+    FetchSource _sources[MAX_SOURCES];
+    int _count;
+    int _next;                       // Round-robin start so one busy source can't starve others
+    unsigned long _maxLoopMs;
+    unsigned long _startedAt;
+
+    bool attempt(FetchSource& src);
+};
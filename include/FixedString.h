@@ -0,0 +1,71 @@
+#pragma once
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// NUL-terminated string with inline storage for N characters. Never touches the
+// heap: writes that don't fit are truncated (and flagged) instead of reallocating.
+template <size_t N>
+class FixedString {
+public:
+    FixedString() { clear(); }
+    FixedString(const char* str) { assign(str); }
+
+    FixedString& operator=(const char* str) { return assign(str); }
+
+    FixedString& assign(const char* str) {
+        clear();
+        return append(str);
+    }
+
+    FixedString& append(const char* str) {
+        if (!str) return *this;
+        size_t len = strlen(str);
+        if (len > N - _len) {
+            len = N - _len;
+            _truncated = true;
+        }
+        memcpy(_buf + _len, str, len);
+        _len += len;
+        _buf[_len] = '\0';
+        return *this;
+    }
+
+    // printf-style append, e.g. url.appendf("?lat=%.6f", lat)
+    FixedString& appendf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, fmt);
+        int written = vsnprintf(_buf + _len, N + 1 - _len, fmt, args);
+        va_end(args);
+        if (written < 0) {
+            _buf[_len] = '\0';
+        } else if ((size_t)written > N - _len) {
+            _len = N;
+            _truncated = true;
+        } else {
+            _len += written;
+        }
+        return *this;
+    }
+
+    void clear() {
+        _len = 0;
+        _truncated = false;
+        _buf[0] = '\0';
+    }
+
+    const char* c_str() const { return _buf; }
+    size_t length() const { return _len; }
+    bool isEmpty() const { return _len == 0; }
+    bool truncated() const { return _truncated; }
+    static size_t capacity() { return N; }
+
+    bool operator==(const char* str) const { return strcmp(_buf, str ? str : "") == 0; }
+    bool operator!=(const char* str) const { return !(*this == str); }
+
+private:
+    char _buf[N + 1];
+    size_t _len;
+    bool _truncated;
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// 64-bit FNV-1a over everything a view draws (view id, strings, numbers, image bytes).
+// Two frames with the same hash are treated as pixel-identical, so the panel
+// transfer and refresh can be skipped.
+class FrameHasher {
+public:
+    explicit FrameHasher(const char* viewId) : _hash(FNV_OFFSET) { add(viewId); }
+
+    FrameHasher& add(const void* data, size_t len) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < len; i++) {
+            _hash ^= p[i];
+            _hash *= FNV_PRIME;
+        }
+        return *this;
+    }
+
+    // Strings are hashed with their terminator so "ab"+"c" differs from "a"+"bc"
+    FrameHasher& add(const char* str) { return add(str ? str : "", strlen(str ? str : "") + 1); }
+    FrameHasher& add(int32_t v) { return add(&v, sizeof(v)); }
+    FrameHasher& add(float v) { return add(&v, sizeof(v)); }
+    FrameHasher& add(bool v) { return add(&v, sizeof(v)); }
+
+    uint64_t value() const { return _hash; }
+
+private:
+    static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    static const uint64_t FNV_PRIME = 1099511628211ULL;
+    uint64_t _hash;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <Arduino.h>
+
+// Subsystems heap traffic is attributed to
+enum HeapTag : uint8_t {
+    HEAP_OTHER = 0,
+    HEAP_DISPLAY,
+    HEAP_HTTP,
+    HEAP_JSON,
+    HEAP_NFC,
+    HEAP_STORAGE,
+    HEAP_TAG_COUNT
+};
+
+struct HeapTagStats {
+    uint32_t allocs;            // malloc/calloc/realloc calls made while tagged
+    uint32_t bytes;             // Bytes requested by those calls
+    uint32_t scopes;            // Times the subsystem was entered
+    int32_t retained;           // Free heap lost across its scopes, summed (leaks, caches)
+    int32_t largestBlockLoss;   // Largest free block lost across its scopes, summed (fragmentation)
+};
+
+// Per-subsystem heap accounting plus global free heap, low-water mark, largest
+// free block and loop task stack headroom. Each allocation is attributed to the
+// innermost HeapScope open on the allocating task; anything else is "other".
+// Scopes nest per task, so the loop and the NFC task can be tagged at once.
+class HeapTelemetry {
+public:
+    static void recordAlloc(size_t size);   // Called from the malloc hooks only
+    static void poll();                     // From loop(): snapshot every HEAP_SNAPSHOT_INTERVAL_MS
+    static void printSnapshot();
+    static const HeapTagStats& getStats(HeapTag tag);
+    static const char* tagName(HeapTag tag);
+    static uint32_t minLargestBlock();      // Smallest largest-free-block seen by poll()
+
+private:
+    friend class HeapScope;
+    static HeapTag currentTag();            // Innermost tag of the calling task
+    static void enter(HeapTag tag);
+    static void leave(HeapTag previous);
+};
+
+// Tags allocations until the end of the enclosing block and records how much
+// free heap and largest-block size the block cost
+class HeapScope {
+public:
+    explicit HeapScope(HeapTag tag);
+    ~HeapScope();
+
+private:
+    HeapTag _tag;
+    HeapTag _prevTag;
+    uint32_t _freeBefore;
+    uint32_t _largestBefore;
+};
@@ -1,11 +1,12 @@
 #pragma once
 #include <Arduino.h>
 #include <HardwareSerial.h>
+#include "FixedString.h"
 
 struct LocationData {
-    String city;
-    String country;
-    String region;
+    FixedString<32> city;
+    FixedString<32> country;
+    FixedString<32> region;
     float latitude;
     float longitude;
 };
@@ -13,13 +14,19 @@ struct LocationData {
 class LocationManager {
 public:
     LocationManager();
+    bool begin();           // Load the location persisted in NVS; true if one was found
     bool updateLocation();
-    String getLocationString();
-    LocationData getCurrentLocation();
+    const char* getLocationString() const;          // "City, Country"; valid until the next update
+    const LocationData& getCurrentLocation() const;
+    bool parseIPGeolocation(Stream& response);     // ipinfo.io body; public so bench/ can feed it fixtures
     
 private:
     LocationData _currentLocation;
     bool _locationValid;
+    FixedString<68> _locationString;
+    FixedString<39> _publicIP;  // Public IP the current location was resolved for
+    uint32_t _resolvedAt;   // Epoch seconds of that lookup (0 = unknown)
     
-    bool parseIPGeolocation(String& response);
+    void saveCache();
+    void updateLocationString();
 };
\ No newline at end of file
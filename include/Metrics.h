@@ -0,0 +1,35 @@
+#pragma once
+#include <Arduino.h>
+
+struct NfcEvent;
+
+// Upper bucket edges of every duration histogram, in ms; longer samples land in +Inf
+const int METRIC_BUCKET_COUNT = 12;
+const uint32_t METRIC_BUCKET_MS[METRIC_BUCKET_COUNT] = {5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000};
+
+struct DurationHistogram {
+    uint32_t buckets[METRIC_BUCKET_COUNT + 1];   // Per bucket, not cumulative; the last one is +Inf
+    uint32_t samples;
+    uint64_t sumUs;
+
+    void add(uint64_t us);
+};
+
+// Counters and histograms for a fleet collector: Prometheus text on
+// http://<device>:METRICS_PORT/metrics, the same samples as JSON on /metrics.json.
+// The record* hooks are cheap and heap-free. Subsystems that keep their own
+// stats (ContentSync, FetchScheduler, HeapTelemetry, RefreshTimer) are read
+// at scrape time.
+class Metrics {
+public:
+    static void begin();        // Starts the server; WiFi may come up later
+    static void poll();         // From loop(): answers a pending scrape, tracks WiFi reconnects
+
+    static void recordFrame(bool partial, uint32_t renderUs, uint32_t spiUs, uint32_t refreshUs);
+    static void recordHttp(int status, uint32_t latencyUs, int bytes);   // bytes = Content-Length, < 0 unknown
+    static void recordNfc(const NfcEvent& event);
+    static void setSource(const char* name);    // HTTP traffic is attributed to it until cleared (nullptr)
+
+private:
+    static void serve(bool json);
+};
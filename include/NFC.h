@@ -3,6 +3,45 @@
 
 #include <Wire.h>
 #include <Adafruit_PN532.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include "Type4Tag.h"
+
+enum NfcEventType : uint8_t {
+    NFC_EVENT_READY = 0,      // PN532 found and configured
+    NFC_EVENT_INIT_FAILED,    // No PN532; the task has exited
+    NFC_EVENT_TAG_ARRIVED,
+    NFC_EVENT_TAG_CURRENT,    // Tag already holds the URL
+    NFC_EVENT_TAG_WRITTEN,    // URL written and verified
+    NFC_EVENT_WRITE_FAILED,
+    NFC_EVENT_TAG_REMOVED,
+    NFC_EVENT_URL_SERVED,     // Emulated tag: a reader fetched the NDEF message
+    NFC_EVENT_BENCH_DONE      // requestBench() finished; see getBenchResult()
+};
+
+struct NfcEvent {
+    NfcEventType type;
+    uint8_t uid[7];
+    uint8_t uidLength;
+    uint32_t atMs;            // millis() when it happened
+    uint32_t tookMs;          // Tag arrival to this result
+};
+
+// Latency of one kind of page read, timed around the PN532 round trip
+struct NfcReadTiming {
+    uint8_t pages;            // Pages per read
+    uint16_t count;
+    uint16_t failures;
+    uint32_t avgUs;
+    uint32_t maxUs;
+};
+
+struct NfcBenchResult {
+    bool tagFound;            // false: no tag within NFC_BENCH_TAG_WAIT_MS, or emulating
+    uint32_t selectUs;        // InListPassiveTarget that found the tag
+    NfcReadTiming read;       // READ, 4 pages
+    NfcReadTiming fastRead;   // FAST_READ, FAST_READ_MAX_PAGES pages
+};
 
 class NFCManager {
 public:
@@ -12,18 +51,76 @@ public:
     bool verifyURL(const char* written_url);  // Verify if URL matches
     bool readTag(String& url);
     bool isTagPresent(uint32_t timeout = 1000);  // Timeout in milliseconds
+
+    // Background provisioning: the PN532 is driven from its own task and every
+    // tag presented gets the URL (or, with NFC_EMULATE_TAG, the PN532 itself
+    // answers readers as a tag); results arrive through pollEvent()
+    bool startTask(const char* url);
+    void setURL(const char* url);               // Emulation serves it to the next reader, no writes
+    bool pollEvent(NfcEvent& event);            // Non-blocking, false when nothing is queued
+    uint32_t getWriteCount() const { return _writeCount; }   // Tag writes, persisted across boots
+    uint32_t getBusyMs() const { return _busyMs; }           // Time spent on tags this boot
+
+    // Page read latency on whatever tag is in the field, measured on the NFC task;
+    // NFC_EVENT_BENCH_DONE follows. With the IRQ armed it runs when the next tag
+    // arrives. false if the task isn't running.
+    bool requestBench();
+    const NfcBenchResult& getBenchResult() const { return _bench; }
     
 private:
+    friend void checkNfcReads();   // checks/nfc.cpp drives the page reads on the simulated PN532
+
     static const int I2C_SDA = 21;
     static const int I2C_SCL = 22;
-    static const int PN532_IRQ = -1;
     static const int PN532_RESET = -1;
     
+    // NTAG21x commands sent through InDataExchange
+    static const uint8_t NTAG_CMD_READ = 0x30;         // 16 bytes (4 pages) per exchange
+    static const uint8_t NTAG_CMD_FAST_READ = 0x3A;    // A whole page range per exchange
+    static const uint8_t FAST_READ_MAX_PAGES = 12;     // 48 bytes fits the library's 64-byte frame buffer
+    static const uint8_t CC_PAGE = 3;                  // Capability container: NDEF data area size
+    static const uint16_t TAG_BUF_SIZE = 888;          // NTAG216 user memory, pages 4-225
+    static const uint16_t MAX_URL_LENGTH = 256;
+    
     Adafruit_PN532 nfc;
     bool initialized;
+    uint8_t _tagBuf[TAG_BUF_SIZE];
+    uint16_t _exchanges;    // PN532 round trips in the current operation
+    
+    // Owned by the NFC task once it is started
+    const char* volatile _url;
+    volatile bool _urlChanged;
+    volatile bool _benchRequested;
+    NfcBenchResult _bench;
+    Type4Tag _emulated;
+    QueueHandle_t _events;
+    uint8_t _uid[7];
+    uint8_t _uidLength;
+    bool _tagPresent;
+    
+    // Last tag verified to hold the URL (NVS "nfc"), so it is compared against the TLV
+    // instead of being parsed (and maybe rewritten) every boot
+    uint8_t _savedUid[7];
+    uint8_t _savedUidLength;
+    uint32_t _savedHash;      // FNV-1a of the encoded NDEF TLV
+    uint32_t _writeCount;
+    uint32_t _busyMs;
+    
+    static void taskEntry(void* arg);
+    void taskLoop();
+    void emulateLoop();
+    bool waitForTag(uint32_t intervalMs);
+    void post(NfcEventType type, uint32_t tookMs = 0);
+    void runBench();
+    void timeReads(NfcReadTiming& timing, bool fast);
+    void loadProvisioned();
+    void saveProvisioned(uint32_t hash, bool verified);
+    bool confirmProvisioned(const uint8_t* expected, uint16_t length);
     
     bool writePages(uint8_t startPage, const uint8_t *data, uint16_t length);
     bool readPages(uint8_t startPage, uint8_t numPages, uint8_t *outBuffer);
+    bool readBlock(uint8_t page, uint8_t *out16);
+    bool fastRead(uint8_t startPage, uint8_t numPages, uint8_t *outBuffer);
     void printHex(const uint8_t *data, uint32_t numBytes);
 };
 
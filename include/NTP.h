@@ -2,22 +2,40 @@
 #include <Arduino.h>
 #include <HardwareSerial.h>
 #include <time.h>
+#include "FixedString.h"
 
 class NTPClient {
 public:
     NTPClient();
-    void begin(const char* ntpServer = "pool.ntp.org", 
+    bool restoreClock();    // Before WiFi: true if the RTC kept the time across deep sleep/reboot
+    void begin(const char* ntpServer = "pool.ntp.org",
                long gmtOffset = 19800,    // Default GMT+5:30 for India
                int daylightOffset = 0);
-    bool update();
-    String getTimeString();
-    String getDateString();
-    String getDayString();
+    bool update();          // Never blocks; true once the clock is valid
+    // Reformats the cached strings if a minute boundary passed. Call at the start
+    // of a frame, never mid-frame, so every pass of a paged draw sees the same time.
+    void tick();
+    void formatAt(time_t epoch);   // Render an upcoming minute early (see RefreshTimer.h)
+    // Cached at the last tick(); no libc time calls
+    const char* getTimeString() const;
+    const char* getDateString() const;
+    const char* getDayString() const;
+    uint32_t getLocalTimeCalls() const;
     bool isTimeValid();
+    void printStats();
 
 private:
     bool timeReceived;
     const char* _ntpServer;
     long _gmtOffset;
     int _daylightOffset;
-};
\ No newline at end of file
+    FixedString<5> _timeStr;    // HH:MM
+    FixedString<10> _dateStr;   // DD-MM-YYYY
+    FixedString<9> _dayStr;     // Wednesday
+
+    static void onTimeSync(struct timeval* tv);
+    void formatMinute(time_t epoch, const struct timeval& now);
+    void markValid(const char* source, unsigned long atMs);
+    void applySyncInterval();
+    void saveDrift();
+};
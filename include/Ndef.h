@@ -0,0 +1,80 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// NDEF encoding/decoding for NFC Forum Type 2 tags (NTAG21x). Plain C++ with no
+// Arduino dependencies, so it builds and runs on the host too.
+
+// Record header flags
+const uint8_t NDEF_MB = 0x80;         // Message begin
+const uint8_t NDEF_ME = 0x40;         // Message end
+const uint8_t NDEF_CF = 0x20;         // Chunked (not supported)
+const uint8_t NDEF_SR = 0x10;         // Short record: 1-byte payload length
+const uint8_t NDEF_IL = 0x08;         // ID length present
+const uint8_t NDEF_TNF_MASK = 0x07;
+const uint8_t NDEF_TNF_WELL_KNOWN = 0x01;
+
+// TLV blocks in tag memory (from page 4)
+const uint8_t TLV_NULL = 0x00;
+const uint8_t TLV_LOCK_CONTROL = 0x01;
+const uint8_t TLV_MEMORY_CONTROL = 0x02;
+const uint8_t TLV_NDEF = 0x03;
+const uint8_t TLV_TERMINATOR = 0xFE;
+
+struct NdefRecord {
+    uint8_t tnf;
+    const uint8_t* type;
+    uint8_t typeLength;
+    const uint8_t* id;
+    uint8_t idLength;
+    const uint8_t* payload;
+    uint32_t payloadLength;
+};
+
+// Builds an NDEF message wrapped in its TLV and terminator, padded to whole
+// pages and ready to write from page 4
+class NdefWriter {
+public:
+    NdefWriter(uint8_t* buf, size_t capacity);
+    bool addRecord(uint8_t tnf, const uint8_t* type, uint8_t typeLength,
+                   const uint8_t* payload, uint32_t payloadLength);
+    bool addUri(const char* uri);                          // Prefix stored as a 1-byte identifier code
+    bool addText(const char* text, const char* lang = "en");
+    size_t finish();                                       // Total bytes to write, 0 if it didn't fit
+    bool overflowed() const { return _overflow; }
+
+private:
+    static const size_t TLV_HEADER_MAX = 4;   // 0x03 0xFF len_hi len_lo
+
+    uint8_t* _buf;
+    size_t _capacity;
+    size_t _len;
+    size_t _lastHeader;
+    bool _hasRecords;
+    bool _overflow;
+
+    bool beginRecord(uint8_t tnf, const uint8_t* type, uint8_t typeLength, uint32_t payloadLength);
+    bool put(const void* data, size_t len);
+};
+
+// Walks the records of an NDEF message
+class NdefReader {
+public:
+    NdefReader(const uint8_t* message, size_t length) : _msg(message), _len(length), _pos(0) {}
+    bool next(NdefRecord& record);   // false at the end or on a malformed/chunked record
+
+    // Bytes of tag memory (from page 4) that hold the NDEF TLV, 0 if its header isn't in mem
+    static size_t requiredBytes(const uint8_t* mem, size_t len);
+    static bool findMessage(const uint8_t* mem, size_t len, const uint8_t*& message, size_t& messageLength);
+
+private:
+    const uint8_t* _msg;
+    size_t _len;
+    size_t _pos;
+};
+
+// URI record -> full URI with its prefix expanded; false if not a URI record or out is too small
+bool ndefDecodeUri(const NdefRecord& record, char* out, size_t outSize);
+
+// NDEF data area size from the capability container (page 3), 0 if not NDEF-formatted
+size_t ndefTagDataSize(const uint8_t cc[4]);
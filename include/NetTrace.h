@@ -0,0 +1,142 @@
+#pragma once
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <SPIFFS.h>
+#include "Config.h"
+#include "FixedString.h"
+
+// Capture and replay of HTTP exchanges, selected by NET_TRACE in Config.h.
+//
+// Capture records every exchange made through TracedHTTPClient: URL, GET latency,
+// status, size, the collected response headers, then the body as the firmware read
+// it, in chunks stamped with their arrival time. Time spent writing the trace is
+// left out of the stamps. The sink is NET_TRACE_PATH on SPIFFS or hex lines on
+// Serial ("NT:..." - tools/net_trace.py turns a serial log back into a file).
+//
+// Replay answers every request from the trace at NET_TRACE_PATH instead of the
+// network, with the recorded latency and chunk arrival times, so a field trace can
+// be re-run on the device or in the host simulator. Exchanges are matched by URL,
+// in recorded order; a URL that runs out starts over from its first exchange.
+//
+// Trace format (little-endian): "NTR1", then per exchange
+//   'X' u16 urlLen url  u32 startMs  u32 latencyUs  i16 status  i32 size
+//       u8 headerCount { u8 nameLen name  u16 valueLen value }
+//   'C' u32 atUs  u16 len  data        // Arrival time after GET returned; repeated
+//   'E'
+
+class NetTrace {
+public:
+    static void begin();        // After SPIFFS.begin(): opens the capture or indexes the replay
+    static bool capturing() { return NET_TRACE == NET_TRACE_CAPTURE_SPIFFS || NET_TRACE == NET_TRACE_CAPTURE_SERIAL; }
+    static bool replaying() { return NET_TRACE == NET_TRACE_REPLAY; }
+    static void dump(Print& out);   // The SPIFFS trace as "NT:" hex lines between markers
+
+private:
+    friend class TracedHTTPClient;
+    friend class CaptureStream;
+
+    // Capture
+    static bool beginExchange(const char* url, uint32_t latencyUs, int status, int size,
+                              const char* const* headerNames, const String* headerValues, size_t headerCount);
+    static void record(const uint8_t* data, size_t len);
+    static void endExchange();
+    static void flushChunk();
+    static void put(const void* data, size_t len);   // To the sink
+    static void put8(uint8_t v) { put(&v, 1); }
+    static void put16(uint16_t v) { put(&v, 2); }
+    static void put32(uint32_t v) { put(&v, 4); }
+
+    // Replay
+    static int findExchange(const char* url);    // Trace offset of the next exchange for url, -1 if none
+};
+
+// Body of a replayed exchange; chunks become readable at their recorded time
+class ReplayStream : public Stream {
+public:
+    bool open(uint32_t offset);         // Reads the exchange header at offset
+    void close();
+    bool more();                        // Body bytes left (the replay's "connected")
+
+    int status() const { return _status; }
+    int size() const { return _size; }
+    uint32_t latencyUs() const { return _latencyUs; }
+    String header(const char* name) const;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    using Stream::readBytes;
+    size_t readBytes(char* buffer, size_t length) override;
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    static const int MAX_HEADERS = 4;
+
+    File _file;
+    int _status = 0;
+    int _size = -1;
+    uint32_t _latencyUs = 0;
+    uint32_t _startUs = 0;          // micros() when GET returned
+    uint32_t _dueUs = 0;            // Arrival time of the current chunk, relative to _startUs
+    uint16_t _left = 0;             // Bytes left in the current chunk
+    bool _ended = true;
+    uint8_t _headerCount = 0;
+    FixedString<24> _headerNames[MAX_HEADERS];
+    FixedString<96> _headerValues[MAX_HEADERS];
+
+    friend class TracedHTTPClient;
+    bool nextChunk();
+    bool waitChunk();               // Blocks until the current chunk has "arrived"; false at the end
+};
+
+// Tees whatever the firmware reads off the socket into the capture
+class CaptureStream : public Stream {
+public:
+    void attach(Stream* source) { _source = source; }
+
+    int available() override { return _source->available(); }
+    int read() override;
+    int peek() override { return _source->peek(); }
+    using Stream::readBytes;
+    size_t readBytes(char* buffer, size_t length) override;
+    size_t write(uint8_t b) override { return _source->write(b); }
+
+private:
+    Stream* _source = nullptr;
+};
+
+// The subset of HTTPClient the firmware uses, routed through NetTrace. With
+// NET_TRACE off it is a plain HTTPClient and getStream() is the socket itself.
+class TracedHTTPClient {
+public:
+    ~TracedHTTPClient() { end(); }
+
+    void setTimeout(uint16_t timeoutMs) { _http.setTimeout(timeoutMs); }
+    void useHTTP10(bool useHttp10) { _http.useHTTP10(useHttp10); }
+    bool begin(const String& url);
+    bool begin(const char* url) { return begin(String(url)); }
+    void addHeader(const String& name, const String& value) { _http.addHeader(name, value); }
+    void collectHeaders(const char* headerKeys[], size_t count);
+
+    int GET();
+    int getSize();
+    String header(const char* name);
+    bool connected();
+    Stream& getStream();
+    Stream* getStreamPtr() { return &getStream(); }
+    String getString();
+    void end();
+
+private:
+    static const size_t MAX_COLLECTED = 4;
+
+    HTTPClient _http;
+    String _url;
+    const char* _headerKeys[MAX_COLLECTED];
+    size_t _headerCount = 0;
+    bool _open = false;             // Between a successful begin() and end()
+    bool _capturing = false;        // This exchange is being recorded
+    bool _replaying = false;        // This exchange comes from the trace
+    CaptureStream _capture;
+    ReplayStream _replay;
+};
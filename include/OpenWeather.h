@@ -2,6 +2,7 @@
 #include <Arduino.h>
 #include <HardwareSerial.h>
 #include "Location.h"
+#include "FixedString.h"
 
 // TODO: Move this to a secure configuration file or environment variable
 #define OPENWEATHER_API_KEY "b17b25fe1a3d45d35c650828fce5ca2d"
@@ -10,13 +11,12 @@ class OpenWeather {
 public:
     OpenWeather();
     bool updateWeather(const LocationData& location);
-    String getWeatherIcon();
+    const char* getWeatherIcon() const;
     float getTemperature();
+    bool parseWeatherData(Stream& response);       // OpenWeather body; public so bench/ can feed it fixtures
     
 private:
     // API key is defined as OPENWEATHER_API_KEY
-    String _weatherIcon;
+    FixedString<7> _weatherIcon;
     float _temperature;
-    
-    bool parseWeatherData(String& response);
 };
\ No newline at end of file
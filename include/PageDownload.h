@@ -0,0 +1,7 @@
+#pragma once
+#include <Arduino.h>
+
+// Streams url into path on SPIFFS through the refresh arena. The old file is
+// removed first; false on any HTTP or file error, or a body shorter than the
+// advertised Content-Length (the partial file is left for the caller's checks).
+bool downloadToFile(const char* url, const char* path);
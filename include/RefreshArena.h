@@ -0,0 +1,80 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Scratch sizes of the per-refresh buffers
+const size_t ARENA_BMP_ROW_BYTES      = 100;    // One 800 px row at 1 bpp
+const size_t ARENA_DOWNLOAD_CHUNK     = 1024;   // HTTP body -> SPIFFS copy buffer
+const size_t ARENA_DASHBOARD_ROW      = 800;    // One 8 bpp row of the streamed dashboard
+const size_t ARENA_MANIFEST_JSON      = 2048;
+// JSON pools in slots (16 bytes on the ESP32, 32 on a 64-bit host) plus string bytes
+const size_t ARENA_LOCATION_JSON      = JSON_OBJECT_SIZE(5) + JSON_OBJECT_SIZE(3) + 256;    // 384 on the ESP32
+const size_t ARENA_WEATHER_JSON       = JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(1) +         // 192, up to 3 conditions
+                                        JSON_ARRAY_SIZE(3) + 3 * JSON_OBJECT_SIZE(1) + 48;
+const size_t ARENA_BENCH_BAND         = 800;    // 8 rows of one colour plane at 1 bpp (`bench display`)
+
+// Bump allocator for short-lived per-refresh buffers (BMP rows, download chunks,
+// JSON pools). Everything comes from one static block and is released in LIFO
+// order by ArenaScope, so the refresh path never touches the general heap and
+// peak use is fixed at build time.
+class RefreshArena {
+public:
+    static const size_t CAPACITY = 2048;   // Views don't nest, so the largest budget sets this
+
+    static void* alloc(size_t size);   // 8-byte aligned; nullptr when exhausted (no heap fallback)
+    static size_t used();
+    static size_t peak();              // Highest use since boot
+
+private:
+    friend class ArenaScope;
+    alignas(8) static uint8_t _block[CAPACITY];
+    static size_t _top;
+    static size_t _peak;
+    static size_t _scopePeak;
+};
+
+// Arena blocks are handed out in 8-byte steps
+constexpr size_t arenaSize(size_t bytes) { return (bytes + 7) & ~(size_t)7; }
+
+// Worst-case arena use of each view. Checked against the arena at compile time
+// and against what the view really used when its scope closes.
+namespace ArenaBudget {
+    const size_t PAGE_DRAW     = arenaSize(ARENA_BMP_ROW_BYTES);
+    const size_t PAGE_DOWNLOAD = arenaSize(ARENA_DOWNLOAD_CHUNK);
+    const size_t DASHBOARD     = arenaSize(ARENA_DASHBOARD_ROW);
+    const size_t MANIFEST      = arenaSize(ARENA_MANIFEST_JSON);
+    const size_t LOCATION      = arenaSize(ARENA_LOCATION_JSON);
+    const size_t WEATHER       = arenaSize(ARENA_WEATHER_JSON);
+    const size_t SELF_BENCH    = 2 * arenaSize(ARENA_BENCH_BAND);
+}
+
+static_assert(ArenaBudget::PAGE_DRAW <= RefreshArena::CAPACITY, "page draw exceeds refresh arena");
+static_assert(ArenaBudget::PAGE_DOWNLOAD <= RefreshArena::CAPACITY, "page download exceeds refresh arena");
+static_assert(ArenaBudget::DASHBOARD <= RefreshArena::CAPACITY, "dashboard exceeds refresh arena");
+static_assert(ArenaBudget::MANIFEST <= RefreshArena::CAPACITY, "manifest exceeds refresh arena");
+static_assert(ArenaBudget::LOCATION <= RefreshArena::CAPACITY, "location exceeds refresh arena");
+static_assert(ArenaBudget::WEATHER <= RefreshArena::CAPACITY, "weather exceeds refresh arena");
+static_assert(ArenaBudget::SELF_BENCH <= RefreshArena::CAPACITY, "display bench exceeds refresh arena");
+
+// Everything allocated from the arena after this is released when it goes out of scope
+class ArenaScope {
+public:
+    ArenaScope(const char* view, size_t budget);
+    ~ArenaScope();
+
+    size_t used() const;   // Peak arena use since the scope opened, nested scopes included
+
+private:
+    const char* _view;
+    size_t _budget;
+    size_t _mark;
+    size_t _outerPeak;
+};
+
+// ArduinoJson pool served from the arena; freed with the enclosing ArenaScope
+struct ArenaJsonAllocator {
+    void* allocate(size_t size) { return RefreshArena::alloc(size); }
+    void deallocate(void*) {}
+    void* reallocate(void*, size_t) { return nullptr; }
+};
+typedef BasicJsonDocument<ArenaJsonAllocator> ArenaJsonDocument;
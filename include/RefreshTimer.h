@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+#include <time.h>
+
+enum RefreshType : uint8_t {
+    REFRESH_TIME = 0,   // Status bar time update
+    REFRESH_FULL,       // Hourly clean + dashboard redraw
+    REFRESH_TYPE_COUNT
+};
+
+// Landing error buckets, in ms relative to the minute boundary (negative = early)
+const int REFRESH_ERROR_BUCKETS = 8;
+const int32_t REFRESH_ERROR_EDGES[REFRESH_ERROR_BUCKETS - 1] = {-5000, -2000, -1000, 0, 1000, 2000, 5000};
+
+struct RefreshTiming {
+    float latencyMs;                            // Moving average, start of render -> panel done
+    uint32_t samples;
+    int32_t worstErrorMs;                       // Largest |landing - boundary| seen
+    int64_t errorSumMs;
+    uint32_t errorHistogram[REFRESH_ERROR_BUCKETS];
+};
+
+// Starts each minute refresh early by the measured end-to-end latency of its
+// refresh type, so the new minute lands on the glass within
+// REFRESH_TARGET_TOLERANCE_MS after the boundary instead of up to a minute late.
+class RefreshTimer {
+public:
+    static bool due(RefreshType type);          // Time to start rendering the upcoming minute
+    static void start(RefreshType type);        // Formats the target minute; call right before rendering
+    static void finish(RefreshType type, bool executed);   // executed = panel actually refreshed
+    static const RefreshTiming& getTiming(RefreshType type);
+    static const char* typeName(RefreshType type);
+    static void printStats();
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <Arduino.h>
+#include "NFC.h"
+
+// On-device measurements run from serial commands, so a unit in the field can
+// be characterised without reflashing:
+//
+//   bench display      SPI push of a full frame, full and partial refresh (BUSY) time
+//   bench spiffs       Write, read back and remove SELF_BENCH_SPIFFS_BYTES
+//   bench http [url]   Download throughput, SELF_BENCH_HTTP_URL by default
+//   bench nfc          Select and page read latency of the tag in the field
+//   bench all          Every test above, display last
+//   trace dump         NetTrace::dump() of the captured HTTP trace
+//
+// Each result is one line, "BENCH " followed by a JSON object with at least
+// "test" and "ok". Tests block loop() while they run.
+class SelfBench {
+public:
+    // The NFC manager whose task runs `bench nfc`, and where other NFC events
+    // that arrive while it waits are handed on
+    static void begin(NFCManager& nfc, void (*onNfcEvent)(const NfcEvent&));
+    static bool poll();     // From loop(): runs a complete command line; true if the panel was drawn over
+    static bool run(const char* line);   // One command line, as poll() would
+
+private:
+    static void unitInfo();
+    static bool benchDisplay();
+    static void benchSpiffs();
+    static void benchHttp(const char* url);
+    static void benchNfc();
+};
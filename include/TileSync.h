@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Arduino.h>
+#include "ContentSync.h"
+
+// Tile-hash delta sync for cached 1-bit page BMPs.
+//
+// The page is split into a fixed grid of TILE_W x TILE_H tiles (80x30 divides both
+// 800x420 and 800x480 exactly). The manifest's "tiles" endpoint serves:
+//   GET <tiles>              -> one uint32 (little endian) hash per tile, row-major
+//   GET <tiles>?ids=3,17,... -> the requested tiles back to back, each TILE_H rows of
+//                               TILE_W/8 bytes, top row first, same bit order as the BMP
+// The last hash list the device applied is kept next to the BMP as "<path>.tiles".
+class TileSync {
+public:
+    static const int TILE_W = 80;
+    static const int TILE_H = 30;
+    static const int MAX_TILES = (800 / TILE_W) * (480 / TILE_H);
+    static const int MAX_DELTA_TILES = MAX_TILES / 2;   // Beyond this a full download is cheaper
+
+    // Patch the cached BMP at path with the tiles whose server hash changed.
+    // Returns SYNC_FAILED when a full download is needed instead.
+    static SyncResult syncTiles(const char* path, const String& tilesUrl, DirtyRect& dirty, SyncStats& stats);
+
+    // Record the server tile hashes for a freshly downloaded BMP
+    static bool storeTileHashes(const char* path, const String& tilesUrl, SyncStats& stats);
+
+private:
+    static int fetchTileHashes(const String& tilesUrl, uint32_t* hashes, int maxTiles, SyncStats& stats);
+    static int loadTileHashes(const char* path, uint32_t* hashes, int maxTiles);
+    static bool saveTileHashes(const char* path, const uint32_t* hashes, int count);
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// NFC Forum Type 4 tag served from RAM: answers the reader's ISO 7816-4 APDUs
+// (NDEF application, CC file, NDEF file) so the PN532 in target mode looks like
+// a read-only tag holding one URI. Plain C++ with no Arduino dependencies.
+class Type4Tag {
+public:
+    static const uint16_t MAX_NDEF_SIZE = 256;
+    static const uint8_t MAX_READ = 59;       // MLe: response data + SW must fit the PN532 frame buffer
+
+    Type4Tag();
+    bool setUri(const char* uri);             // Takes effect from the next READ BINARY
+    void reset();                             // New reader session: nothing selected
+    bool served() const { return _served; }   // The reader has read NDEF message bytes this session
+
+    // One command APDU in, response APDU (data + SW1 SW2) out; returns the response length
+    size_t process(const uint8_t* apdu, size_t length, uint8_t* response, size_t responseSize);
+
+private:
+    enum Selected : uint8_t { SEL_NONE, SEL_APP, SEL_CC, SEL_NDEF };
+
+    Selected _selected;
+    uint8_t _cc[15];
+    uint8_t _ndef[2 + MAX_NDEF_SIZE];         // NLEN + NDEF message
+    uint16_t _ndefLength;
+    bool _served;
+
+    size_t select(const uint8_t* apdu, size_t length, uint8_t* response);
+    size_t readBinary(const uint8_t* apdu, size_t length, uint8_t* response, size_t responseSize);
+};
@@ -4,13 +4,15 @@
 #include <HTTPClient.h>
 #include <SPIFFS.h>
 #include "DisplayManager.h"
+#include "Config.h"
 
 class CalendarManager {
 public:
-    static void downloadCalendarBMP();
+    static bool downloadCalendarBMP(const char* url = nullptr);  // nullptr = default URL
     static void displayCalendar();
+    static void displayCalendarRegion(int16_t x, int16_t y, int16_t w, int16_t h);  // image coordinates
     
 private:
     static const char* CALENDAR_BMP_URL;
-    static void drawBMPFromFile(const char* filename);
+    static bool drawBMPFromFile(const char* filename, int16_t rowFrom = 0, int16_t rowTo = -1);  // false = bailed out
 };
@@ -0,0 +1,58 @@
+#pragma once
+// Adafruit GFX drawing and text layout, with the library's own metrics rules so
+// getTextBounds() and cursor movement match the device
+#include "Arduino.h"
+#include "gfxfont.h"
+
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(int16_t w, int16_t h);
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+    virtual void fillScreen(uint16_t color);
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
+    void fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
+    void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color);
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg);
+
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+    size_t write(uint8_t c) override;
+    using Print::write;
+    void setFont(const GFXfont* font = nullptr);
+    void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+    void setTextColor(uint16_t c) { _textColor = _textBg = c; }
+    void setTextColor(uint16_t c, uint16_t bg) { _textColor = c; _textBg = bg; }
+    void setTextSize(uint8_t s) { _textSize = s > 0 ? s : 1; }
+    void setTextWrap(bool wrap) { _wrap = wrap; }
+    int16_t getCursorX() const { return _cursorX; }
+    int16_t getCursorY() const { return _cursorY; }
+    void getTextBounds(const char* s, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h);
+    void getTextBounds(const String& s, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+        getTextBounds(s.c_str(), x, y, x1, y1, w, h);
+    }
+
+    virtual void setRotation(uint8_t r);
+    uint8_t getRotation() const { return _rotation; }
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+protected:
+    const int16_t WIDTH, HEIGHT;
+    int16_t _width, _height;
+    int16_t _cursorX = 0, _cursorY = 0;
+    uint16_t _textColor = 0xFFFF, _textBg = 0xFFFF;
+    uint8_t _textSize = 1;
+    uint8_t _rotation = 0;
+    bool _wrap = true;
+    const GFXfont* _font = nullptr;
+
+    void charBounds(unsigned char c, int16_t* x, int16_t* y, int16_t* minx, int16_t* miny, int16_t* maxx, int16_t* maxy);
+};
@@ -0,0 +1,158 @@
+#include "Adafruit_PN532.h"
+#include "HostSim.h"
+#include <stdio.h>
+#include <unistd.h>
+
+static const char* tagPath() {
+    return getenv("SIM_NFC_TAG");
+}
+
+bool Adafruit_PN532::loadTag() {
+    const char* path = tagPath();
+    FILE* f = path ? fopen(path, "rb") : nullptr;
+    if (!f) return false;
+    size_t n = fread(_tag, 1, sizeof(_tag), f);
+    fclose(f);
+    return n == sizeof(_tag);
+}
+
+bool Adafruit_PN532::saveTag() {
+    const char* path = tagPath();
+    FILE* f = path ? fopen(path, "wb") : nullptr;
+    if (!f) return false;
+    size_t n = fwrite(_tag, 1, sizeof(_tag), f);
+    fclose(f);
+    return n == sizeof(_tag);
+}
+
+bool Adafruit_PN532::begin() {
+    const char* path = tagPath();
+    if (path && access(path, F_OK) != 0) {
+        // Blank NTAG215: 7-byte UID over pages 0-1, capability container on page 3
+        static const uint8_t header[16] = {0x04, 0x53, 0x49, 0xCE, 0x4D, 0x2D, 0x32, 0x01,
+                                           0x4C, 0x48, 0x00, 0x00, 0xE1, 0x10, 0x3E, 0x00};
+        memset(_tag, 0, sizeof(_tag));
+        memcpy(_tag, header, sizeof(header));
+        _tag[16] = 0x03;   // Empty NDEF TLV
+        _tag[18] = 0xFE;
+        saveTag();
+        Serial.printf("🏷️ [sim] blank NTAG215 written to %s\n", path);
+    }
+    return true;
+}
+
+uint32_t Adafruit_PN532::getFirmwareVersion() {
+    return atoi(HostSim::env("SIM_NFC", "1")) ? 0x32010607 : 0;   // PN532 v1.6
+}
+
+bool Adafruit_PN532::readPassiveTargetID(uint8_t cardBaudRate, uint8_t* uid, uint8_t* uidLength, uint16_t timeoutMs) {
+    (void)cardBaudRate;
+    if (!loadTag()) {
+        delay(timeoutMs ? timeoutMs : 100);
+        return false;
+    }
+    delay(5);   // Typical InListPassiveTarget round trip
+    memcpy(uid, _tag, 3);
+    memcpy(uid + 3, _tag + 4, 4);
+    *uidLength = 7;
+    return true;
+}
+
+bool Adafruit_PN532::startPassiveTargetIDDetection(uint8_t cardBaudRate) {
+    (void)cardBaudRate;
+    return true;   // No IRQ line on the host: readDetectedPassiveTargetID answers at once
+}
+
+bool Adafruit_PN532::readDetectedPassiveTargetID(uint8_t* uid, uint8_t* uidLength) {
+    return readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, uidLength, 100);
+}
+
+bool Adafruit_PN532::inDataExchange(uint8_t* send, uint8_t sendLength, uint8_t* response, uint8_t* responseLength) {
+    if (sendLength < 2 || !loadTag()) return false;
+    _exchanges++;
+    delay(3);
+    uint8_t first = send[1];
+    uint8_t last = first + 3;
+    if (send[0] == 0x3A && !atoi(HostSim::env("SIM_NFC_FAST_READ", "1"))) return false;   // NAK
+    if (send[0] == 0x3A && sendLength >= 3) last = send[2];   // FAST_READ
+    else if (send[0] != 0x30) return false;                   // Only READ and FAST_READ
+    if (first >= TAG_PAGES || last >= TAG_PAGES || last < first) {
+        if (send[0] == 0x3A) return false;
+        last = std::min<int>(last, TAG_PAGES - 1);
+    }
+    size_t length = (last - first + 1) * 4;
+    if (length > *responseLength) return false;
+    memcpy(response, _tag + first * 4, length);
+    if (send[0] == 0x30 && length < 16) {
+        memcpy(response + length, _tag, 16 - length);        // READ wraps to page 0
+        length = 16;
+    }
+    *responseLength = length;
+    return true;
+}
+
+uint8_t Adafruit_PN532::ntag2xx_ReadPage(uint8_t page, uint8_t* buffer) {
+    uint8_t cmd[2] = {0x30, page};
+    uint8_t length = 16;
+    return inDataExchange(cmd, sizeof(cmd), buffer, &length);
+}
+
+uint8_t Adafruit_PN532::ntag2xx_WritePage(uint8_t page, uint8_t* data) {
+    if (page < 4 || page >= TAG_PAGES - 5 || !loadTag()) return 0;   // UID/lock pages and config area
+    delay(5);
+    memcpy(_tag + page * 4, data, 4);
+    return saveTag();
+}
+
+// ---- Card emulation: a scripted phone reading the NDEF file ----
+
+uint8_t Adafruit_PN532::AsTarget() {
+    if (!atoi(HostSim::env("SIM_NFC_READER", "0")) || millis() - _lastReaderMs < 5000) {
+        delay(100);
+        return 0;
+    }
+    _lastReaderMs = millis();
+    _readerStep = 0;
+    _ndefLength = _ndefRead = 0;
+    return 1;
+}
+
+uint8_t Adafruit_PN532::getDataTarget(uint8_t* cmd, uint8_t* cmdLength) {
+    static const uint8_t selectApp[] = {0x00, 0xA4, 0x04, 0x00, 0x07, 0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01, 0x00};
+    static const uint8_t selectCc[] = {0x00, 0xA4, 0x00, 0x0C, 0x02, 0xE1, 0x03};
+    static const uint8_t readCc[] = {0x00, 0xB0, 0x00, 0x00, 0x0F};
+    static const uint8_t selectNdef[] = {0x00, 0xA4, 0x00, 0x0C, 0x02, 0xE1, 0x04};
+    static const uint8_t readLength[] = {0x00, 0xB0, 0x00, 0x00, 0x02};
+    static const uint8_t* const script[] = {selectApp, selectCc, readCc, selectNdef, readLength};
+    static const uint8_t scriptLength[] = {sizeof(selectApp), sizeof(selectCc), sizeof(readCc),
+                                           sizeof(selectNdef), sizeof(readLength)};
+
+    if (_readerStep < 5) {
+        memcpy(cmd, script[_readerStep], scriptLength[_readerStep]);
+        *cmdLength = scriptLength[_readerStep];
+        return 1;
+    }
+    if (_readerStep == 0xFF || _ndefRead >= _ndefLength) {
+        if (_readerStep != 0xFF) Serial.printf("📱 [sim] reader got a %u-byte NDEF message\n", _ndefLength);
+        return 0;   // Phone leaves the field
+    }
+    uint16_t offset = 2 + _ndefRead;
+    uint8_t chunk = std::min<uint16_t>(59, _ndefLength - _ndefRead);
+    uint8_t read[] = {0x00, 0xB0, (uint8_t)(offset >> 8), (uint8_t)offset, chunk};
+    memcpy(cmd, read, sizeof(read));
+    *cmdLength = sizeof(read);
+    return 1;
+}
+
+uint8_t Adafruit_PN532::setDataTarget(uint8_t* cmd, uint8_t cmdLength) {
+    delay(2);
+    if (cmdLength < 2 || cmd[cmdLength - 2] != 0x90 || cmd[cmdLength - 1] != 0x00) {
+        Serial.printf("📱 [sim] reader got status %02X%02X, giving up\n", cmd[cmdLength - 2], cmd[cmdLength - 1]);
+        _readerStep = 0xFF;
+        return 1;
+    }
+    if (_readerStep == 4) _ndefLength = (cmd[0] << 8) | cmd[1];
+    else if (_readerStep > 4) _ndefRead += cmdLength - 2;
+    if (_readerStep < 5) _readerStep++;
+    return 1;
+}
@@ -0,0 +1,47 @@
+#pragma once
+// Scripted PN532. The tag in the field is the NTAG215 image at SIM_NFC_TAG (created
+// blank on begin() if missing): present while the file exists, so deleting or copying
+// the file removes or presents a tag. Writes go straight back to the file.
+// SIM_NFC_READER=1 has a phone read the emulated Type 4 tag every few seconds.
+#include "Arduino.h"
+#include "Wire.h"
+
+#define PN532_MIFARE_ISO14443A 0x00
+#define PN532_COMMAND_INDATAEXCHANGE 0x40
+#define PN532_COMMAND_TGINITASTARGET 0x8C
+#define PN532_COMMAND_TGGETDATA 0x86
+#define PN532_COMMAND_TGSETDATA 0x8E
+
+class Adafruit_PN532 {
+public:
+    Adafruit_PN532(uint8_t irq, uint8_t reset, TwoWire* wire = &Wire) { (void)irq; (void)reset; (void)wire; }
+
+    bool begin();
+    uint32_t getFirmwareVersion();
+    bool SAMConfig() { return true; }
+
+    bool readPassiveTargetID(uint8_t cardBaudRate, uint8_t* uid, uint8_t* uidLength, uint16_t timeoutMs = 0);
+    bool startPassiveTargetIDDetection(uint8_t cardBaudRate);
+    bool readDetectedPassiveTargetID(uint8_t* uid, uint8_t* uidLength);
+    bool inDataExchange(uint8_t* send, uint8_t sendLength, uint8_t* response, uint8_t* responseLength);
+    uint8_t ntag2xx_ReadPage(uint8_t page, uint8_t* buffer);
+    uint8_t ntag2xx_WritePage(uint8_t page, uint8_t* data);
+
+    uint8_t AsTarget();
+    uint8_t getDataTarget(uint8_t* cmd, uint8_t* cmdLength);
+    uint8_t setDataTarget(uint8_t* cmd, uint8_t cmdLength);
+
+    uint32_t simExchanges() const { return _exchanges; }   // InDataExchange frames sent to the tag
+
+private:
+    static const size_t TAG_PAGES = 135;   // NTAG215
+
+    uint8_t _tag[TAG_PAGES * 4];
+    unsigned long _lastReaderMs = 0;
+    uint8_t _readerStep = 0;
+    uint16_t _ndefLength = 0, _ndefRead = 0;
+    uint32_t _exchanges = 0;
+
+    bool loadTag();
+    bool saveTag();
+};
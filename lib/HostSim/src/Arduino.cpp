@@ -0,0 +1,191 @@
+#include "Arduino.h"
+#include "HostSim.h"
+#include "SPI.h"
+#include "Wire.h"
+#include <malloc.h>
+#include <poll.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+TwoWire Wire;
+SPIClass SPI;
+
+static const auto bootTime = std::chrono::steady_clock::now();
+static std::mutex serialMutex;
+static std::atomic<bool> serialMuted{false};
+
+// ---- Time ----
+
+uint64_t hostSimMicros() {
+    auto elapsed = std::chrono::steady_clock::now() - bootTime;
+    double us = std::chrono::duration<double, std::micro>(elapsed).count();
+    return (uint64_t)(us * HostSim::timeScale());
+}
+
+void hostSimSleepMicros(uint64_t us) {
+    double hostUs = us / HostSim::timeScale();
+    if (hostUs >= 1.0) std::this_thread::sleep_for(std::chrono::duration<double, std::micro>(hostUs));
+    else std::this_thread::yield();
+}
+
+unsigned long millis() { return (unsigned long)(hostSimMicros() / 1000); }
+unsigned long micros() { return (unsigned long)hostSimMicros(); }
+void delay(unsigned long ms) { hostSimSleepMicros((uint64_t)ms * 1000); }
+void delayMicroseconds(unsigned int us) { hostSimSleepMicros(us); }
+void yield() { std::this_thread::yield(); }
+
+// ---- Serial ----
+
+void HostSim::muteSerial(bool muted) {
+    serialMuted = muted;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (serialMuted) return size;
+    std::lock_guard<std::mutex> lock(serialMutex);
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+    std::lock_guard<std::mutex> lock(serialMutex);
+    fflush(stdout);
+}
+
+// Reads ahead one byte so that a closed stdin (EOF reads as POLLIN forever)
+// stops reporting input instead of spinning every reader
+int HardwareSerial::available() {
+    return peek() >= 0 ? 1 : 0;
+}
+
+int HardwareSerial::read() {
+    int c = peek();
+    _peeked = -1;
+    return c;
+}
+
+int HardwareSerial::peek() {
+    if (_peeked >= 0 || _stdinClosed) return _peeked;
+    struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+    if (poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLIN | POLLHUP))) {
+        uint8_t c;
+        if (::read(STDIN_FILENO, &c, 1) == 1) _peeked = c;
+        else _stdinClosed = true;
+    }
+    return _peeked;
+}
+
+// ---- GPIO ----
+
+static const int PIN_COUNT = 40;
+static std::atomic<uint8_t> pinLevel[PIN_COUNT];
+static void (*pinHandler[PIN_COUNT])();
+static int pinMode_[PIN_COUNT];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= PIN_COUNT) return;
+    pinMode_[pin] = mode;
+    if (mode == INPUT_PULLUP) pinLevel[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < PIN_COUNT) pinLevel[pin] = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < PIN_COUNT ? pinLevel[pin].load() : LOW;
+}
+
+int analogRead(uint8_t pin) {
+    (void)pin;
+    return 0;
+}
+
+int digitalPinToInterrupt(int pin) { return pin; }
+
+void attachInterrupt(int interrupt, void (*handler)(), int mode) {
+    if (interrupt < 0 || interrupt >= PIN_COUNT) return;
+    pinHandler[interrupt] = handler;
+    pinMode_[interrupt] = mode;
+}
+
+void detachInterrupt(int interrupt) {
+    if (interrupt >= 0 && interrupt < PIN_COUNT) pinHandler[interrupt] = nullptr;
+}
+
+void hostSimSetPin(uint8_t pin, uint8_t value) {
+    if (pin >= PIN_COUNT) return;
+    uint8_t old = pinLevel[pin].exchange(value ? HIGH : LOW);
+    if (!pinHandler[pin] || old == pinLevel[pin]) return;
+    int mode = pinMode_[pin];
+    if (mode == CHANGE || (mode == FALLING && !value) || (mode == RISING && value)) pinHandler[pin]();
+}
+
+// ---- Random ----
+
+static std::mt19937 rng(12345);
+static std::mutex rngMutex;
+
+long random(long max) { return max > 0 ? random(0, max) : 0; }
+
+long random(long min, long max) {
+    if (max <= min) return min;
+    std::lock_guard<std::mutex> lock(rngMutex);
+    return min + (long)(rng() % (unsigned long)(max - min));
+}
+
+void randomSeed(unsigned long seed) {
+    std::lock_guard<std::mutex> lock(rngMutex);
+    rng.seed(seed);
+}
+
+uint32_t esp_random() {
+    std::lock_guard<std::mutex> lock(rngMutex);
+    return rng();
+}
+
+// ---- ESP ----
+
+static std::atomic<uint32_t> minFreeHeap{UINT32_MAX};
+
+uint32_t EspClass::getHeapSize() {
+    return HostSim::heapKb() * 1024;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    struct mallinfo2 info = mallinfo2();
+    uint32_t size = getHeapSize();
+    uint32_t used = info.uordblks > size ? size : (uint32_t)info.uordblks;
+    uint32_t free = size - used;
+    uint32_t seen = minFreeHeap;
+    while (free < seen && !minFreeHeap.compare_exchange_weak(seen, free)) {}
+    return free;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    getFreeHeap();
+    return minFreeHeap;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    return getFreeHeap();   // glibc does not fragment the way the ESP-IDF heap does
+}
+
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(hostSimMicros() * getCpuFreqMHz());
+}
+
+void EspClass::restart() {
+    Serial.println("🔄 [sim] ESP.restart() - re-executing");
+    fflush(stdout);
+    HostSim::restart();
+}
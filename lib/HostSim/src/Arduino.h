@@ -0,0 +1,108 @@
+#pragma once
+// Host build of the Arduino-ESP32 core for the native simulator (pio run -e native).
+// Only the surface the firmware uses; see lib/HostSim/README.md for the knobs.
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <cmath>
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+
+#define HOST_SIM 1
+
+#define PROGMEM
+#define PGM_P const char*
+#define F(s) (s)
+#define FPSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::isnan;
+using std::max;
+using std::min;
+
+template <typename T, typename L, typename H>
+inline T constrain(T value, L low, H high) { return value < low ? low : (value > high ? high : value); }
+
+// Serial is stdout; stdin is polled without blocking so typed commands reach available()/read()
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    operator bool() const { return true; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    void flush() override;
+    int available() override;
+    int read() override;
+    int peek() override;
+
+private:
+    int _peeked = -1;
+    bool _stdinClosed = false;
+};
+extern HardwareSerial Serial;
+
+// Time runs SIM_TIME_SCALE times faster than the host clock: delays shrink, millis() grows
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(int interrupt, void (*handler)(), int mode);
+void detachInterrupt(int interrupt);
+void hostSimSetPin(uint8_t pin, uint8_t value);   // Drives an input (and fires its interrupt)
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+bool getLocalTime(struct tm* info, uint32_t timeoutMs = 5000);
+
+// Heap figures come from the host allocator against a nominal ESP32 heap (SIM_HEAP_KB)
+class EspClass {
+public:
+    uint32_t getHeapSize();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getCycleCount();
+    const char* getSdkVersion() { return "host-sim"; }
+    [[noreturn]] void restart();
+};
+extern EspClass ESP;
+
+void setup();
+void loop();
@@ -0,0 +1,203 @@
+#include "esp_timer.h"
+#include "esp_sntp.h"
+#include "Arduino.h"
+#include "HostSim.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sys/time.h>
+#include <thread>
+#include <vector>
+
+struct SimTimer {
+    esp_timer_cb_t callback;
+    void* arg;
+    uint64_t dueUs = 0;        // 0 = not armed
+    uint64_t periodUs = 0;
+};
+
+static std::mutex timerMutex;
+static std::condition_variable timerChanged;
+static std::vector<SimTimer*> timers;
+
+static void dispatcher() {
+    std::unique_lock<std::mutex> lock(timerMutex);
+    for (;;) {
+        SimTimer* next = nullptr;
+        for (SimTimer* t : timers) {
+            if (t->dueUs && (!next || t->dueUs < next->dueUs)) next = t;
+        }
+        if (!next) {
+            timerChanged.wait(lock);
+            continue;
+        }
+        uint64_t now = hostSimMicros();
+        if (next->dueUs > now) {
+            double hostUs = (next->dueUs - now) / HostSim::timeScale();
+            timerChanged.wait_for(lock, std::chrono::duration<double, std::micro>(hostUs));
+            continue;
+        }
+        next->dueUs = next->periodUs ? next->dueUs + next->periodUs : 0;
+        lock.unlock();
+        next->callback(next->arg);
+        lock.lock();
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+    if (!args || !args->callback || !handle) return ESP_ERR_INVALID_ARG;
+    static std::once_flag started;
+    std::call_once(started, [] { std::thread(dispatcher).detach(); });
+    SimTimer* timer = new SimTimer{args->callback, args->arg};
+    std::lock_guard<std::mutex> lock(timerMutex);
+    timers.push_back(timer);
+    *handle = timer;
+    return ESP_OK;
+}
+
+static esp_err_t arm(esp_timer_handle_t timer, uint64_t us, uint64_t periodUs) {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    if (timer->dueUs) return ESP_ERR_INVALID_STATE;
+    timer->dueUs = hostSimMicros() + (us ? us : 1);
+    timer->periodUs = periodUs;
+    timerChanged.notify_one();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+    return arm(timer, timeoutUs, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    return arm(timer, periodUs, periodUs);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    if (!timer->dueUs) return ESP_ERR_INVALID_STATE;
+    timer->dueUs = 0;
+    timerChanged.notify_one();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    if (timer->dueUs) return ESP_ERR_INVALID_STATE;
+    timers.erase(std::remove(timers.begin(), timers.end(), timer), timers.end());
+    delete timer;
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)hostSimMicros();
+}
+
+// ---- Wall clock ----
+// gettimeofday/settimeofday/time are linked with --wrap (platformio.ini). With
+// SIM_EPOCH set the wall clock starts there and advances with millis(), and
+// settimeofday() moves it as on the device; unset, it is the host clock.
+
+extern "C" int __real_gettimeofday(struct timeval* tv, void* tz);
+extern "C" int __real_settimeofday(const struct timeval* tv, const void* tz);
+extern "C" time_t __real_time(time_t* t);
+
+static std::atomic<int64_t> wallOffsetUs{0};   // Wall clock minus simulated uptime
+
+static bool wallPinned() {
+    static const bool pinned = [] {
+        const char* epoch = HostSim::env("SIM_EPOCH", nullptr);
+        if (!epoch) return false;
+        wallOffsetUs = atoll(epoch) * 1000000LL - (int64_t)hostSimMicros();
+        return true;
+    }();
+    return pinned;
+}
+
+static int64_t wallMicros() {
+    return (int64_t)hostSimMicros() + wallOffsetUs;
+}
+
+extern "C" int __wrap_gettimeofday(struct timeval* tv, void* tz) {
+    if (!wallPinned()) return __real_gettimeofday(tv, tz);
+    int64_t us = wallMicros();
+    tv->tv_sec = us / 1000000;
+    tv->tv_usec = us % 1000000;
+    return 0;
+}
+
+extern "C" int __wrap_settimeofday(const struct timeval* tv, const void* tz) {
+    if (!wallPinned()) return __real_settimeofday(tv, tz);
+    wallOffsetUs = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec - (int64_t)hostSimMicros();
+    return 0;
+}
+
+extern "C" time_t __wrap_time(time_t* t) {
+    if (!wallPinned()) return __real_time(t);
+    time_t now = wallMicros() / 1000000;
+    if (t) *t = now;
+    return now;
+}
+
+// ---- SNTP ----
+
+static sntp_sync_time_cb_t syncCallback = nullptr;
+static uint32_t syncIntervalMs = 3600000;
+static esp_timer_handle_t syncTimer = nullptr;
+
+static void onSync(void*) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    if (syncCallback) syncCallback(&tv);
+    esp_timer_start_once(syncTimer, (uint64_t)syncIntervalMs * 1000);
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char* server2,
+                const char* server3) {
+    (void)gmtOffsetSec;
+    (void)daylightOffsetSec;
+    (void)server2;
+    (void)server3;
+    Serial.printf("🕐 [sim] SNTP '%s' answers with the wall clock\n", server1 ? server1 : "");
+    if (!syncTimer) {
+        esp_timer_create_args_t args = {};
+        args.callback = onSync;
+        args.name = "sntp";
+        esp_timer_create(&args, &syncTimer);
+    }
+    sntp_restart();
+}
+
+bool getLocalTime(struct tm* info, uint32_t timeoutMs) {
+    (void)timeoutMs;
+    time_t now = time(nullptr);
+    localtime_r(&now, info);
+    return true;
+}
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback) {
+    syncCallback = callback;
+}
+
+void sntp_set_sync_interval(uint32_t intervalMs) {
+    syncIntervalMs = intervalMs < 15000 ? 15000 : intervalMs;
+}
+
+uint32_t sntp_get_sync_interval() {
+    return syncIntervalMs;
+}
+
+bool sntp_restart() {
+    if (!syncTimer) return false;
+    esp_timer_stop(syncTimer);
+    esp_timer_start_once(syncTimer, 100000);   // First reply after ~100 ms, like a LAN server
+    return true;
+}
+
+bool sntp_enabled() {
+    return syncTimer != nullptr;
+}
+
+void sntp_stop() {
+    if (syncTimer) esp_timer_stop(syncTimer);
+}
@@ -0,0 +1,174 @@
+#include "FS.h"
+#include "SPIFFS.h"
+#include "HostSim.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SPIFFSFS SPIFFS;
+
+namespace fs {
+
+struct FileImpl {
+    FILE* file = nullptr;
+    DIR* dir = nullptr;
+    std::string path;        // SPIFFS path, e.g. "/calendar.bmp"
+    std::string hostPath;
+    std::string name;
+    ~FileImpl() {
+        if (file) fclose(file);
+        if (dir) closedir(dir);
+    }
+};
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    return _impl && _impl->file ? fwrite(buffer, 1, size, _impl->file) : 0;
+}
+
+int File::available() {
+    if (!_impl || !_impl->file) return 0;
+    long left = (long)size() - (long)position();
+    return left > 0 ? (int)left : 0;
+}
+
+int File::read() {
+    return _impl && _impl->file ? fgetc(_impl->file) : -1;
+}
+
+int File::peek() {
+    if (!_impl || !_impl->file) return -1;
+    int c = fgetc(_impl->file);
+    if (c != EOF) ungetc(c, _impl->file);
+    return c;
+}
+
+void File::flush() {
+    if (_impl && _impl->file) fflush(_impl->file);
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    return _impl && _impl->file ? fread(buffer, 1, size, _impl->file) : 0;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    static const int whence[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+    return _impl && _impl->file && fseek(_impl->file, pos, whence[mode]) == 0;
+}
+
+size_t File::position() const {
+    return _impl && _impl->file ? (size_t)ftell(_impl->file) : 0;
+}
+
+size_t File::size() const {
+    if (!_impl || !_impl->file) return 0;
+    fflush(_impl->file);
+    struct stat st;
+    return fstat(fileno(_impl->file), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void File::close() {
+    _impl.reset();
+}
+
+const char* File::name() const {
+    return _impl ? _impl->name.c_str() : "";
+}
+
+const char* File::path() const {
+    return _impl ? _impl->path.c_str() : "";
+}
+
+bool File::isDirectory() const {
+    return _impl && _impl->dir;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!_impl || !_impl->dir) return File();
+    while (struct dirent* entry = readdir(_impl->dir)) {
+        if (entry->d_name[0] == '.') continue;
+        std::string path = _impl->path == "/" ? "/" + std::string(entry->d_name)
+                                             : _impl->path + "/" + entry->d_name;
+        return SPIFFS.open(path.c_str(), mode);
+    }
+    return File();
+}
+
+std::string FS::hostPath(const char* path) const {
+    std::string p = path ? path : "";
+    if (p.empty() || p[0] != '/') p = "/" + p;
+    return HostSim::fsDir() + p;
+}
+
+File FS::open(const char* path, const char* mode) {
+    auto impl = std::make_shared<FileImpl>();
+    impl->path = path;
+    impl->hostPath = hostPath(path);
+    impl->name = impl->path.substr(impl->path.rfind('/') + 1);
+
+    struct stat st;
+    if (stat(impl->hostPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        impl->dir = opendir(impl->hostPath.c_str());
+        return impl->dir ? File(impl) : File();
+    }
+    // Arduino "r+" on a missing file fails, same as fopen
+    std::string fmode = std::string(mode) + "b";
+    impl->file = fopen(impl->hostPath.c_str(), fmode.c_str());
+    return impl->file ? File(impl) : File();
+}
+
+bool FS::exists(const char* path) {
+    return access(hostPath(path).c_str(), F_OK) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const char* path) {
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+}  // namespace fs
+
+bool SPIFFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+    (void)formatOnFail;
+    (void)basePath;
+    (void)maxOpenFiles;
+    (void)partitionLabel;
+    return HostSim::makeDirs(HostSim::fsDir());
+}
+
+bool SPIFFSFS::format() {
+    File root = open("/");
+    while (File f = root.openNextFile()) {
+        std::string path = f.path();
+        f.close();
+        remove(path.c_str());
+    }
+    return true;
+}
+
+size_t SPIFFSFS::totalBytes() {
+    static const size_t kb = (size_t)atol(HostSim::env("SIM_FS_KB", "1408"));
+    return kb * 1024;
+}
+
+size_t SPIFFSFS::usedBytes() {
+    size_t used = 0;
+    File root = open("/");
+    while (File f = root.openNextFile()) used += f.size();
+    return used;
+}
@@ -0,0 +1,4 @@
+#pragma once
+#include "SimFont.h"
+
+SIM_FONT(FreeMonoBold12pt7b, 12, 16, 14, 24);
@@ -0,0 +1,4 @@
+#pragma once
+#include "SimFont.h"
+
+SIM_FONT(FreeMonoBold9pt7b, 9, 12, 11, 18);
@@ -0,0 +1,4 @@
+#pragma once
+#include "SimFont.h"
+
+SIM_FONT(FreeSans9pt7b, 8, 13, 10, 22);
@@ -0,0 +1,4 @@
+#pragma once
+#include "SimFont.h"
+
+SIM_FONT(FreeSansBold12pt7b, 12, 17, 14, 29);
@@ -0,0 +1,19 @@
+#pragma once
+// Placeholder GFX fonts: real line heights and average advances, no glyph bitmaps,
+// so text lays out close to the device and renders as outlined boxes
+#include "../gfxfont.h"
+#include <array>
+
+template <uint8_t W, uint8_t H, uint8_t ADVANCE>
+constexpr std::array<GFXglyph, 95> simGlyphs() {
+    std::array<GFXglyph, 95> glyphs{};
+    for (size_t i = 1; i < glyphs.size(); i++) {   // ' ' has no ink, only an advance
+        glyphs[i] = GFXglyph{0, W, H, ADVANCE, 1, (int8_t)-H};
+    }
+    glyphs[0] = GFXglyph{0, 0, 0, ADVANCE, 0, 0};
+    return glyphs;
+}
+
+#define SIM_FONT(name, w, h, advance, yAdvance)                                         \
+    static std::array<GFXglyph, 95> name##Glyphs = simGlyphs<w, h, advance>();          \
+    const GFXfont name = {nullptr, name##Glyphs.data(), 0x20, 0x7E, yAdvance}
@@ -0,0 +1,228 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/ringbuf.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "Arduino.h"
+#include "HostSim.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SimTask {
+    std::string name;
+    uint32_t stackDepth;
+};
+
+struct TaskDeleted {};
+
+static SimTask loopTask = {"loopTask", 8192};
+static thread_local SimTask* currentTask = nullptr;        // Set in task threads
+static thread_local SimTask helperTask = {"host", 0};     // esp_timer dispatcher and other helper threads
+static const std::thread::id mainThread = std::this_thread::get_id();
+static std::recursive_mutex criticalMutex;
+
+void hostSimEnterCritical() { criticalMutex.lock(); }
+void hostSimExitCritical() { criticalMutex.unlock(); }
+
+// Waits on a condition for up to `ticks` simulated milliseconds (portMAX_DELAY = forever)
+template <typename Pred>
+static bool waitTicks(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, TickType_t ticks, Pred ready) {
+    if (ticks == portMAX_DELAY) {
+        cv.wait(lock, ready);
+        return true;
+    }
+    auto hostTime = std::chrono::duration<double, std::milli>(ticks / HostSim::timeScale());
+    return cv.wait_for(lock, hostTime, ready);
+}
+
+// ---- Tasks ----
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+    (void)priority;
+    (void)core;
+    SimTask* task = new SimTask{name ? name : "", stackDepth};
+    if (handle) *handle = task;
+    std::thread([=] {
+        currentTask = task;
+        try {
+            function(arg);
+        } catch (const TaskDeleted&) {
+        }
+    }).detach();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr || task == currentTask) throw TaskDeleted();
+    Serial.printf("⚠️ [sim] vTaskDelete(%s) from another task is not supported\n", task->name.c_str());
+}
+
+void vTaskDelay(TickType_t ticks) {
+    hostSimSleepMicros((uint64_t)ticks * 1000);
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t increment) {
+    *previousWake += increment;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previousWake - now) > 0) vTaskDelay(*previousWake - now);
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (currentTask) return currentTask;
+    return std::this_thread::get_id() == mainThread ? &loopTask : &helperTask;
+}
+
+const char* pcTaskGetName(TaskHandle_t task) {
+    return (task ? task : xTaskGetCurrentTaskHandle())->name.c_str();
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    return (task ? task : xTaskGetCurrentTaskHandle())->stackDepth;
+}
+
+// ---- Queues and semaphores ----
+
+struct SimQueue {
+    std::mutex mutex;
+    std::condition_variable notEmpty, notFull;
+    std::deque<std::vector<uint8_t>> items;
+    size_t length, itemSize;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    SimQueue* queue = new SimQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+static void push(SimQueue* queue, const void* item) {
+    const uint8_t* bytes = (const uint8_t*)item;
+    queue->items.emplace_back(bytes, bytes + (item ? queue->itemSize : 0));
+    queue->notEmpty.notify_one();
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitTicks(queue->notFull, lock, ticksToWait, [&] { return queue->items.size() < queue->length; })) {
+        return errQUEUE_FULL;
+    }
+    push(queue, item);
+    return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* woken) {
+    if (woken) *woken = pdFALSE;
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->items.clear();
+    push(queue, item);
+    return pdPASS;
+}
+
+static BaseType_t take(QueueHandle_t queue, void* item, TickType_t ticksToWait, bool remove) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitTicks(queue->notEmpty, lock, ticksToWait, [&] { return !queue->items.empty(); })) return pdFALSE;
+    if (item && queue->itemSize) memcpy(item, queue->items.front().data(), queue->itemSize);
+    if (remove) {
+        queue->items.pop_front();
+        queue->notFull.notify_one();
+    }
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    return take(queue, item, ticksToWait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    return take(queue, item, ticksToWait, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->items.size();
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->items.clear();
+    queue->notFull.notify_all();
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    SemaphoreHandle_t sem = xQueueCreate(1, 0);
+    xQueueSend(sem, nullptr, 0);
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+    SemaphoreHandle_t sem = xQueueCreate(maxCount, 0);
+    while (initialCount--) xQueueSend(sem, nullptr, 0);
+    return sem;
+}
+
+// ---- Ring buffers ----
+
+struct SimRingbuf {
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::deque<std::vector<uint8_t>> items;
+    std::vector<uint8_t> lent;     // Item handed out until vRingbufferReturnItem
+    size_t size, used = 0;
+};
+
+RingbufHandle_t xRingbufferCreate(size_t size, int type) {
+    (void)type;
+    SimRingbuf* ring = new SimRingbuf();
+    ring->size = size;
+    return ring;
+}
+
+BaseType_t xRingbufferSend(RingbufHandle_t ring, const void* data, size_t size, TickType_t ticksToWait) {
+    (void)ticksToWait;
+    std::lock_guard<std::mutex> lock(ring->mutex);
+    if (ring->used + size > ring->size) return pdFALSE;
+    ring->items.emplace_back((const uint8_t*)data, (const uint8_t*)data + size);
+    ring->used += size;
+    ring->notEmpty.notify_one();
+    return pdTRUE;
+}
+
+void* xRingbufferReceive(RingbufHandle_t ring, size_t* size, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(ring->mutex);
+    if (!waitTicks(ring->notEmpty, lock, ticksToWait, [&] { return !ring->items.empty(); })) return nullptr;
+    ring->lent.swap(ring->items.front());
+    ring->items.pop_front();
+    if (size) *size = ring->lent.size();
+    return ring->lent.data();
+}
+
+void vRingbufferReturnItem(RingbufHandle_t ring, void* item) {
+    (void)item;
+    std::lock_guard<std::mutex> lock(ring->mutex);
+    ring->used -= ring->lent.size();
+    ring->lent.clear();
+}
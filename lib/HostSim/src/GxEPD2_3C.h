@@ -0,0 +1,170 @@
+#pragma once
+// GxEPD2's paged 3-colour driver over a host framebuffer. Drawing lands in a page
+// buffer of page_height rows exactly as on the device (pixels outside the current
+// page are dropped), pages are written to "controller RAM" as they complete, and
+// every refresh dumps the whole panel as a PPM into SIM_OUT_DIR.
+#include "Adafruit_GFX.h"
+#include <vector>
+
+#define GxEPD_BLACK 0x0000
+#define GxEPD_WHITE 0xFFFF
+#define GxEPD_RED 0xF800
+#define GxEPD_YELLOW 0xFFE0
+#define GxEPD_COLORED GxEPD_RED
+
+enum SimPixel : uint8_t { SIM_WHITE = 0, SIM_BLACK = 1, SIM_RED = 2 };
+
+struct SimPanel {
+    const char* name;
+    uint16_t width, height;
+    uint32_t fullRefreshMs;    // Datasheet full refresh; only waited out with SIM_REFRESH_DELAY=1
+};
+
+// Writes the panel image and logs the refresh; returns the frame number
+uint32_t hostSimRefresh(const SimPanel& panel, const std::vector<uint8_t>& ram, bool partial,
+                        int16_t x, int16_t y, int16_t w, int16_t h);
+
+class GxEPD2_750c_Z08 {
+public:
+    static const uint16_t WIDTH = 800, HEIGHT = 480;
+    static constexpr SimPanel panel = {"GxEPD2_750c_Z08", WIDTH, HEIGHT, 26000};
+    GxEPD2_750c_Z08(int16_t cs, int16_t dc, int16_t rst, int16_t busy) { (void)cs; (void)dc; (void)rst; (void)busy; }
+};
+
+class GxEPD2_750c_Z90 {
+public:
+    static const uint16_t WIDTH = 800, HEIGHT = 480;
+    static constexpr SimPanel panel = {"GxEPD2_750c_Z90", WIDTH, HEIGHT, 22000};
+    GxEPD2_750c_Z90(int16_t cs, int16_t dc, int16_t rst, int16_t busy) { (void)cs; (void)dc; (void)rst; (void)busy; }
+};
+
+template <typename GxEPD2_Type, const uint16_t page_height>
+class GxEPD2_3C : public Adafruit_GFX {
+public:
+    GxEPD2_Type epd2;
+
+    explicit GxEPD2_3C(GxEPD2_Type epd2_instance)
+        : Adafruit_GFX(GxEPD2_Type::WIDTH, GxEPD2_Type::HEIGHT), epd2(epd2_instance),
+          _ram(GxEPD2_Type::WIDTH * GxEPD2_Type::HEIGHT, SIM_WHITE),
+          _page(GxEPD2_Type::WIDTH * page_height, SIM_WHITE) {
+        setFullWindow();
+    }
+
+    void init(uint32_t serialDiagBitrate = 0, bool initial = true, uint16_t resetDuration = 10, bool pulldownRst = false) {
+        (void)serialDiagBitrate; (void)initial; (void)resetDuration; (void)pulldownRst;
+    }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+        if (x < 0 || x >= width() || y < 0 || y >= height()) return;
+        switch (getRotation()) {
+            case 1: std::swap(x, y); x = WIDTH - x - 1; break;
+            case 2: x = WIDTH - x - 1; y = HEIGHT - y - 1; break;
+            case 3: std::swap(x, y); y = HEIGHT - y - 1; break;
+        }
+        x -= _pwX;
+        y -= _pwY + _currentPage * page_height;
+        if (x < 0 || x >= _pwW || y < 0 || y >= page_height) return;
+        _page[y * _pwW + x] = color == GxEPD_WHITE ? SIM_WHITE
+                            : (color == GxEPD_RED || color == GxEPD_YELLOW) ? SIM_RED : SIM_BLACK;
+    }
+
+    void fillScreen(uint16_t color) override {
+        uint8_t value = color == GxEPD_WHITE ? SIM_WHITE : (color == GxEPD_RED || color == GxEPD_YELLOW) ? SIM_RED : SIM_BLACK;
+        std::fill(_page.begin(), _page.end(), value);
+    }
+
+    void setFullWindow() {
+        _partial = false;
+        _pwX = _pwY = 0;
+        _pwW = WIDTH;
+        _pwH = HEIGHT;
+    }
+
+    // Rotated into panel coordinates; x and width widen to whole bytes like the real driver
+    void setPartialWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+        int16_t px = x, py = y, pw = w, ph = h;
+        switch (getRotation()) {
+            case 1: std::swap(px, py); std::swap(pw, ph); px = WIDTH - px - pw; break;
+            case 2: px = WIDTH - px - pw; py = HEIGHT - py - ph; break;
+            case 3: std::swap(px, py); std::swap(pw, ph); py = HEIGHT - py - ph; break;
+        }
+        pw += px % 8;
+        if (pw % 8) pw += 8 - pw % 8;
+        px -= px % 8;
+        _pwX = std::max<int16_t>(0, px);
+        _pwY = std::max<int16_t>(0, py);
+        _pwW = std::min<int16_t>(pw, WIDTH - _pwX);
+        _pwH = std::min<int16_t>(ph, HEIGHT - _pwY);
+        _partial = true;
+    }
+
+    void firstPage() {
+        fillScreen(GxEPD_WHITE);
+        _currentPage = 0;
+    }
+
+    bool nextPage() {
+        writePage();
+        _currentPage++;
+        if (_currentPage * page_height < _pwH) {
+            fillScreen(GxEPD_WHITE);
+            return true;
+        }
+        _currentPage = 0;
+        refresh(_partial);
+        return false;
+    }
+
+    // Writes the (first) page buffer and refreshes, as the paged driver does
+    void display(bool partialUpdateMode = false) {
+        writePage();
+        refresh(partialUpdateMode);
+    }
+
+    void writeImage(const uint8_t* black, const uint8_t* color, int16_t x, int16_t y, int16_t w, int16_t h,
+                    bool invert = false, bool mirrorY = false, bool pgm = false) {
+        (void)pgm;
+        int16_t byteWidth = (w + 7) / 8;
+        for (int16_t j = 0; j < h; j++) {
+            int16_t row = mirrorY ? h - 1 - j : j;
+            for (int16_t i = 0; i < w; i++) {
+                int16_t px = x + i, py = y + j;
+                if (px < 0 || px >= WIDTH || py < 0 || py >= HEIGHT) continue;
+                uint8_t mask = 0x80 >> (i & 7);
+                bool isBlack = black && (((black[row * byteWidth + i / 8] & mask) == 0) != invert);
+                bool isColor = color && (((color[row * byteWidth + i / 8] & mask) == 0) != invert);
+                _ram[py * WIDTH + px] = isColor ? SIM_RED : isBlack ? SIM_BLACK : SIM_WHITE;
+            }
+        }
+    }
+
+    void refresh(bool partialUpdateMode = false) {
+        if (partialUpdateMode) hostSimRefresh(GxEPD2_Type::panel, _ram, true, _pwX, _pwY, _pwW, _pwH);
+        else hostSimRefresh(GxEPD2_Type::panel, _ram, false, 0, 0, WIDTH, HEIGHT);
+    }
+
+    void refresh(int16_t x, int16_t y, int16_t w, int16_t h) {
+        hostSimRefresh(GxEPD2_Type::panel, _ram, true, x, y, w, h);
+    }
+
+    void powerOff() {}
+    void hibernate() {}
+
+    // Sim only: controller RAM as SimPixel values, row-major WIDTH x HEIGHT
+    const std::vector<uint8_t>& simRam() const { return _ram; }
+
+private:
+    std::vector<uint8_t> _ram;     // What the controller holds, WIDTH x HEIGHT
+    std::vector<uint8_t> _page;    // The page buffer, window width x page_height
+    bool _partial = false;
+    int16_t _pwX = 0, _pwY = 0, _pwW = WIDTH, _pwH = HEIGHT;
+    uint16_t _currentPage = 0;
+
+    void writePage() {
+        int16_t top = _currentPage * page_height;
+        int16_t rows = std::min<int16_t>(page_height, _pwH - top);
+        for (int16_t r = 0; r < rows; r++) {
+            memcpy(&_ram[(_pwY + top + r) * WIDTH + _pwX], &_page[r * _pwW], _pwW);
+        }
+    }
+};
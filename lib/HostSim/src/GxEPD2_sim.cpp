@@ -0,0 +1,40 @@
+#include "GxEPD2_3C.h"
+#include "HostSim.h"
+#include <stdio.h>
+
+constexpr SimPanel GxEPD2_750c_Z08::panel;
+constexpr SimPanel GxEPD2_750c_Z90::panel;
+
+static uint32_t frames = 0;
+
+uint32_t hostSimRefresh(const SimPanel& panel, const std::vector<uint8_t>& ram, bool partial,
+                        int16_t x, int16_t y, int16_t w, int16_t h) {
+    uint32_t frame = ++frames;
+    static const bool dump = atoi(HostSim::env("SIM_FRAMES", "1")) != 0;
+    static const bool wait = atoi(HostSim::env("SIM_REFRESH_DELAY", "0")) != 0;
+
+    char path[512] = "";
+    if (dump) {
+        snprintf(path, sizeof(path), "%s/frame_%05u.ppm", HostSim::outDir().c_str(), frame);
+        FILE* f = fopen(path, "wb");
+        if (f) {
+            static const uint8_t rgb[3][3] = {{255, 255, 255}, {0, 0, 0}, {200, 0, 0}};
+            fprintf(f, "P6\n# %s %s %d,%d %dx%d\n%u %u\n255\n", panel.name, partial ? "partial" : "full",
+                    x, y, w, h, panel.width, panel.height);
+            std::vector<uint8_t> row(panel.width * 3);
+            for (uint16_t py = 0; py < panel.height; py++) {
+                for (uint16_t px = 0; px < panel.width; px++) {
+                    memcpy(&row[px * 3], rgb[ram[py * panel.width + px]], 3);
+                }
+                fwrite(row.data(), 1, row.size(), f);
+            }
+            fclose(f);
+        } else {
+            path[0] = 0;
+        }
+    }
+    Serial.printf("🖼️ [sim] refresh #%u (%s %d,%d %dx%d)%s%s\n", frame, partial ? "partial" : "full", x, y, w, h,
+                  path[0] ? " -> " : "", path);
+    if (wait) delay(panel.fullRefreshMs);   // 3-colour panels have no fast partial refresh
+    return frame;
+}
@@ -0,0 +1,52 @@
+#pragma once
+// Every request goes to SIM_HTTP (default 127.0.0.1:3000) whatever the URL's host;
+// the original host is kept in the Host header so tools/content_server.py can answer
+// for the weather and geolocation APIs too. Always HTTP/1.0, so bodies are never chunked.
+#include "WiFi.h"
+#include <vector>
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_NO_CONTENT 204
+#define HTTP_CODE_MOVED_PERMANENTLY 301
+#define HTTP_CODE_FOUND 302
+#define HTTP_CODE_NOT_MODIFIED 304
+#define HTTP_CODE_NOT_FOUND 404
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+class HTTPClient {
+public:
+    bool begin(const String& url);
+    bool begin(const char* url) { return begin(String(url)); }
+    bool begin(WiFiClient& client, const String& url) { (void)client; return begin(url); }
+    void end();
+
+    void setTimeout(uint16_t timeoutMs) { _timeout = timeoutMs; }
+    void setConnectTimeout(int32_t timeoutMs) { _connectTimeout = timeoutMs; }
+    void setReuse(bool reuse) { (void)reuse; }
+    void useHTTP10(bool useHttp10) { (void)useHttp10; }
+    void addHeader(const String& name, const String& value);
+    void collectHeaders(const char* headerKeys[], size_t count);
+
+    int GET();
+    int getSize() const { return _size; }
+    String header(const char* name) const;
+    bool connected() { return _client.connected(); }
+    WiFiClient& getStream() { return _client; }
+    WiFiClient* getStreamPtr() { return &_client; }
+    String getString();
+    static String errorToString(int error);
+
+private:
+    std::string _host, _path, _requestHeaders;
+    uint16_t _timeout = 5000;
+    int32_t _connectTimeout = 5000;
+    int _size = -1;
+    std::vector<std::pair<std::string, std::string>> _collected;   // Name, value
+    WiFiClient _client;
+
+    bool readLine(std::string& line);
+};
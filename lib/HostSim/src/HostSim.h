@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+
+// Simulator knobs, read once from the environment (see lib/HostSim/README.md)
+namespace HostSim {
+double timeScale();              // SIM_TIME_SCALE, default 1
+uint32_t heapKb();               // SIM_HEAP_KB, default 320
+const std::string& fsDir();      // SIM_FS_DIR, default sim/fs
+const std::string& outDir();     // SIM_OUT_DIR, default sim/frames
+const std::string& httpHost();   // SIM_HTTP host part, default 127.0.0.1
+uint16_t httpPort();             // SIM_HTTP port part, default 3000
+const char* env(const char* name, const char* fallback);
+bool makeDirs(const std::string& path);
+void muteSerial(bool muted);     // Drop Serial output (benchmarks), stdout itself stays usable
+[[noreturn]] void restart();
+}
+
+uint64_t hostSimMicros();        // Simulated time since boot
+void hostSimSleepMicros(uint64_t us);
@@ -0,0 +1,26 @@
+#pragma once
+#include <string.h>
+#include "Stream.h"
+
+// Read-only Stream over a buffer, the parsers' view of an HTTP body. For the
+// host programs that feed fixtures straight to a parser (checks, bench, golden).
+class MemoryStream : public Stream {
+public:
+    MemoryStream(const char* data, size_t length) : _data(data), _length(length), _pos(0) {}
+    explicit MemoryStream(const char* text) : MemoryStream(text, strlen(text)) {}
+    int available() override { return _length - _pos; }
+    int read() override { return _pos < _length ? (uint8_t)_data[_pos++] : -1; }
+    int peek() override { return _pos < _length ? (uint8_t)_data[_pos] : -1; }
+    size_t readBytes(char* buffer, size_t length) override {
+        size_t n = length < _length - _pos ? length : _length - _pos;
+        memcpy(buffer, _data + _pos, n);
+        _pos += n;
+        return n;
+    }
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    const char* _data;
+    size_t _length;
+    size_t _pos;
+};
@@ -0,0 +1,73 @@
+#include "Preferences.h"
+#include "HostSim.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+    (void)partitionLabel;
+    if (!name || strlen(name) > 15) return false;   // NVS namespace limit
+    _dir = HostSim::fsDir() + "/.nvs/" + name;
+    _readOnly = readOnly;
+    return readOnly || HostSim::makeDirs(_dir);
+}
+
+bool Preferences::clear() {
+    if (_dir.empty() || _readOnly) return false;
+    DIR* dir = opendir(_dir.c_str());
+    if (!dir) return true;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') unlink(keyPath(entry->d_name).c_str());
+    }
+    closedir(dir);
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    return !_dir.empty() && !_readOnly && unlink(keyPath(key).c_str()) == 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    return !_dir.empty() && access(keyPath(key).c_str(), F_OK) == 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    if (_dir.empty() || _readOnly || !key || strlen(key) > 15) return 0;
+    FILE* f = fopen(keyPath(key).c_str(), "wb");
+    if (!f) return 0;
+    size_t written = fwrite(value, 1, length, f);
+    fclose(f);
+    return written == length ? length : 0;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    struct stat st;
+    return !_dir.empty() && stat(keyPath(key).c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+    size_t length = getBytesLength(key);
+    if (!length || length > maxLength) return 0;
+    FILE* f = fopen(keyPath(key).c_str(), "rb");
+    if (!f) return 0;
+    size_t read = fread(buffer, 1, length, f);
+    fclose(f);
+    return read;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+    size_t length = getBytesLength(key);
+    if (!isKey(key)) return defaultValue;
+    std::string value(length, '\0');
+    if (length) getBytes(key, &value[0], length);
+    return String(value);
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLength) {
+    size_t length = getBytesLength(key);
+    if (!isKey(key) || length + 1 > maxLength) return 0;
+    getBytes(key, value, length);
+    value[length] = 0;
+    return length + 1;
+}
@@ -0,0 +1,52 @@
+#pragma once
+// NVS as one file per key under SIM_FS_DIR/.nvs/<namespace>/
+#include "Arduino.h"
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end() { _dir.clear(); }
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBytes(const char* key, const void* value, size_t length);
+    size_t getBytes(const char* key, void* buffer, size_t maxLength);
+    size_t getBytesLength(const char* key);
+
+    size_t putString(const char* key, const char* value) { return putBytes(key, value, strlen(value)); }
+    size_t putString(const char* key, const String& value) { return putBytes(key, value.c_str(), value.length()); }
+    String getString(const char* key, const String& defaultValue = String());
+    size_t getString(const char* key, char* value, size_t maxLength);
+
+    size_t putUChar(const char* key, uint8_t value) { return put(key, value); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return get(key, defaultValue); }
+    size_t putBool(const char* key, bool value) { return put(key, (uint8_t)value); }
+    bool getBool(const char* key, bool defaultValue = false) { return get(key, (uint8_t)defaultValue); }
+    size_t putInt(const char* key, int32_t value) { return put(key, value); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return get(key, defaultValue); }
+    size_t putUInt(const char* key, uint32_t value) { return put(key, value); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return get(key, defaultValue); }
+    size_t putLong64(const char* key, int64_t value) { return put(key, value); }
+    int64_t getLong64(const char* key, int64_t defaultValue = 0) { return get(key, defaultValue); }
+    size_t putULong64(const char* key, uint64_t value) { return put(key, value); }
+    uint64_t getULong64(const char* key, uint64_t defaultValue = 0) { return get(key, defaultValue); }
+    size_t putFloat(const char* key, float value) { return put(key, value); }
+    float getFloat(const char* key, float defaultValue = 0) { return get(key, defaultValue); }
+    size_t putDouble(const char* key, double value) { return put(key, value); }
+    double getDouble(const char* key, double defaultValue = 0) { return get(key, defaultValue); }
+
+private:
+    std::string _dir;
+    bool _readOnly = false;
+
+    std::string keyPath(const char* key) const { return _dir + "/" + key; }
+
+    template <typename T>
+    size_t put(const char* key, T value) { return putBytes(key, &value, sizeof(value)); }
+    template <typename T>
+    T get(const char* key, T defaultValue) {
+        T value;
+        return getBytesLength(key) == sizeof(T) && getBytes(key, &value, sizeof(T)) ? value : defaultValue;
+    }
+};
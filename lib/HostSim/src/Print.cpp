@@ -0,0 +1,71 @@
+#include "Print.h"
+#include "Stream.h"
+#include <stdio.h>
+#include <vector>
+
+unsigned long millis();
+void delay(unsigned long ms);
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        if (!write(*buffer++)) break;
+        n++;
+    }
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    size_t n = vprintf(format, args);
+    va_end(args);
+    return n;
+}
+
+size_t Print::vprintf(const char* format, va_list args) {
+    char small[128];
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(small, sizeof(small), format, copy);
+    va_end(copy);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(small)) return write((const uint8_t*)small, len);
+    std::vector<char> big(len + 1);
+    vsnprintf(big.data(), big.size(), format, args);
+    return write((const uint8_t*)big.data(), len);
+}
+
+int Stream::timedRead() {
+    unsigned long start = millis();
+    do {
+        int c = read();
+        if (c >= 0) return c;
+        delay(1);
+    } while (millis() - start < _timeout);
+    return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead();
+        if (c < 0) break;
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+String Stream::readStringUntil(char terminator) {
+    String s;
+    int c;
+    while ((c = timedRead()) >= 0 && c != terminator) s += (char)c;
+    return s;
+}
+
+String Stream::readString() {
+    String s;
+    int c;
+    while ((c = timedRead()) >= 0) s += (char)c;
+    return s;
+}
@@ -0,0 +1,103 @@
+#include "driver/gpio.h"
+#include "driver/rmt.h"
+#include "Arduino.h"
+#include "HostSim.h"
+#include <string>
+#include <vector>
+
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode) {
+    (void)gpio;
+    (void)mode;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level) {
+    digitalWrite(gpio, level);
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio) {
+    return digitalRead(gpio);
+}
+
+esp_err_t gpio_set_pull_mode(gpio_num_t gpio, gpio_pull_mode_t pull) {
+    if (pull == GPIO_PULLUP_ONLY) digitalWrite(gpio, HIGH);
+    return ESP_OK;
+}
+
+static RingbufHandle_t rings[RMT_CHANNEL_MAX];
+static size_t scriptStep = 0;
+
+esp_err_t rmt_config(const rmt_config_t* config) {
+    return config && config->channel < RMT_CHANNEL_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rxBufferSize, int intrFlags) {
+    (void)intrFlags;
+    if (channel >= RMT_CHANNEL_MAX || rings[channel]) return ESP_ERR_INVALID_STATE;
+    rings[channel] = xRingbufferCreate(rxBufferSize, 0);
+    return ESP_OK;
+}
+
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel) {
+    rings[channel] = nullptr;   // Leaked: a reader may still hold an item
+    return ESP_OK;
+}
+
+esp_err_t rmt_get_ringbuf_handle(rmt_channel_t channel, RingbufHandle_t* handle) {
+    if (channel >= RMT_CHANNEL_MAX || !rings[channel]) return ESP_ERR_INVALID_STATE;
+    *handle = rings[channel];
+    return ESP_OK;
+}
+
+// Next entry of SIM_DHT, e.g. "21.5,45;22,44.5;none"
+static std::string nextReading() {
+    std::string script = HostSim::env("SIM_DHT", "21.5,45");
+    std::vector<std::string> entries;
+    for (size_t start = 0, end; start <= script.size(); start = end + 1) {
+        end = script.find(';', start);
+        if (end == std::string::npos) end = script.size();
+        entries.push_back(script.substr(start, end - start));
+    }
+    return entries[scriptStep++ % entries.size()];
+}
+
+static void addPulse(std::vector<rmt_item32_t>& items, uint16_t lowUs, uint16_t highUs) {
+    rmt_item32_t item = {};
+    item.level0 = 0;
+    item.duration0 = lowUs;
+    item.level1 = 1;
+    item.duration1 = highUs;
+    items.push_back(item);
+}
+
+esp_err_t rmt_rx_start(rmt_channel_t channel, bool resetMemory) {
+    (void)resetMemory;
+    if (channel >= RMT_CHANNEL_MAX || !rings[channel]) return ESP_ERR_INVALID_STATE;
+    std::string reading = nextReading();
+    if (reading == "none") return ESP_OK;
+
+    float temperature = 21.5f, humidity = 45.0f;
+    sscanf(reading.c_str(), "%f,%f", &temperature, &humidity);
+    uint16_t rh = (uint16_t)lroundf(humidity * 10);
+    uint16_t t = (uint16_t)lroundf(fabsf(temperature) * 10) | (temperature < 0 ? 0x8000 : 0);
+    uint8_t data[5] = {(uint8_t)(rh >> 8), (uint8_t)rh, (uint8_t)(t >> 8), (uint8_t)t, 0};
+    data[4] = data[0] + data[1] + data[2] + data[3] + (reading == "bad" ? 1 : 0);
+
+    // Sensor response (80 us low, 80 us high), 40 bits of 50 us low + 26/70 us high,
+    // then the trailing low that the idle threshold ends
+    std::vector<rmt_item32_t> items;
+    addPulse(items, 80, 80);
+    for (int i = 0; i < 40; i++) addPulse(items, 50, (data[i / 8] & (0x80 >> (i % 8))) ? 70 : 26);
+    addPulse(items, 50, 0);
+    items.back().level1 = 0;
+
+    delayMicroseconds(5000);   // The frame takes ~5 ms on the wire
+    xRingbufferSend(rings[channel], items.data(), items.size() * sizeof(rmt_item32_t), 0);
+    return ESP_OK;
+}
+
+esp_err_t rmt_rx_stop(rmt_channel_t channel) {
+    (void)channel;
+    return ESP_OK;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "FS.h"
+
+class SPIFFSFS : public fs::FS {
+public:
+    SPIFFSFS() : FS("spiffs") {}
+    bool begin(bool formatOnFail = false, const char* basePath = "/spiffs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = nullptr);
+    void end() {}
+    bool format();
+    size_t totalBytes();   // SIM_FS_KB, default 1408 (the 4 MB default partition table)
+    size_t usedBytes();
+};
+
+extern SPIFFSFS SPIFFS;
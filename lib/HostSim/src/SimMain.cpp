@@ -0,0 +1,98 @@
+#include "Arduino.h"
+#include "HostSim.h"
+#include <errno.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Builds that must not touch the simulator's flash contents set their own default
+#ifndef HOSTSIM_DEFAULT_FS_DIR
+#define HOSTSIM_DEFAULT_FS_DIR "sim/fs"
+#endif
+
+static char** savedArgv = nullptr;
+
+namespace HostSim {
+
+const char* env(const char* name, const char* fallback) {
+    const char* value = getenv(name);
+    return value && *value ? value : fallback;
+}
+
+double timeScale() {
+    static const double scale = [] {
+        double s = atof(env("SIM_TIME_SCALE", "1"));
+        return s > 0 ? s : 1.0;
+    }();
+    return scale;
+}
+
+uint32_t heapKb() {
+    static const uint32_t kb = (uint32_t)atol(env("SIM_HEAP_KB", "320"));
+    return kb;
+}
+
+const std::string& fsDir() {
+    static const std::string dir = env("SIM_FS_DIR", HOSTSIM_DEFAULT_FS_DIR);
+    return dir;
+}
+
+const std::string& outDir() {
+    static const std::string dir = env("SIM_OUT_DIR", "sim/frames");
+    return dir;
+}
+
+static std::string httpSetting() {
+    return env("SIM_HTTP", "127.0.0.1:3000");
+}
+
+const std::string& httpHost() {
+    static const std::string host = httpSetting().substr(0, httpSetting().rfind(':'));
+    return host;
+}
+
+uint16_t httpPort() {
+    static const uint16_t port = [] {
+        std::string s = httpSetting();
+        size_t colon = s.rfind(':');
+        return (uint16_t)(colon == std::string::npos ? 80 : atoi(s.c_str() + colon + 1));
+    }();
+    return port;
+}
+
+bool makeDirs(const std::string& path) {
+    for (size_t p = path.find('/', 1); ; p = path.find('/', p + 1)) {
+        std::string part = path.substr(0, p);
+        if (mkdir(part.c_str(), 0755) != 0 && errno != EEXIST) return false;
+        if (p == std::string::npos) return true;
+    }
+}
+
+void restart() {
+    fflush(stdout);
+    if (savedArgv) execv("/proc/self/exe", savedArgv);
+    exit(0);
+}
+
+}  // namespace HostSim
+
+// setup() once, then loop() until SIM_LOOPS iterations or SIM_RUN_MS of simulated time
+int main(int argc, char** argv) {
+    (void)argc;
+    savedArgv = argv;
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    signal(SIGPIPE, SIG_IGN);
+    HostSim::makeDirs(HostSim::fsDir());
+    HostSim::makeDirs(HostSim::outDir());
+
+    unsigned long loops = strtoul(HostSim::env("SIM_LOOPS", "0"), nullptr, 10);
+    unsigned long runMs = strtoul(HostSim::env("SIM_RUN_MS", "0"), nullptr, 10);
+
+    setup();
+    for (unsigned long n = 0; (!loops || n < loops) && (!runMs || millis() < runMs); n++) {
+        loop();
+    }
+    Serial.printf("🏁 [sim] stopped after %lu ms\n", millis());
+    fflush(stdout);
+    _exit(0);   // Background tasks never return; skip their static destructors
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "Print.h"
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeoutMs) { _timeout = timeoutMs; }
+    unsigned long getTimeout() const { return _timeout; }
+
+    // Both wait up to the timeout for each byte, like the Arduino core
+    virtual size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    String readStringUntil(char terminator);
+    String readString();
+
+protected:
+    unsigned long _timeout = 1000;
+    int timedRead();
+};
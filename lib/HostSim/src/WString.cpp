@@ -0,0 +1,70 @@
+#include "WString.h"
+#include <algorithm>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static std::string formatInteger(unsigned long long value, bool negative, unsigned char base) {
+    if (base < 2 || base > 36) base = 10;
+    char buf[72];
+    char* p = buf + sizeof(buf);
+    *--p = 0;
+    do {
+        unsigned digit = value % base;
+        *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value);
+    if (negative) *--p = '-';
+    return p;
+}
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base) {
+    // Like the Arduino core, only base 10 prints a sign
+    if (base == 10 && value < 0) _s = formatInteger(-(unsigned long long)value, true, base);
+    else _s = formatInteger((unsigned long)value, false, base);
+}
+
+String::String(unsigned long value, unsigned char base) : _s(formatInteger(value, false, base)) {}
+
+String::String(float value, unsigned int decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+    _s = buf;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= _s.size()) return String();
+    return String(_s.substr(from, to - from));
+}
+
+void String::replace(const String& find, const String& with) {
+    if (find._s.empty()) return;
+    for (size_t p = 0; (p = _s.find(find._s, p)) != std::string::npos; p += with._s.size()) {
+        _s.replace(p, find._s.size(), with._s);
+    }
+}
+
+void String::trim() {
+    size_t begin = 0, end = _s.size();
+    while (begin < end && isspace((unsigned char)_s[begin])) begin++;
+    while (end > begin && isspace((unsigned char)_s[end - 1])) end--;
+    _s = _s.substr(begin, end - begin);
+}
+
+void String::toLowerCase() {
+    for (char& c : _s) c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+    for (char& c : _s) c = toupper((unsigned char)c);
+}
+
+long String::toInt() const { return atol(_s.c_str()); }
+float String::toFloat() const { return (float)atof(_s.c_str()); }
+double String::toDouble() const { return atof(_s.c_str()); }
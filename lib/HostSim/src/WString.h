@@ -0,0 +1,79 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// Arduino String on top of std::string (only what the firmware and ArduinoJson use)
+class String {
+public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    explicit String(char c) : _s(1, c) {}
+    String(int value, unsigned char base = 10);
+    String(unsigned int value, unsigned char base = 10);
+    String(long value, unsigned char base = 10);
+    String(unsigned long value, unsigned char base = 10);
+    String(float value, unsigned int decimals = 2);
+    String(double value, unsigned int decimals = 2);
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.size(); }
+    bool isEmpty() const { return _s.empty(); }
+    bool reserve(unsigned int size) { _s.reserve(size); return true; }
+
+    bool concat(const String& s) { _s += s._s; return true; }
+    bool concat(const char* s) { if (s) _s += s; return s != nullptr; }
+    bool concat(const char* s, unsigned int length) { _s.append(s, length); return true; }
+    bool concat(char c) { _s += c; return true; }
+    String& operator+=(const String& s) { _s += s._s; return *this; }
+    String& operator+=(const char* s) { concat(s); return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+
+    bool equals(const String& s) const { return _s == s._s; }
+    bool equals(const char* s) const { return _s == (s ? s : ""); }
+    bool operator==(const String& s) const { return equals(s); }
+    bool operator==(const char* s) const { return equals(s); }
+    bool operator!=(const String& s) const { return !equals(s); }
+    bool operator!=(const char* s) const { return !equals(s); }
+    bool operator<(const String& s) const { return _s < s._s; }
+
+    char charAt(unsigned int i) const { return i < _s.size() ? _s[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    char& operator[](unsigned int i) { return _s[i]; }
+
+    int indexOf(char c, unsigned int from = 0) const { return pos(_s.find(c, from)); }
+    int indexOf(const String& s, unsigned int from = 0) const { return pos(_s.find(s._s, from)); }
+    int lastIndexOf(char c) const { return pos(_s.rfind(c)); }
+    bool startsWith(const String& s) const { return _s.compare(0, s._s.size(), s._s) == 0; }
+    bool endsWith(const String& s) const {
+        return _s.size() >= s._s.size() && _s.compare(_s.size() - s._s.size(), s._s.size(), s._s) == 0;
+    }
+    String substring(unsigned int from) const { return from < _s.size() ? String(_s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void remove(unsigned int index) { if (index < _s.size()) _s.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < _s.size()) _s.erase(index, count); }
+    void replace(const String& find, const String& with);
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+
+private:
+    std::string _s;
+    static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+};
+
+// ArduinoJson's String adapter names this type
+class StringSumHelper : public String {
+public:
+    using String::String;
+};
+
+inline String operator+(const String& a, const String& b) { String s(a); s += b; return s; }
+inline String operator+(const String& a, const char* b) { String s(a); s += b; return s; }
+inline String operator+(const char* a, const String& b) { String s(a); s += b; return s; }
+inline String operator+(const String& a, char b) { String s(a); s += b; return s; }
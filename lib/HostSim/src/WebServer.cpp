@@ -0,0 +1,100 @@
+#include "WebServer.h"
+#include "HostSim.h"
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const int REQUEST_WAIT_MS = 2000;   // Host time a client gets to send its request line
+
+static bool writeAll(int fd, const char* data, size_t length) {
+    while (length) {
+        ssize_t n = ::send(fd, data, length, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+void WebServer::begin() {
+    if (_listenFd >= 0) return;
+    int hostPort = atoi(HostSim::env("SIM_WEB_PORT", "0"));
+    if (!hostPort) hostPort = _port < 1024 ? _port + 8000 : _port;
+
+    _listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    int one = 1;
+    setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(hostPort);
+    if (bind(_listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(_listenFd, 4) != 0) {
+        fprintf(stderr, "[sim] WebServer cannot listen on port %d\n", hostPort);
+        close(_listenFd);
+        _listenFd = -1;
+        return;
+    }
+    fprintf(stderr, "[sim] WebServer for device port %d on http://127.0.0.1:%d\n", _port, hostPort);
+}
+
+void WebServer::stop() {
+    if (_listenFd >= 0) close(_listenFd);
+    _listenFd = -1;
+}
+
+void WebServer::handleClient() {
+    if (_listenFd < 0) return;
+    _clientFd = accept(_listenFd, nullptr, nullptr);
+    if (_clientFd < 0) return;
+
+    // Request line and headers; only the path matters here
+    std::string request;
+    char buf[512];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        struct pollfd pfd = {_clientFd, POLLIN, 0};
+        if (poll(&pfd, 1, REQUEST_WAIT_MS) != 1) break;
+        ssize_t n = recv(_clientFd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        request.append(buf, n);
+    }
+    size_t start = request.find(' ');
+    size_t end = start == std::string::npos ? std::string::npos : request.find_first_of(" ?", start + 1);
+    _uri = end == std::string::npos ? "/" : request.substr(start + 1, end - start - 1);
+    _headers.clear();
+    _contentLength = CONTENT_LENGTH_UNKNOWN;
+
+    THandlerFunction handler = _notFound;
+    for (const auto& h : _handlers) {
+        if (h.first == _uri) handler = h.second;
+    }
+    if (handler) handler();
+    else send(404, "text/plain", "Not found");
+
+    close(_clientFd);
+    _clientFd = -1;
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+    std::string line = std::string(name.c_str()) + ": " + value.c_str() + "\r\n";
+    _headers = first ? line + _headers : _headers + line;
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+    if (_clientFd < 0) return;
+    std::string head = "HTTP/1.0 " + std::to_string(code) + "\r\n";
+    if (contentType) head += std::string("Content-Type: ") + contentType + "\r\n";
+    size_t length = _contentLength != CONTENT_LENGTH_UNKNOWN ? _contentLength : content.length();
+    if (_contentLength != CONTENT_LENGTH_UNKNOWN || content.length()) {
+        head += "Content-Length: " + std::to_string(length) + "\r\n";
+    }
+    head += _headers + "Connection: close\r\n\r\n";
+    writeAll(_clientFd, head.data(), head.size());
+    sendContent(content);
+}
+
+void WebServer::sendContent(const char* content, size_t length) {
+    if (_clientFd >= 0 && length) writeAll(_clientFd, content, length);
+}
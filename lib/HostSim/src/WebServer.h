@@ -0,0 +1,42 @@
+#pragma once
+// The ESP32 core's WebServer on a host TCP socket. Device ports below 1024 are
+// moved up by 8000 (80 -> 8080) unless SIM_WEB_PORT says otherwise. One request
+// per connection, answered as HTTP/1.0 with Connection: close.
+#include "WString.h"
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+
+class WebServer {
+public:
+    typedef std::function<void()> THandlerFunction;
+
+    explicit WebServer(int port = 80) : _port(port) {}
+    ~WebServer() { stop(); }
+
+    void begin();
+    void stop();
+    void handleClient();
+    void on(const String& uri, THandlerFunction handler) { _handlers.emplace_back(uri.c_str(), handler); }
+    void onNotFound(THandlerFunction handler) { _notFound = handler; }
+
+    String uri() const { return String(_uri.c_str()); }
+    void setContentLength(size_t length) { _contentLength = length; }
+    void sendHeader(const String& name, const String& value, bool first = false);
+    void send(int code, const char* contentType = nullptr, const String& content = String());
+    void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+    void sendContent(const char* content, size_t length);
+
+private:
+    int _port;
+    int _listenFd = -1;
+    int _clientFd = -1;
+    std::string _uri;
+    std::string _headers;
+    size_t _contentLength = CONTENT_LENGTH_UNKNOWN;
+    std::vector<std::pair<std::string, THandlerFunction>> _handlers;
+    THandlerFunction _notFound;
+};
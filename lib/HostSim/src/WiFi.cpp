@@ -0,0 +1,253 @@
+#include "WiFi.h"
+#include "HTTPClient.h"
+#include "HostSim.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+
+WiFiClass WiFi;
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _bytes[0], _bytes[1], _bytes[2], _bytes[3]);
+    return String(buf);
+}
+
+// ---- WiFiClient ----
+
+struct SimSocket {
+    int fd = -1;
+    bool eof = false;
+    std::string buffer;
+    size_t head = 0;
+    ~SimSocket() {
+        if (fd >= 0) close(fd);
+    }
+    size_t buffered() const { return buffer.size() - head; }
+};
+
+static int hostWaitMs(unsigned long simMs) {
+    return (int)(simMs / HostSim::timeScale()) + 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    return connect(host, port, 5000);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+    stop();
+    struct addrinfo hints = {}, *result = nullptr;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if (getaddrinfo(host, service, &hints, &result) != 0 || !result) return 0;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    int rc = ::connect(fd, result->ai_addr, result->ai_addrlen);
+    freeaddrinfo(result);
+    if (rc != 0 && errno == EINPROGRESS) {
+        struct pollfd pfd = {fd, POLLOUT, 0};
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (poll(&pfd, 1, hostWaitMs(timeoutMs)) == 1 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && !err) {
+            rc = 0;
+        }
+    }
+    if (rc != 0) {
+        close(fd);
+        return 0;
+    }
+    fcntl(fd, F_SETFL, flags);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    _socket = std::make_shared<SimSocket>();
+    _socket->fd = fd;
+    return 1;
+}
+
+bool WiFiClient::connected() {
+    if (!_socket) return false;
+    if (_socket->buffered()) return true;
+    fill(0);
+    return !_socket->eof || _socket->buffered();
+}
+
+void WiFiClient::stop() {
+    _socket.reset();
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+    if (!_socket) return 0;
+    size_t sent = 0;
+    while (sent < size) {
+        ssize_t n = send(_socket->fd, buffer + sent, size - sent, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += n;
+    }
+    return sent;
+}
+
+// Pulls whatever the socket has, waiting up to waitMs (simulated) for the first byte
+bool WiFiClient::fill(int waitMs) {
+    if (!_socket || _socket->eof) return false;
+    struct pollfd pfd = {_socket->fd, POLLIN, 0};
+    if (poll(&pfd, 1, waitMs ? hostWaitMs(waitMs) : 0) != 1) return false;
+    char chunk[4096];
+    ssize_t n = recv(_socket->fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+    if (n <= 0) {
+        _socket->eof = true;
+        return false;
+    }
+    if (_socket->head == _socket->buffer.size()) {
+        _socket->buffer.clear();
+        _socket->head = 0;
+    }
+    _socket->buffer.append(chunk, n);
+    return true;
+}
+
+int WiFiClient::available() {
+    if (!_socket) return 0;
+    if (!_socket->buffered()) fill(0);
+    return (int)_socket->buffered();
+}
+
+int WiFiClient::read() {
+    if (!available()) return -1;
+    return (uint8_t)_socket->buffer[_socket->head++];
+}
+
+int WiFiClient::peek() {
+    if (!available()) return -1;
+    return (uint8_t)_socket->buffer[_socket->head];
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    size_t n = std::min((size_t)available(), size);
+    if (n) memcpy(buffer, _socket->buffer.data() + _socket->head, n);
+    if (_socket) _socket->head += n;
+    return (int)n;
+}
+
+size_t WiFiClient::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    unsigned long start = millis();
+    while (count < length && _socket) {
+        if (!_socket->buffered() && !fill(_timeout)) {
+            if (_socket->eof || millis() - start >= _timeout) break;
+            continue;
+        }
+        size_t n = std::min(_socket->buffered(), length - count);
+        memcpy(buffer + count, _socket->buffer.data() + _socket->head, n);
+        _socket->head += n;
+        count += n;
+    }
+    return count;
+}
+
+// ---- HTTPClient ----
+
+bool HTTPClient::begin(const String& url) {
+    std::string u = url.c_str();
+    size_t scheme = u.find("://");
+    if (scheme == std::string::npos) return false;
+    size_t pathStart = u.find('/', scheme + 3);
+    _host = u.substr(scheme + 3, pathStart == std::string::npos ? std::string::npos : pathStart - scheme - 3);
+    _path = pathStart == std::string::npos ? "/" : u.substr(pathStart);
+    _requestHeaders.clear();
+    _size = -1;
+    for (auto& h : _collected) h.second.clear();
+    return !_host.empty();
+}
+
+void HTTPClient::end() {
+    _client.stop();
+    _requestHeaders.clear();
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+    _requestHeaders += std::string(name.c_str()) + ": " + value.c_str() + "\r\n";
+}
+
+void HTTPClient::collectHeaders(const char* headerKeys[], size_t count) {
+    _collected.clear();
+    for (size_t i = 0; i < count; i++) _collected.emplace_back(headerKeys[i], "");
+}
+
+String HTTPClient::header(const char* name) const {
+    for (const auto& h : _collected) {
+        if (strcasecmp(h.first.c_str(), name) == 0) return String(h.second);
+    }
+    return String();
+}
+
+bool HTTPClient::readLine(std::string& line) {
+    line.clear();
+    char c;
+    while (_client.readBytes(&c, 1) == 1) {
+        if (c == '\n') return true;
+        if (c != '\r') line += c;
+    }
+    return false;
+}
+
+int HTTPClient::GET() {
+    _client.setTimeout(_timeout);
+    if (!_client.connect(HostSim::httpHost().c_str(), HostSim::httpPort(), _connectTimeout)) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    std::string request = "GET " + _path + " HTTP/1.0\r\nHost: " + _host +
+                          "\r\nUser-Agent: ESP32HTTPClient\r\nConnection: close\r\n" + _requestHeaders + "\r\n";
+    if (_client.write((const uint8_t*)request.data(), request.size()) != request.size()) {
+        return HTTPC_ERROR_SEND_HEADER_FAILED;
+    }
+
+    std::string line;
+    if (!readLine(line) || line.compare(0, 5, "HTTP/") != 0) return HTTPC_ERROR_READ_TIMEOUT;
+    int code = atoi(line.c_str() + line.find(' '));
+    while (readLine(line) && !line.empty()) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = line.substr(0, colon);
+        size_t valueStart = line.find_first_not_of(' ', colon + 1);
+        std::string value = valueStart == std::string::npos ? "" : line.substr(valueStart);
+        if (strcasecmp(name.c_str(), "Content-Length") == 0) _size = atoi(value.c_str());
+        for (auto& h : _collected) {
+            if (strcasecmp(h.first.c_str(), name.c_str()) == 0) h.second = value;
+        }
+    }
+    return code;
+}
+
+String HTTPClient::getString() {
+    std::string body;
+    char buf[1024];
+    while (_size < 0 || (int)body.size() < _size) {
+        size_t want = _size < 0 ? sizeof(buf) : std::min(sizeof(buf), (size_t)_size - body.size());
+        size_t n = _client.readBytes(buf, want);
+        if (!n) break;
+        body.append(buf, n);
+    }
+    return String(body);
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+        case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+        case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+        case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+        case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+        case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+        default: return String();
+    }
+}
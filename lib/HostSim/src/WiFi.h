@@ -0,0 +1,64 @@
+#pragma once
+// The station is always connected; sockets are host TCP sockets
+#include "Arduino.h"
+#include <memory>
+
+#define WL_IDLE_STATUS 0
+#define WL_DISCONNECTED 6
+#define WL_CONNECTED 3
+#define WIFI_STA 1
+#define WIFI_AP 2
+#define WIFI_AP_STA 3
+
+class IPAddress {
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : _bytes{a, b, c, d} {}
+    String toString() const;
+    operator String() const { return toString(); }
+    uint8_t operator[](int i) const { return _bytes[i]; }
+
+private:
+    uint8_t _bytes[4];
+};
+
+struct SimSocket;
+
+class WiFiClient : public Stream {
+public:
+    int connect(const char* host, uint16_t port);
+    int connect(const char* host, uint16_t port, int32_t timeoutMs);
+    bool connected();
+    void stop();
+    operator bool() { return connected(); }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    int read(uint8_t* buffer, size_t size);   // Whatever is buffered, without waiting
+    size_t readBytes(char* buffer, size_t length) override;
+    using Stream::readBytes;
+
+private:
+    std::shared_ptr<SimSocket> _socket;
+    bool fill(int waitMs);
+};
+
+class WiFiClass {
+public:
+    int begin(const char* ssid = nullptr, const char* password = nullptr) { (void)ssid; (void)password; return WL_CONNECTED; }
+    int status() { return WL_CONNECTED; }
+    bool isConnected() { return true; }
+    bool disconnect(bool wifiOff = false) { (void)wifiOff; return true; }
+    bool mode(int m) { (void)m; return true; }
+    bool setSleep(bool enabled) { (void)enabled; return true; }
+    String SSID() { return "sim"; }
+    int8_t RSSI() { return -55; }
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+    String macAddress() { return "02:00:00:00:00:01"; }
+};
+
+extern WiFiClass WiFi;
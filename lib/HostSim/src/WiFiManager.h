@@ -0,0 +1,17 @@
+#pragma once
+// No captive portal on the host: the station is always connected
+#include "WiFi.h"
+
+class WiFiManager {
+public:
+    void setDebugOutput(bool debug) { (void)debug; }
+    void setConfigPortalTimeout(unsigned long seconds) { (void)seconds; }
+    void resetSettings() {}
+    bool autoConnect() { return true; }
+    bool autoConnect(const char* apName, const char* apPassword = nullptr) { (void)apName; (void)apPassword; return true; }
+    bool startConfigPortal(const char* apName, const char* apPassword = nullptr) {
+        Serial.printf("📶 [sim] config portal '%s' skipped\n", apName);
+        (void)apPassword;
+        return true;
+    }
+};
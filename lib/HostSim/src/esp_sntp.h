@@ -0,0 +1,14 @@
+#pragma once
+// SNTP without a network: a "sync" just reports the host clock, shortly after
+// configTime() and then every sync interval
+#include <stdint.h>
+#include <sys/time.h>
+
+typedef void (*sntp_sync_time_cb_t)(struct timeval* tv);
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback);
+void sntp_set_sync_interval(uint32_t intervalMs);
+uint32_t sntp_get_sync_interval();
+bool sntp_restart();
+bool sntp_enabled();
+void sntp_stop();
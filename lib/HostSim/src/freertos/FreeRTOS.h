@@ -0,0 +1,34 @@
+#pragma once
+// FreeRTOS on host threads: tasks are std::threads, queues and semaphores share one
+// mutex/condvar queue, one tick is one simulated millisecond.
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void (*TaskFunction_t)(void*);
+typedef struct SimTask* TaskHandle_t;
+typedef struct SimQueue* QueueHandle_t;
+typedef struct SimQueue* SemaphoreHandle_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define errQUEUE_FULL 0
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+void hostSimEnterCritical();
+void hostSimExitCritical();
+#define portENTER_CRITICAL(mux) ((void)(mux), hostSimEnterCritical())
+#define portEXIT_CRITICAL(mux) ((void)(mux), hostSimExitCritical())
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
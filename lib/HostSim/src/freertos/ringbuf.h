@@ -0,0 +1,10 @@
+#pragma once
+#include "FreeRTOS.h"
+
+// No-split ring buffer: each send is received as one item
+typedef struct SimRingbuf* RingbufHandle_t;
+
+RingbufHandle_t xRingbufferCreate(size_t size, int type);
+BaseType_t xRingbufferSend(RingbufHandle_t ring, const void* data, size_t size, TickType_t ticksToWait);
+void* xRingbufferReceive(RingbufHandle_t ring, size_t* size, TickType_t ticksToWait);
+void vRingbufferReturnItem(RingbufHandle_t ring, void* item);
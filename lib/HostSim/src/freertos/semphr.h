@@ -0,0 +1,12 @@
+#pragma once
+#include "queue.h"
+
+// Semaphores are zero-size queues, as in FreeRTOS itself
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount);
+#define vSemaphoreDelete(sem) vQueueDelete(sem)
+#define xSemaphoreTake(sem, ticks) xQueueReceive((sem), nullptr, (ticks))
+#define xSemaphoreGive(sem) xQueueSend((sem), nullptr, 0)
+#define xSemaphoreGiveFromISR(sem, woken) xQueueSendFromISR((sem), nullptr, (woken))
+#define uxSemaphoreGetCount(sem) uxQueueMessagesWaiting(sem)
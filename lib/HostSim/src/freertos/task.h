@@ -0,0 +1,14 @@
+#pragma once
+#include "FreeRTOS.h"
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+#define xTaskCreate(function, name, stackDepth, arg, priority, handle) \
+    xTaskCreatePinnedToCore(function, name, stackDepth, arg, priority, handle, tskNO_AFFINITY)
+void vTaskDelete(TaskHandle_t task);   // Only the calling task can delete itself
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t increment);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+const char* pcTaskGetName(TaskHandle_t task);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);   // Host stacks are not measured: reports the depth
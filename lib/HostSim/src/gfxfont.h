@@ -0,0 +1,20 @@
+#pragma once
+// Same layout as Adafruit GFX's gfxfont.h
+#include <stdint.h>
+
+typedef struct {
+    uint16_t bitmapOffset;
+    uint8_t width;
+    uint8_t height;
+    uint8_t xAdvance;
+    int8_t xOffset;
+    int8_t yOffset;
+} GFXglyph;
+
+typedef struct {
+    uint8_t* bitmap;    // nullptr in the simulator's placeholder fonts: glyphs draw as boxes
+    GFXglyph* glyph;
+    uint16_t first;
+    uint16_t last;
+    uint8_t yAdvance;
+} GFXfont;
@@ -2,128 +2,84 @@
 #include "DisplayManager.h"
 #include <SPIFFS.h>
 #include <WiFi.h>
-#include <HTTPClient.h>
+#include "PageDownload.h"
+#include "BMPHandler.h"
+#include "HeapTelemetry.h"
+#include "RefreshArena.h"
 
-const char* FullScreenManager::FULLSCREEN_BMP_URL = "http://192.168.1.4:3000/image_800x480.bmp";
+const char* FullScreenManager::FULLSCREEN_BMP_URL = FULLSCREEN_BMP_URL_DEFAULT;
 
-// BMP header structure
-struct BMPHeader {
-    uint16_t signature;
-    uint32_t fileSize;
-    uint32_t reserved;
-    uint32_t dataOffset;
-    uint32_t headerSize;
-    int32_t width;
-    int32_t height;
-    uint16_t planes;
-    uint16_t bitsPerPixel;
-} __attribute__((packed));
+bool FullScreenManager::downloadFullScreenBMP(const char* url) {
+    if (!url) url = FULLSCREEN_BMP_URL;
 
-void FullScreenManager::downloadFullScreenBMP() {
     Serial.println("\n=== Downloading Full Screen Image ===");
-    Serial.printf("🔗 URL: %s\n", FULLSCREEN_BMP_URL);
-    
-    HTTPClient http;
-    http.setTimeout(15000);
-    
-    if (!http.begin(FULLSCREEN_BMP_URL)) {
-        Serial.println("❌ Failed to begin HTTP request");
-        return;
-    }
-    
-    Serial.println("📡 Sending GET request...");
-    int httpCode = http.GET();
-    Serial.printf("📡 Response Code: %d\n", httpCode);
-    
-    if (httpCode != HTTP_CODE_OK) {
-        Serial.printf("❌ HTTP Error: %d\n", httpCode);
-        http.end();
-        return;
-    }
-    
-    int contentLength = http.getSize();
-    Serial.printf("📄 Content Length: %d bytes (%.1f KB)\n", 
-                 contentLength, contentLength/1024.0);
-    
-    // Remove old file
-    if (SPIFFS.exists("/fullscreen.bmp")) {
-        SPIFFS.remove("/fullscreen.bmp");
-    }
-    
-    // Create new file
-    File file = SPIFFS.open("/fullscreen.bmp", "w");
-    if (!file) {
-        Serial.println("❌ Failed to create file");
-        http.end();
-        return;
-    }
-    
-    // Download
-    WiFiClient* stream = http.getStreamPtr();
-    uint8_t buf[1024];
-    size_t totalBytes = 0;
-    
-    Serial.println("⬇️ Downloading...");
-    while (http.connected() && (contentLength <= 0 || totalBytes < contentLength)) {
-        size_t available = stream->available();
-        if (available) {
-            size_t readBytes = stream->readBytes(buf, min(sizeof(buf), available));
-            if (readBytes == 0) break;
-            
-            file.write(buf, readBytes);
-            totalBytes += readBytes;
-            
-            // Progress
-            if (contentLength > 0) {
-                int progress = (totalBytes * 100) / contentLength;
-                if (progress % 25 == 0) {
-                    Serial.printf("⬇️ Progress: %d%%\n", progress);
-                }
-            }
-        } else {
-            delay(10);
-        }
-    }
-    
-    file.close();
-    http.end();
-    
-    Serial.printf("✅ Downloaded: %u bytes\n", totalBytes);
+    return downloadToFile(url, FULLSCREEN_BMP_PATH);
 }
 
 void FullScreenManager::displayFullScreen() {
     Serial.println("\n=== Displaying Full Screen Image (Page 5) ===");
     Serial.println("Using full display area (800x480)");
     
+    FrameHasher hasher("fullscreen");
+    hashFile(hasher, FULLSCREEN_BMP_PATH);
+    if (!beginFrame(hasher.value(), "Full screen page")) return;
+    
+    bool drawn = true;
     display.setFullWindow();
     display.firstPage();
     do {
         display.fillScreen(GxEPD_WHITE);
         
-        if (SPIFFS.exists("/fullscreen.bmp")) {
-            drawBMPFromFile("/fullscreen.bmp");
+        if (SPIFFS.exists(FULLSCREEN_BMP_PATH)) {
+            drawn = drawBMPFromFile(FULLSCREEN_BMP_PATH) && drawn;
         } else {
             display.setTextColor(GxEPD_BLACK);
             display.setCursor(10, 30);
             display.print("Full screen image not available");
         }
     } while (display.nextPage());
+    if (drawn) commitFrame();
+    else invalidateFrame();   // A page bailed out part way
     
     Serial.println("✅ Full screen image displayed!");
 }
 
-void FullScreenManager::drawBMPFromFile(const char* filename) {
+void FullScreenManager::displayFullScreenRegion(int16_t x, int16_t y, int16_t w, int16_t h) {
+    Serial.printf("\n=== Partial Full Screen Refresh: %d,%d %dx%d ===\n", x, y, w, h);
+    // The region refresh leaves the panel showing the full page, so elide against that
+    FrameHasher hasher("fullscreen");
+    hashFile(hasher, FULLSCREEN_BMP_PATH);
+    if (!beginFrame(hasher.value(), "Full screen page")) return;
+    
+    unsigned long startTime = millis();
+    
+    // Only the changed window is transferred and refreshed
+    display.setPartialWindow(x, y, w, h);
+    bool drawn = true;
+    display.firstPage();
+    do {
+        display.fillScreen(GxEPD_WHITE);
+        drawn = drawBMPFromFile(FULLSCREEN_BMP_PATH, y, y + h - 1) && drawn;
+    } while (display.nextPage());
+    if (drawn) commitFrame();
+    else invalidateFrame();
+    
+    Serial.printf("✅ Partial refresh done in %lu ms\n", millis() - startTime);
+}
+
+bool FullScreenManager::drawBMPFromFile(const char* filename, int16_t rowFrom, int16_t rowTo) {
+    HeapScope heapScope(HEAP_DISPLAY);
     File file = SPIFFS.open(filename, "r");
     if (!file) {
         Serial.println("❌ Failed to open BMP file");
-        return;
+        return false;
     }
     
     BMPHeader header;
     if (file.size() < sizeof(BMPHeader)) {
         Serial.println("❌ Invalid BMP file size");
         file.close();
-        return;
+        return false;
     }
     
     file.read((uint8_t*)&header, sizeof(BMPHeader));
@@ -131,7 +87,7 @@ void FullScreenManager::drawBMPFromFile(const char* filename) {
     if (header.signature != 0x4D42) {
         Serial.printf("❌ Invalid BMP signature: 0x%04X\n", header.signature);
         file.close();
-        return;
+        return false;
     }
     
     Serial.printf("🖼️ BMP: %dx%d, %d-bit\n", 
@@ -143,35 +99,34 @@ void FullScreenManager::drawBMPFromFile(const char* filename) {
                      header.width, header.height);
     }
     
-    // Seek to image data
-    file.seek(header.dataOffset);
-    
     // Calculate row size (padded to 4 bytes)
-    int rowSize = ((header.width * header.bitsPerPixel + 31) / 32) * 4;
-    uint8_t* rowBuffer = (uint8_t*)malloc(rowSize);
+    int rowSize = bmpRowSize(header);
+    ArenaScope arena("Page draw", ArenaBudget::PAGE_DRAW);
+    uint8_t* rowBuffer = (uint8_t*)RefreshArena::alloc(rowSize);
     
     if (!rowBuffer) {
-        Serial.println("❌ Memory allocation failed");
+        Serial.println("❌ BMP row does not fit the refresh arena");
         file.close();
-        return;
+        return false;
     }
     
-    // Draw BMP (bottom-to-top)
-    for (int y = header.height - 1; y >= 0; y--) {
-        file.read(rowBuffer, rowSize);
+    // Draw BMP (bottom-to-top), only rows rowFrom..rowTo
+    if (rowFrom < 0) rowFrom = 0;
+    if (rowTo < 0 || rowTo >= header.height) rowTo = header.height - 1;
+    file.seek(header.dataOffset + (uint32_t)(header.height - 1 - rowTo) * rowSize);
+    
+    for (int y = rowTo; y >= rowFrom; y--) {
+        if (file.read(rowBuffer, rowSize) != (size_t)rowSize) {
+            Serial.printf("❌ BMP truncated at row %d\n", y);
+            file.close();
+            return false;
+        }
         
-        for (int x = 0; x < header.width; x++) {
-            if (header.bitsPerPixel == 1) {
-                int byteIndex = x / 8;
-                int bitIndex = 7 - (x % 8);
-                bool pixel = (rowBuffer[byteIndex] >> bitIndex) & 1;
-                
-                uint16_t color = pixel ? GxEPD_WHITE : GxEPD_BLACK;
-                display.drawPixel(x, y, color);
-            }
+        if (header.bitsPerPixel == 1) {
+            bmpDrawRow1(display, rowBuffer, header.width, y);
         }
     }
     
-    free(rowBuffer);
     file.close();
+    return true;
 }
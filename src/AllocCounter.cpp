@@ -0,0 +1,50 @@
+#include "AllocCounter.h"
+#include "HeapTelemetry.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static volatile uint32_t totalAllocs = 0;
+static volatile uint32_t trackedAllocs = 0;
+static volatile TaskHandle_t trackedTask = nullptr;
+
+// Called from inside the allocator: no logging, no allocation, no locks
+static inline void countAlloc(size_t size) {
+    totalAllocs++;
+    HeapTelemetry::recordAlloc(size);
+    if (trackedTask && xTaskGetCurrentTaskHandle() == trackedTask) trackedAllocs++;
+}
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    countAlloc(size);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    countAlloc(n * size);
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    countAlloc(size);
+    return __real_realloc(ptr, size);
+}
+}
+
+void AllocCounter::begin() {
+    trackedAllocs = 0;
+    trackedTask = xTaskGetCurrentTaskHandle();
+}
+
+uint32_t AllocCounter::end() {
+    trackedTask = nullptr;
+    return trackedAllocs;
+}
+
+uint32_t AllocCounter::total() {
+    return totalAllocs;
+}
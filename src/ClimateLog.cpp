@@ -0,0 +1,345 @@
+#include "ClimateLog.h"
+#include "Config.h"
+#include "DHT22.h"
+#include "HeapTelemetry.h"
+#include <SPIFFS.h>
+
+static const uint32_t CLIMATE_MAGIC = 0x434C4D31;   // "CLM1"
+static const char* const CLIMATE_PATH = "/climate.dat";
+
+static const uint8_t HOUR_PAGES = 24;
+static const uint8_t MINUTES_PER_PAGE = 60;
+static const uint16_t QUARTER_S = 900;
+static const uint16_t QUARTERS_KEPT = 30 * 96;      // 30 days
+static const uint8_t QUARTERS_PER_FLUSH = 16;       // 4 h per flash write
+static const int8_t NO_SAMPLE = INT8_MIN;
+static const int8_t MAX_DELTA = INT8_MAX;           // 12.7 units per minute; larger jumps are clamped
+
+// Values are tenths of °C / %RH, the DHT22's resolution
+struct ClimateSummary {
+    int16_t minTemp, maxTemp;
+    uint16_t minHumidity, maxHumidity;
+    int32_t sumTemp;
+    uint32_t sumHumidity;
+    uint16_t count;
+};
+
+struct ClimateHourPage {
+    uint32_t hour;                          // Epoch of the hour start, 0 = empty
+    int16_t firstTemp;                      // Keyframe: the page's first recorded minute
+    uint16_t firstHumidity;
+    int16_t lastTemp;                       // Decoded value the next delta is relative to
+    uint16_t lastHumidity;
+    int8_t tempDelta[MINUTES_PER_PAGE];     // NO_SAMPLE where a minute is missing
+    int8_t humidityDelta[MINUTES_PER_PAGE];
+    ClimateSummary summary;
+};
+
+// One closed quarter hour, as stored on flash
+struct ClimateRecord {
+    uint32_t start;                         // 0 = empty slot
+    int16_t minTemp, maxTemp, avgTemp;
+    uint16_t minHumidity, maxHumidity, avgHumidity;
+};
+
+struct ClimateState {
+    uint32_t magic;
+    ClimateHourPage pages[HOUR_PAGES];
+    uint32_t quarterStart;                  // Open quarter hour, folded from minute averages
+    ClimateSummary quarter;
+    ClimateRecord pending[QUARTERS_PER_FLUSH];
+    uint8_t pendingCount;
+    uint32_t minuteStart;                   // Open minute, folded from raw samples
+    int32_t minuteTempSum;
+    uint32_t minuteHumiditySum;
+    uint16_t minuteSamples;
+    uint32_t revision;
+};
+
+RTC_NOINIT_ATTR static ClimateState state;
+
+static uint32_t lastSampleMs = 0;
+static bool fileReady = false;
+static uint32_t flashWrites = 0;
+
+static void resetSummary(ClimateSummary& s) {
+    s.minTemp = INT16_MAX;
+    s.maxTemp = INT16_MIN;
+    s.minHumidity = UINT16_MAX;
+    s.maxHumidity = 0;
+    s.sumTemp = 0;
+    s.sumHumidity = 0;
+    s.count = 0;
+}
+
+static void fold(ClimateSummary& s, int16_t temp, uint16_t humidity) {
+    if (temp < s.minTemp) s.minTemp = temp;
+    if (temp > s.maxTemp) s.maxTemp = temp;
+    if (humidity < s.minHumidity) s.minHumidity = humidity;
+    if (humidity > s.maxHumidity) s.maxHumidity = humidity;
+    s.sumTemp += temp;
+    s.sumHumidity += humidity;
+    s.count++;
+}
+
+static void toBucket(const ClimateSummary& s, time_t start, ClimateBucket& bucket) {
+    bucket.start = start;
+    bucket.minTemp = s.minTemp / 10.0f;
+    bucket.maxTemp = s.maxTemp / 10.0f;
+    bucket.avgTemp = s.sumTemp / 10.0f / s.count;
+    bucket.minHumidity = s.minHumidity / 10.0f;
+    bucket.maxHumidity = s.maxHumidity / 10.0f;
+    bucket.avgHumidity = s.sumHumidity / 10.0f / s.count;
+}
+
+static int8_t clampDelta(int32_t delta) {
+    return delta > MAX_DELTA ? MAX_DELTA : delta < -MAX_DELTA ? -MAX_DELTA : delta;
+}
+
+static void flushPending() {
+    if (state.pendingCount == 0 || !fileReady) return;
+    HeapScope heapScope(HEAP_STORAGE);
+
+    File file = SPIFFS.open(CLIMATE_PATH, "r+");
+    if (!file) return;
+
+    // Records are usually consecutive slots: write each run in one go
+    uint8_t i = 0;
+    while (i < state.pendingCount) {
+        uint16_t slot = (state.pending[i].start / QUARTER_S) % QUARTERS_KEPT;
+        uint8_t run = 1;
+        while (i + run < state.pendingCount && slot + run < QUARTERS_KEPT &&
+               (state.pending[i + run].start / QUARTER_S) % QUARTERS_KEPT == slot + run) {
+            run++;
+        }
+        file.seek(slot * sizeof(ClimateRecord));
+        file.write((const uint8_t*)&state.pending[i], run * sizeof(ClimateRecord));
+        flashWrites++;
+        i += run;
+    }
+    file.close();
+    state.pendingCount = 0;
+}
+
+static void closeQuarter() {
+    if (state.quarter.count == 0) return;
+    if (state.pendingCount == QUARTERS_PER_FLUSH) {
+        flushPending();
+        if (state.pendingCount == QUARTERS_PER_FLUSH) return;   // No flash: drop quarters until it is back
+    }
+    ClimateRecord& r = state.pending[state.pendingCount++];
+    r.start = state.quarterStart;
+    r.minTemp = state.quarter.minTemp;
+    r.maxTemp = state.quarter.maxTemp;
+    r.avgTemp = state.quarter.sumTemp / state.quarter.count;
+    r.minHumidity = state.quarter.minHumidity;
+    r.maxHumidity = state.quarter.maxHumidity;
+    r.avgHumidity = state.quarter.sumHumidity / state.quarter.count;
+    if (state.pendingCount == QUARTERS_PER_FLUSH) flushPending();
+}
+
+static void addMinute(uint32_t minute, int16_t temp, uint16_t humidity) {
+    uint32_t hour = minute - minute % 3600;
+    ClimateHourPage& page = state.pages[(hour / 3600) % HOUR_PAGES];
+    if (page.hour != hour) {
+        page.hour = hour;
+        memset(page.tempDelta, NO_SAMPLE, sizeof(page.tempDelta));
+        memset(page.humidityDelta, NO_SAMPLE, sizeof(page.humidityDelta));
+        resetSummary(page.summary);
+        state.revision++;
+    }
+
+    uint8_t index = (minute % 3600) / 60;
+    if (page.tempDelta[index] != NO_SAMPLE) return;
+    if (page.summary.count == 0) {
+        page.firstTemp = page.lastTemp = temp;
+        page.firstHumidity = page.lastHumidity = humidity;
+        page.tempDelta[index] = 0;
+        page.humidityDelta[index] = 0;
+    } else {
+        // Summaries track the decoded values so queries agree with the deltas
+        page.tempDelta[index] = clampDelta(temp - page.lastTemp);
+        page.humidityDelta[index] = clampDelta((int32_t)humidity - page.lastHumidity);
+        page.lastTemp += page.tempDelta[index];
+        page.lastHumidity += page.humidityDelta[index];
+    }
+    fold(page.summary, page.lastTemp, page.lastHumidity);
+
+    uint32_t quarterStart = minute - minute % QUARTER_S;
+    if (quarterStart != state.quarterStart) {
+        closeQuarter();
+        state.quarterStart = quarterStart;
+        resetSummary(state.quarter);
+    }
+    fold(state.quarter, page.lastTemp, page.lastHumidity);
+}
+
+void ClimateLog::begin() {
+    if (state.magic != CLIMATE_MAGIC) {
+        memset(&state, 0, sizeof(state));
+        resetSummary(state.quarter);
+        state.magic = CLIMATE_MAGIC;
+    }
+
+    // Preallocate the 30-day ring once so every record has a fixed offset
+    HeapScope heapScope(HEAP_STORAGE);
+    const size_t fileSize = (size_t)QUARTERS_KEPT * sizeof(ClimateRecord);
+    File file = SPIFFS.open(CLIMATE_PATH, "r");
+    bool sized = file && file.size() == fileSize;
+    if (file) file.close();
+    if (!sized) {
+        file = SPIFFS.open(CLIMATE_PATH, "w");
+        if (!file) return;
+        uint8_t zeros[256] = {0};
+        for (size_t written = 0; written < fileSize; written += sizeof(zeros)) {
+            size_t n = fileSize - written < sizeof(zeros) ? fileSize - written : sizeof(zeros);
+            file.write(zeros, n);
+        }
+        file.close();
+        Serial.printf("📈 Created %s (%u bytes)\n", CLIMATE_PATH, (unsigned)fileSize);
+    }
+    fileReady = true;
+}
+
+void ClimateLog::poll() {
+    DhtSample sample;
+    if (!DHT22Manager::getLatest(sample) || sample.atMs == lastSampleMs) return;
+    lastSampleMs = sample.atMs;
+
+    time_t now = time(nullptr);
+    if (now < MIN_VALID_EPOCH) return;   // Buckets are wall-clock aligned
+
+    uint32_t minute = now - now % 60;
+    if (minute != state.minuteStart) {
+        if (state.minuteSamples) {
+            addMinute(state.minuteStart, state.minuteTempSum / state.minuteSamples,
+                      state.minuteHumiditySum / state.minuteSamples);
+        }
+        state.minuteStart = minute;
+        state.minuteTempSum = 0;
+        state.minuteHumiditySum = 0;
+        state.minuteSamples = 0;
+    }
+    state.minuteTempSum += lroundf(sample.temperature * 10.0f);
+    state.minuteHumiditySum += lroundf(sample.humidity * 10.0f);
+    state.minuteSamples++;
+}
+
+bool ClimateLog::getBucket(ClimateResolution resolution, uint16_t ago, ClimateBucket& bucket) {
+    bucket.start = 0;
+    time_t now = time(nullptr);
+    if (now < MIN_VALID_EPOCH || ago >= bucketCount(resolution)) return false;
+
+    switch (resolution) {
+        case CLIMATE_MINUTE: {
+            uint32_t minute = now - now % 60 - ago * 60UL;
+            if (minute == state.minuteStart) {
+                if (state.minuteSamples == 0) return false;
+                ClimateSummary s;
+                resetSummary(s);
+                fold(s, state.minuteTempSum / state.minuteSamples, state.minuteHumiditySum / state.minuteSamples);
+                toBucket(s, minute, bucket);
+                return true;
+            }
+            uint32_t hour = minute - minute % 3600;
+            const ClimateHourPage& page = state.pages[(hour / 3600) % HOUR_PAGES];
+            uint8_t index = (minute % 3600) / 60;
+            if (page.hour != hour || page.tempDelta[index] == NO_SAMPLE) return false;
+
+            // Replay at most one page of deltas from the keyframe
+            int16_t temp = page.firstTemp;
+            uint16_t humidity = page.firstHumidity;
+            bool first = true;
+            for (uint8_t i = 0; i <= index; i++) {
+                if (page.tempDelta[i] == NO_SAMPLE) continue;
+                if (!first) {
+                    temp += page.tempDelta[i];
+                    humidity += page.humidityDelta[i];
+                }
+                first = false;
+            }
+            ClimateSummary s;
+            resetSummary(s);
+            fold(s, temp, humidity);
+            toBucket(s, minute, bucket);
+            return true;
+        }
+
+        case CLIMATE_HOUR: {
+            uint32_t hour = now - now % 3600 - ago * 3600UL;
+            const ClimateHourPage& page = state.pages[(hour / 3600) % HOUR_PAGES];
+            if (page.hour != hour || page.summary.count == 0) return false;
+            toBucket(page.summary, hour, bucket);
+            return true;
+        }
+
+        case CLIMATE_QUARTER_HOUR: {
+            uint32_t start = now - now % QUARTER_S - ago * (uint32_t)QUARTER_S;
+            if (start == state.quarterStart && state.quarter.count) {
+                toBucket(state.quarter, start, bucket);
+                return true;
+            }
+
+            ClimateRecord record = {};
+            for (uint8_t i = 0; i < state.pendingCount && !record.start; i++) {
+                if (state.pending[i].start == start) record = state.pending[i];
+            }
+            if (!record.start && fileReady) {
+                File file = SPIFFS.open(CLIMATE_PATH, "r");
+                if (file) {
+                    file.seek(((start / QUARTER_S) % QUARTERS_KEPT) * sizeof(ClimateRecord));
+                    if (file.read((uint8_t*)&record, sizeof(record)) != sizeof(record)) record.start = 0;
+                    file.close();
+                }
+            }
+            if (record.start != start) return false;   // Empty, or an older lap of the ring
+
+            bucket.start = start;
+            bucket.minTemp = record.minTemp / 10.0f;
+            bucket.maxTemp = record.maxTemp / 10.0f;
+            bucket.avgTemp = record.avgTemp / 10.0f;
+            bucket.minHumidity = record.minHumidity / 10.0f;
+            bucket.maxHumidity = record.maxHumidity / 10.0f;
+            bucket.avgHumidity = record.avgHumidity / 10.0f;
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+uint16_t ClimateLog::bucketCount(ClimateResolution resolution) {
+    switch (resolution) {
+        case CLIMATE_MINUTE:       return HOUR_PAGES * MINUTES_PER_PAGE;
+        case CLIMATE_HOUR:         return HOUR_PAGES;
+        case CLIMATE_QUARTER_HOUR: return QUARTERS_KEPT;
+        default:                   return 0;
+    }
+}
+
+uint32_t ClimateLog::revision() {
+    return state.revision;
+}
+
+void ClimateLog::printStats() {
+    ClimateBucket day = {};
+    ClimateBucket hour;
+    for (uint16_t ago = 0; ago < HOUR_PAGES; ago++) {
+        if (!getBucket(CLIMATE_HOUR, ago, hour)) continue;
+        if (!day.start || hour.minTemp < day.minTemp) day.minTemp = hour.minTemp;
+        if (!day.start || hour.maxTemp > day.maxTemp) day.maxTemp = hour.maxTemp;
+        day.start = hour.start;
+    }
+
+    Serial.println("\n=== Indoor Climate ===");
+    Serial.printf("Store: %u bytes RTC, %u bytes flash, %u quarter hours pending, %u flash writes\n",
+                  (unsigned)sizeof(state), (unsigned)(QUARTERS_KEPT * sizeof(ClimateRecord)),
+                  state.pendingCount, flashWrites);
+    if (day.start) {
+        Serial.printf("Last 24 h: %.1f..%.1f °C\n", day.minTemp, day.maxTemp);
+    } else {
+        Serial.println("Last 24 h: no data yet");
+    }
+    Serial.println("======================");
+}
@@ -0,0 +1,318 @@
+#include "ContentSync.h"
+#include "800x420.h"
+#include "800x480.h"
+#include "calender.h"
+#include "TileSync.h"
+#include "HeapTelemetry.h"
+#include "RefreshArena.h"
+#include "NetTrace.h"
+#include <ArduinoJson.h>
+#include <SPIFFS.h>
+
+ManifestEntry ContentSync::entrySlots[2][ContentSync::MAX_PAGES];
+ManifestEntry* ContentSync::entries = ContentSync::entrySlots[0];
+int ContentSync::entryCount = 0;
+bool ContentSync::manifestValid = false;
+String ContentSync::manifestETag;
+unsigned long ContentSync::manifestFetchedAt = 0;
+unsigned long ContentSync::manifestTtlMs = DEFAULT_MANIFEST_TTL_S * 1000UL;
+SyncStats ContentSync::stats = {0, 0, 0, 0, 0, 0};
+
+// Page id -> local SPIFFS copy
+struct PageBinding {
+    const char* id;
+    const char* path;
+    const char* defaultUrl;
+};
+
+static const PageBinding PAGE_BINDINGS[] = {
+    {"content",    CONTENT_BMP_PATH,    CONTENT_BMP_URL_DEFAULT},
+    {"calendar",   CALENDAR_BMP_PATH,   CALENDAR_BMP_URL_DEFAULT},
+    {"fullscreen", FULLSCREEN_BMP_PATH, FULLSCREEN_BMP_URL_DEFAULT},
+};
+
+static const PageBinding* findBinding(const char* id) {
+    for (const PageBinding& b : PAGE_BINDINGS) {
+        if (strcmp(b.id, id) == 0) return &b;
+    }
+    return nullptr;
+}
+
+bool ContentSync::fetchManifest() {
+    HeapScope heapScope(HEAP_HTTP);
+    Serial.printf("📜 Fetching manifest: %s\n", MANIFEST_URL);
+
+    TracedHTTPClient http;
+    http.setTimeout(10000);
+    if (!http.begin(MANIFEST_URL)) {
+        Serial.println("❌ Failed to begin manifest request");
+        return false;
+    }
+
+    const char* headerKeys[] = {"ETag"};
+    http.collectHeaders(headerKeys, 1);
+    if (manifestValid && manifestETag.length() > 0) {
+        http.addHeader("If-None-Match", manifestETag);
+    }
+
+    stats.requests++;
+    int httpCode = http.GET();
+    manifestFetchedAt = millis();
+
+    if (httpCode == HTTP_CODE_NOT_MODIFIED && manifestValid) {
+        stats.notModified++;
+        http.end();
+        Serial.println("📜 Manifest not modified");
+        return true;
+    }
+
+    if (httpCode != HTTP_CODE_OK) {
+        Serial.printf("⚠️ Manifest request failed, HTTP code: %d\n", httpCode);
+        http.end();
+        return false;
+    }
+
+    String payload = http.getString();
+    String etag = http.header("ETag");
+    http.end();
+    stats.bytes += payload.length();
+
+    if (!parseManifest(payload)) {
+        Serial.println("⚠️ Failed to parse manifest");
+        return false;
+    }
+
+    manifestETag = etag;
+    manifestValid = true;
+    Serial.printf("✅ Manifest loaded: %d pages, TTL %lus\n", entryCount, manifestTtlMs / 1000);
+    return true;
+}
+
+bool ContentSync::parseManifest(const String& payload) {
+    HeapScope heapScope(HEAP_JSON);
+    ArenaScope arena("Manifest", ArenaBudget::MANIFEST);
+    ArenaJsonDocument doc(ARENA_MANIFEST_JSON);
+    DeserializationError error = deserializeJson(doc, payload);
+    if (error) {
+        Serial.printf("⚠️ Manifest JSON parsing failed: %s\n", error.c_str());
+        return false;
+    }
+
+    JsonArray pages = doc["pages"];
+    if (pages.isNull()) {
+        Serial.println("⚠️ Manifest has no pages");
+        return false;
+    }
+
+    // Parse into the spare slot; the current entries stay in use until this one proves usable
+    ManifestEntry* parsed = (entries == entrySlots[0]) ? entrySlots[1] : entrySlots[0];
+    int parsedCount = 0;
+    for (JsonObject page : pages) {
+        if (parsedCount >= MAX_PAGES) {
+            Serial.println("⚠️ Manifest lists more pages than supported, ignoring the rest");
+            break;
+        }
+        ManifestEntry& e = parsed[parsedCount];
+        e.id = page["id"] | "";
+        e.url = page["url"] | "";
+        e.hash = page["hash"] | "";
+        e.size = page["size"] | 0;
+        e.format = page["format"] | "bmp1";
+        e.tiles = page["tiles"] | "";
+        e.ttl = page["ttl"] | DEFAULT_PAGE_TTL_S;
+        e.dwell = page["dwell"] | DEFAULT_PAGE_DWELL_S;
+        e.lastChecked = 0;
+        e.dirty = {0, 0, 0, 0};
+
+        if (e.id.length() == 0 || e.url.length() == 0) continue;
+        if (e.url.startsWith("/")) e.url = String(CONTENT_SERVER) + e.url;
+        if (e.tiles.startsWith("/")) e.tiles = String(CONTENT_SERVER) + e.tiles;
+
+        // Keep lastChecked for pages we already know so TTLs survive a manifest refresh
+        ManifestEntry* known = findEntry(e.id.c_str());
+        if (known) e.lastChecked = known->lastChecked;
+        parsedCount++;
+    }
+
+    if (parsedCount == 0) {
+        Serial.println("⚠️ Manifest lists no usable pages, keeping the previous one");
+        return false;
+    }
+
+    entries = parsed;
+    entryCount = parsedCount;
+    manifestTtlMs = (doc["ttl"] | DEFAULT_MANIFEST_TTL_S) * 1000UL;
+    return true;
+}
+
+ManifestEntry* ContentSync::findEntry(const char* id) {
+    for (int i = 0; i < entryCount; i++) {
+        if (entries[i].id == id) return &entries[i];
+    }
+    return nullptr;
+}
+
+const char* ContentSync::localPathFor(const char* id) {
+    const PageBinding* b = findBinding(id);
+    return b ? b->path : nullptr;
+}
+
+bool ContentSync::loadLocalHash(const char* id, String& hash) {
+    const char* path = localPathFor(id);
+    if (!path || !SPIFFS.exists(path)) return false;
+
+    String hashPath = String(path) + ".hash";
+    File f = SPIFFS.open(hashPath, "r");
+    if (!f) return false;
+    hash = f.readStringUntil('\n');
+    f.close();
+    return hash.length() > 0;
+}
+
+void ContentSync::clearLocalHash(const char* id) {
+    const char* path = localPathFor(id);
+    if (!path) return;
+
+    String hashPath = String(path) + ".hash";
+    if (SPIFFS.exists(hashPath)) SPIFFS.remove(hashPath.c_str());
+}
+
+void ContentSync::saveLocalHash(const char* id, const String& hash) {
+    HeapScope heapScope(HEAP_STORAGE);
+    const char* path = localPathFor(id);
+    if (!path) return;
+
+    String hashPath = String(path) + ".hash";
+    File f = SPIFFS.open(hashPath, "w");
+    if (!f) {
+        Serial.println("⚠️ Failed to store content hash");
+        return;
+    }
+    f.print(hash);
+    f.print('\n');
+    f.close();
+}
+
+bool ContentSync::downloadPage(const char* id, const char* url) {
+    HeapScope heapScope(HEAP_HTTP);
+    bool ok = false;
+    stats.requests++;
+
+    // The page managers replace the file in place, so drop the stale hash first;
+    // an interrupted download must never look like a cache hit afterwards.
+    const char* path = localPathFor(id);
+    clearLocalHash(id);
+
+    if (strcmp(id, "content") == 0) {
+        ok = ContentManager::downloadContentBMP(url);
+    } else if (strcmp(id, "calendar") == 0) {
+        ok = CalendarManager::downloadCalendarBMP(url);
+    } else if (strcmp(id, "fullscreen") == 0) {
+        ok = FullScreenManager::downloadFullScreenBMP(url);
+    } else {
+        Serial.printf("⚠️ No page bound to manifest id '%s'\n", id);
+        stats.requests--;
+        return false;
+    }
+
+    if (!ok) return false;
+
+    File f = SPIFFS.open(path, "r");
+    if (f) {
+        stats.bytes += f.size();
+        f.close();
+    }
+    stats.downloads++;
+    return true;
+}
+
+SyncResult ContentSync::syncPage(const char* id) {
+    const PageBinding* binding = findBinding(id);
+    if (!binding) {
+        Serial.printf("⚠️ Unknown page '%s'\n", id);
+        return SYNC_FAILED;
+    }
+
+    ManifestEntry* entry = manifestValid ? findEntry(id) : nullptr;
+    if (!entry) {
+        // No manifest (or page not listed): fetch the fixed URL unconditionally
+        return downloadPage(id, binding->defaultUrl) ? SYNC_UPDATED : SYNC_FAILED;
+    }
+
+    entry->lastChecked = millis();
+
+    String localHash;
+    if (entry->hash.length() > 0 && loadLocalHash(id, localHash) && localHash == entry->hash) {
+        stats.skipped++;
+        Serial.printf("📦 %s is up to date (hash %s), skipping download\n", id, localHash.c_str());
+        return SYNC_UNCHANGED;
+    }
+
+    // Small edits: patch only the changed tiles of the cached image
+    if (entry->tiles.length() > 0 && SPIFFS.exists(binding->path)) {
+        clearLocalHash(id);
+        SyncResult result = TileSync::syncTiles(binding->path, entry->tiles, entry->dirty, stats);
+        if (result != SYNC_FAILED) {
+            saveLocalHash(id, entry->hash);
+            return result;
+        }
+    }
+
+    entry->dirty = {0, 0, 0, 0};  // Empty = whole page
+    if (!downloadPage(id, entry->url.c_str())) {
+        return SYNC_FAILED;
+    }
+
+    File f = SPIFFS.open(binding->path, "r");
+    size_t localSize = f ? f.size() : 0;
+    if (f) f.close();
+    if (entry->size > 0 && localSize != entry->size) {
+        Serial.printf("⚠️ %s size mismatch: manifest %u, got %u bytes\n", id, entry->size, (unsigned)localSize);
+        return SYNC_FAILED;
+    }
+
+    if (entry->tiles.length() > 0) {
+        TileSync::storeTileHashes(binding->path, entry->tiles, stats);
+    }
+    saveLocalHash(id, entry->hash);
+    return SYNC_UPDATED;
+}
+
+bool ContentSync::hasManifest() {
+    return manifestValid;
+}
+
+unsigned long ContentSync::getDwellMs(const char* id) {
+    ManifestEntry* entry = manifestValid ? findEntry(id) : nullptr;
+    return (entry ? entry->dwell : DEFAULT_PAGE_DWELL_S) * 1000UL;
+}
+
+unsigned long ContentSync::getManifestTtlMs() {
+    return manifestTtlMs;
+}
+
+unsigned long ContentSync::getTtlMs(const char* id) {
+    ManifestEntry* entry = manifestValid ? findEntry(id) : nullptr;
+    return (entry ? entry->ttl : DEFAULT_PAGE_TTL_S) * 1000UL;
+}
+
+DirtyRect ContentSync::getDirtyRect(const char* id) {
+    ManifestEntry* entry = manifestValid ? findEntry(id) : nullptr;
+    return entry ? entry->dirty : DirtyRect{0, 0, 0, 0};
+}
+
+const SyncStats& ContentSync::getStats() {
+    return stats;
+}
+
+void ContentSync::printStats() {
+    float hours = millis() / 3600000.0f;
+    if (hours < 0.01f) hours = 0.01f;
+
+    Serial.println("\n=== Content Sync Stats ===");
+    Serial.printf("Mode: %s\n", USE_CONTENT_MANIFEST ? "manifest" : "fixed URLs");
+    Serial.printf("Requests: %u (%.1f/h), 304s: %u\n", stats.requests, stats.requests / hours, stats.notModified);
+    Serial.printf("Bytes: %u (%.1f KB/h)\n", stats.bytes, stats.bytes / 1024.0f / hours);
+    Serial.printf("Downloads: %u, tile patches: %u, cache hits: %u\n", stats.downloads, stats.tileUpdates, stats.skipped);
+    Serial.println("==========================");
+}
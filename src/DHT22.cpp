@@ -1,40 +1,174 @@
 #include "DHT22.h"
-#include "DHT.h"
+#include "DhtDecoder.h"
+#include "Config.h"
+#include <driver/gpio.h>
+#include <driver/rmt.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/ringbuf.h>
 
-DHT dht(DHT22Manager::DHT_PIN, DHT22);
+static const rmt_channel_t DHT_RMT_CHANNEL = RMT_CHANNEL_2;
+static const gpio_num_t DHT_GPIO = (gpio_num_t)DHT22Manager::DHT_PIN;
+static const uint16_t DHT_IDLE_US = 200;          // No edge this long = frame over (longest pulse is 80 us)
+static const uint8_t DHT_FILTER_TICKS = 100;      // APB cycles (1.25 us): glitch filter
+static const TickType_t DHT_REPLY_TIMEOUT = pdMS_TO_TICKS(20);   // A full frame takes ~5 ms
+static const size_t DHT_MAX_PULSES = 48;          // 40 bits + response + slack
 
-float DHT22Manager::temperature = 0.0;
-float DHT22Manager::humidity = 0.0;
-unsigned long DHT22Manager::lastReadTime = 0;
+// Datasheet measuring range; anything outside is a corrupted frame that passed the checksum
+static const float DHT_MIN_C = -40.0f;
+static const float DHT_MAX_C = 80.0f;
+static const uint8_t MEDIAN_WINDOW = 5;
+
+DhtSample DHT22Manager::ring[DHT22Manager::RING_SIZE];
+volatile uint32_t DHT22Manager::head = 0;
+
+static RingbufHandle_t rxRing = nullptr;
+
+// Producer-only state (the DHT task)
+static float rawTemperature[MEDIAN_WINDOW];
+static float rawHumidity[MEDIAN_WINDOW];
+static uint8_t rawCount = 0;
+static uint8_t rawNext = 0;
+static uint32_t framesOk = 0;
+static uint32_t framesFailed[4] = {0};            // Indexed by DhtDecodeResult
+static uint32_t framesOutOfRange = 0;
+
+static float median(const float* values, uint8_t count) {
+    float sorted[MEDIAN_WINDOW];
+    for (uint8_t i = 0; i < count; i++) {
+        float v = values[i];
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1] > v; j--) sorted[j] = sorted[j - 1];
+        sorted[j] = v;
+    }
+    return sorted[count / 2];
+}
 
 bool DHT22Manager::begin() {
-    dht.begin();
-    delay(2000);  // DHT22 requires 2s for initial reading
-    return update();
-}
-
-bool DHT22Manager::update() {
-    unsigned long currentTime = millis();
-    if (currentTime - lastReadTime >= READ_INTERVAL) {
-        float newTemp = dht.readTemperature();
-        float newHumid = dht.readHumidity();
-        
-        if (!isnan(newTemp) && !isnan(newHumid)) {
-            temperature = newTemp;
-            humidity = newHumid;
-            lastReadTime = currentTime;
-            return true;
+    rmt_config_t config = RMT_DEFAULT_CONFIG_RX(DHT_GPIO, DHT_RMT_CHANNEL);
+    config.clk_div = 80;                          // 1 us per tick
+    config.rx_config.filter_en = true;
+    config.rx_config.filter_ticks_thresh = DHT_FILTER_TICKS;
+    config.rx_config.idle_threshold = DHT_IDLE_US;
+    if (rmt_config(&config) != ESP_OK || rmt_driver_install(DHT_RMT_CHANNEL, 512, 0) != ESP_OK) {
+        return false;
+    }
+    rmt_get_ringbuf_handle(DHT_RMT_CHANNEL, &rxRing);
+
+    // Open drain with pull-up: the task pulls low for the start pulse, RMT keeps listening
+    gpio_set_pull_mode(DHT_GPIO, GPIO_PULLUP_ONLY);
+    gpio_set_direction(DHT_GPIO, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_level(DHT_GPIO, 1);
+
+    return xTaskCreatePinnedToCore(taskEntry, "dht22", 3072, nullptr, 1, nullptr, 0) == pdPASS;
+}
+
+void DHT22Manager::taskEntry(void*) {
+    vTaskDelay(pdMS_TO_TICKS(DHT_WARMUP_MS));
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;) {
+        sample();
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(DHT_SAMPLE_INTERVAL_MS));
+    }
+}
+
+void DHT22Manager::sample() {
+    // Start signal: at least 1 ms low, slept through rather than busy-waited
+    gpio_set_level(DHT_GPIO, 0);
+    vTaskDelay(pdMS_TO_TICKS(2));
+    gpio_set_level(DHT_GPIO, 1);
+    rmt_rx_start(DHT_RMT_CHANNEL, true);
+
+    size_t bytes = 0;
+    rmt_item32_t* items = (rmt_item32_t*)xRingbufferReceive(rxRing, &bytes, DHT_REPLY_TIMEOUT);
+    rmt_rx_stop(DHT_RMT_CHANNEL);
+
+    // RMT items are (level, duration) halves; pair every low with the high after it.
+    // The sensor's trailing end-of-frame low has no high and is dropped.
+    DhtPulse pulses[DHT_MAX_PULSES];
+    size_t count = 0;
+    if (items) {
+        size_t n = bytes / sizeof(rmt_item32_t);
+        uint16_t lowUs = 0;
+        for (size_t i = 0; i < n * 2 && count < DHT_MAX_PULSES; i++) {
+            const rmt_item32_t& item = items[i / 2];
+            uint16_t level = (i & 1) ? item.level1 : item.level0;
+            uint16_t duration = (i & 1) ? item.duration1 : item.duration0;
+            if (duration == 0) break;             // End marker
+            if (level == 0) {
+                lowUs = duration;
+            } else if (lowUs) {
+                pulses[count].lowUs = lowUs;
+                pulses[count].highUs = duration;
+                count++;
+                lowUs = 0;
+            }
         }
+        vRingbufferReturnItem(rxRing, items);
+    }
+
+    float temperature, humidity;
+    DhtDecodeResult result = dhtDecode(pulses, count, temperature, humidity);
+    if (result != DHT_OK) {
+        framesFailed[result]++;
+        return;
+    }
+    if (temperature < DHT_MIN_C || temperature > DHT_MAX_C || humidity < 0.0f || humidity > 100.0f) {
+        framesOutOfRange++;
+        return;
     }
-    return false;
+    framesOk++;
+    publish(temperature, humidity);
+}
+
+void DHT22Manager::publish(float temperature, float humidity) {
+    // Median of the last few frames drops single-frame spikes without lagging a real change much
+    rawTemperature[rawNext] = temperature;
+    rawHumidity[rawNext] = humidity;
+    rawNext = (rawNext + 1) % MEDIAN_WINDOW;
+    if (rawCount < MEDIAN_WINDOW) rawCount++;
+
+    uint32_t h = head;
+    DhtSample& slot = ring[h % RING_SIZE];
+    slot.atMs = millis();
+    slot.temperature = median(rawTemperature, rawCount);
+    slot.humidity = median(rawHumidity, rawCount);
+    __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);   // Slot complete before readers can see it
+}
+
+bool DHT22Manager::hasReading() {
+    return __atomic_load_n(&head, __ATOMIC_ACQUIRE) != 0;
+}
+
+bool DHT22Manager::getLatest(DhtSample& sample) {
+    // The producer writes the slot after this one; the newest stays untouched for RING_SIZE - 1 samples
+    uint32_t h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    if (h == 0) return false;
+    sample = ring[(h - 1) % RING_SIZE];
+    return true;
 }
 
 float DHT22Manager::getTemperature() {
-    update();
-    return temperature;
+    DhtSample sample;
+    return getLatest(sample) ? sample.temperature : NAN;
 }
 
 float DHT22Manager::getHumidity() {
-    update();
-    return humidity;
+    DhtSample sample;
+    return getLatest(sample) ? sample.humidity : NAN;
+}
+
+void DHT22Manager::printStats() {
+    DhtSample latest;
+    Serial.println("\n=== DHT22 ===");
+    if (getLatest(latest)) {
+        Serial.printf("Latest: %.1f °C, %.1f %%RH (%lu ms ago)\n",
+                      latest.temperature, latest.humidity, millis() - latest.atMs);
+    } else {
+        Serial.println("Latest: no reading yet");
+    }
+    Serial.printf("Frames: %u ok, %u no reply, %u bad timing, %u bad checksum, %u out of range\n",
+                  framesOk, framesFailed[DHT_TOO_FEW_PULSES], framesFailed[DHT_BAD_TIMING],
+                  framesFailed[DHT_BAD_CHECKSUM], framesOutOfRange);
+    Serial.println("=============");
 }
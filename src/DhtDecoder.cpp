@@ -0,0 +1,31 @@
+#include "DhtDecoder.h"
+
+static const size_t DHT_BITS = 40;
+static const uint16_t BIT_LOW_MIN_US = 35;      // Nominal 50 us
+static const uint16_t BIT_LOW_MAX_US = 75;
+static const uint16_t BIT_HIGH_MIN_US = 15;     // Nominal 26-28 us for a 0
+static const uint16_t BIT_HIGH_MAX_US = 90;     // Nominal 70 us for a 1
+static const uint16_t BIT_ONE_US = 48;          // Midway between the two
+
+DhtDecodeResult dhtDecode(const DhtPulse* pulses, size_t count, float& temperature, float& humidity) {
+    if (count < DHT_BITS) return DHT_TOO_FEW_PULSES;
+
+    uint8_t data[5] = {0};
+    const DhtPulse* bits = pulses + count - DHT_BITS;
+    for (size_t i = 0; i < DHT_BITS; i++) {
+        const DhtPulse& p = bits[i];
+        if (p.lowUs < BIT_LOW_MIN_US || p.lowUs > BIT_LOW_MAX_US ||
+            p.highUs < BIT_HIGH_MIN_US || p.highUs > BIT_HIGH_MAX_US) {
+            return DHT_BAD_TIMING;
+        }
+        data[i / 8] = (data[i / 8] << 1) | (p.highUs > BIT_ONE_US ? 1 : 0);
+    }
+
+    if ((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4]) return DHT_BAD_CHECKSUM;
+
+    // Big-endian tenths; the temperature sign is the top bit, not two's complement
+    humidity = ((data[0] << 8) | data[1]) / 10.0f;
+    temperature = (((data[2] & 0x7F) << 8) | data[3]) / 10.0f;
+    if (data[2] & 0x80) temperature = -temperature;
+    return DHT_OK;
+}
@@ -3,6 +3,12 @@
 #include "NTP.h"
 #include "Location.h"
 #include "OpenWeather.h"
+#include "FetchScheduler.h"
+#include "AllocCounter.h"
+#include "RefreshTimer.h"
+#include "HeapTelemetry.h"
+#include "ClimateLog.h"
+#include "DHT22.h"
 
 #include <WiFi.h>
 #include <Fonts/FreeSansBold12pt7b.h>
@@ -14,22 +20,84 @@
 // External reference to refresh interval defined in main.cpp
 extern const unsigned long FULL_REFRESH_INTERVAL;
 
-#ifdef PANEL_VARIANT_Z08
-GxEPD2_3C<GxEPD2_750c_Z08, 16> display(GxEPD2_750c_Z08(PIN_CS, PIN_DC, PIN_RST, PIN_BUSY));
-#else
-GxEPD2_3C<GxEPD2_750c_Z90, 16> display(GxEPD2_750c_Z90(PIN_CS, PIN_DC, PIN_RST, PIN_BUSY));
-#endif
+TimedDisplay<EpdPanel, 16> display(EpdPanel(PIN_CS, PIN_DC, PIN_RST, PIN_BUSY));
 
 // External references to shared objects
 extern NTPClient ntpClient;
 extern LocationManager locationManager;
 extern OpenWeather weather;
+extern FetchScheduler scheduler;
+extern int srcWeather;
 
 
 // Define refresh tracking variables
 unsigned long lastFullRefresh = 0;
 unsigned long lastTimeRefresh = 0;
 
+// Hash of the frame currently on the glass (0 = unknown), and of the one being
+// drawn until commitFrame() records it
+static uint64_t shownFrameHash = 0;
+static uint64_t pendingFrameHash = 0;
+
+// Indoor reading of the current frame, to the 0.1 C drawn; the DHT task may
+// publish a new one while the pages are being drawn
+static float frameIndoorC = NAN;
+static RefreshCounters refreshCounters = {0, 0};
+
+bool beginFrame(uint64_t frameHash, const char* viewName) {
+  if (frameHash != 0 && frameHash == shownFrameHash) {
+    refreshCounters.elided++;
+    Serial.printf("⏭️ %s unchanged, refresh skipped (elided %u, executed %u)\n",
+                  viewName, refreshCounters.elided, refreshCounters.executed);
+    return false;
+  }
+  refreshCounters.executed++;
+  shownFrameHash = 0;   // Unknown until the last page is out
+  pendingFrameHash = frameHash;
+  return true;
+}
+
+void commitFrame() {
+  shownFrameHash = pendingFrameHash;
+  pendingFrameHash = 0;
+}
+
+void invalidateFrame() {
+  shownFrameHash = 0;
+  pendingFrameHash = 0;
+}
+
+const RefreshCounters& getRefreshCounters() {
+  return refreshCounters;
+}
+
+void hashStatusBar(FrameHasher& hasher) {
+  ntpClient.tick();  // Frame start: every later read of the time in this frame agrees
+  hasher.add(ntpClient.getTimeString());
+  hasher.add(ntpClient.getDateString());
+  hasher.add(ntpClient.getDayString());
+  hasher.add(locationManager.getLocationString());
+  hasher.add(scheduler.isUsable(srcWeather) ? weather.getTemperature() : 0.0f);
+  hasher.add(WiFi.status() == WL_CONNECTED);
+  frameIndoorC = roundf(DHT22Manager::getTemperature() * 10.0f) / 10.0f;  // Same precision as drawn
+  hasher.add(frameIndoorC);
+  hasher.add((int32_t)ClimateLog::revision());
+}
+
+void hashFile(FrameHasher& hasher, const char* path) {
+  File file = SPIFFS.open(path, "r");
+  if (!file) {
+    hasher.add("missing");
+    return;
+  }
+  uint8_t buf[256];
+  size_t n;
+  while ((n = file.read(buf, sizeof(buf))) > 0) {
+    hasher.add(buf, n);
+  }
+  file.close();
+}
+
 void setupPowerEnable() {
   if (POWER_EN_PIN >= 0) {
     Serial.println("setupPowerEnable(): enabling panel power");
@@ -88,6 +156,7 @@ void initDisplay() {
   display.setFullWindow();
 
   // Perform initial clean
+    invalidateFrame();
     display.firstPage();
     do {
       display.fillScreen(GxEPD_WHITE);
@@ -144,6 +213,8 @@ const char WELCOME_LINE2[] PROGMEM = "Thumbstack Technologies";
 const char WELCOME_LINE3[] PROGMEM = "Initializing...";
 
 void showWelcomeMessage() {
+  if (!beginFrame(FrameHasher("welcome").value(), "Welcome screen")) return;
+
   display.setFullWindow();
   display.firstPage();
   do {
@@ -193,6 +264,7 @@ void showWelcomeMessage() {
     display.print(FPSTR(WELCOME_LINE3));
 
   } while (display.nextPage());
+  commitFrame();
 
   // ---- Print to Serial too ----
   Serial.println(F("\n=== Boot Greetings ==="));
@@ -220,12 +292,18 @@ void updateMainContent(const uint8_t* bitmap, int16_t x, int16_t y, int16_t w, i
     return;
   }
   
+  FrameHasher hasher("main_content");
+  hasher.add((int32_t)x).add((int32_t)y).add((int32_t)w).add((int32_t)h);
+  hasher.add(bitmap, ((w + 7) / 8) * h);
+  if (!useFullRefresh && !beginFrame(hasher.value(), "Main content")) return;
+
   // Wait for any previous updates to complete
   delay(500);  // Increased delay
   
   // Perform full refresh if requested to reduce ghosting
   if (useFullRefresh) {
     performFullRefresh();
+    beginFrame(hasher.value(), "Main content");
   }
   
   // Set window to only update main content area
@@ -252,11 +330,13 @@ void updateMainContent(const uint8_t* bitmap, int16_t x, int16_t y, int16_t w, i
     // Check for timeout
     if (millis() - startTime > timeout) {
   Serial.println("❌ Display update timeout!");
+      invalidateFrame();  // Left a partial frame on the panel
       return;
     }
     
     delay(100); // Increased delay between iterations
   } while (display.nextPage());
+  commitFrame();
   
   Serial.printf("✅ Main content updated successfully (%d pages)\n", pageCount);
   Serial.println("===============================\n");
@@ -265,7 +345,14 @@ void updateMainContent(const uint8_t* bitmap, int16_t x, int16_t y, int16_t w, i
 }
 
 void updateTimeDisplay() {
-    String timeStr = ntpClient.getTimeString();
+    HeapScope heapScope(HEAP_DISPLAY);
+    FrameHasher hasher("time");
+    hashStatusBar(hasher);
+    const char* timeStr = ntpClient.getTimeString();
+    if (!beginFrame(hasher.value(), "Time display")) {
+        lastTimeRefresh = millis();
+        return;
+    }
     
     display.setFullWindow();
     display.firstPage();
@@ -282,18 +369,78 @@ void updateTimeDisplay() {
         updateStatusBar(false); // false means don't trigger display update
         
     } while (display.nextPage());
+    commitFrame();
     
     lastTimeRefresh = millis();
     Serial.println("Full display refresh with updated time");
 }
 
+// Indoor temperature over a 24 h sparkline of hourly averages
+static void drawIndoorClimate(int16_t x, int16_t y) {
+    const int16_t SPARK_W = 96, SPARK_H = 16, STEP = SPARK_W / 24;
+    float indoor = frameIndoorC;   // As hashed, so every page and the hash agree
+    if (isnan(indoor)) return;
+
+    display.setFont(&FreeSans9pt7b);
+    display.setCursor(x, y);
+    display.printf("In %.1f°C", indoor);
+
+    float values[24];
+    bool present[24];
+    float lo = 1000.0f, hi = -1000.0f;
+    for (uint8_t i = 0; i < 24; i++) {
+        ClimateBucket bucket;
+        present[i] = ClimateLog::getBucket(CLIMATE_HOUR, 23 - i, bucket);   // Oldest first
+        if (!present[i]) continue;
+        values[i] = bucket.avgTemp;
+        if (values[i] < lo) lo = values[i];
+        if (values[i] > hi) hi = values[i];
+    }
+    if (hi < lo) return;
+    if (hi - lo < 1.0f) {
+        // Keep a flat day flat instead of stretching noise to full height
+        float mid = (hi + lo) / 2.0f;
+        lo = mid - 0.5f;
+        hi = mid + 0.5f;
+    }
+
+    int16_t top = y + 6;
+    int16_t prevX = -1, prevY = 0;
+    for (uint8_t i = 0; i < 24; i++) {
+        if (!present[i]) {
+            prevX = -1;
+            continue;
+        }
+        int16_t px = x + i * STEP;
+        int16_t py = top + SPARK_H - (int16_t)((values[i] - lo) / (hi - lo) * SPARK_H);
+        if (prevX >= 0) {
+            display.drawLine(prevX, prevY, px, py, GxEPD_BLACK);
+        } else {
+            display.drawPixel(px, py, GxEPD_BLACK);
+        }
+        prevX = px;
+        prevY = py;
+    }
+}
+
 void updateStatusBar(bool refreshDisplay) {
-    String dateStr = ntpClient.getDateString();
-    String dayStr = ntpClient.getDayString();
-    String locationStr = locationManager.getLocationString();
-    float temp = weather.getTemperature();
+    const char* dateStr = ntpClient.getDateString();
+    const char* dayStr = ntpClient.getDayString();
+    const char* locationStr = locationManager.getLocationString();
+    // Past its stale-while-revalidate window the reading is dropped rather than shown
+    float temp = scheduler.isUsable(srcWeather) ? weather.getTemperature() : 0.0f;
+    
+    static bool firstStatusBar = true;
+    if (firstStatusBar) {
+        firstStatusBar = false;
+        Serial.printf("⏱️ First status bar at %lu ms after boot (%s)\n", millis(), locationStr);
+    }
     
     if (refreshDisplay) {
+        FrameHasher hasher("status_bar");
+        hashStatusBar(hasher);
+        if (!beginFrame(hasher.value(), "Status bar")) return;
+
         display.setFullWindow();
         display.firstPage();
     }
@@ -329,11 +476,11 @@ void updateStatusBar(bool refreshDisplay) {
     }
 
     // Draw time (right of WiFi symbol)
-    String timeStr = ntpClient.getTimeString();
+    const char* timeStr = ntpClient.getTimeString();
     display.setFont(&FreeSansBold12pt7b);
     int16_t x1, y1;
     uint16_t w1, h1;
-    display.getTextBounds(timeStr.c_str(), 0, 0, &x1, &y1, &w1, &h1);
+    display.getTextBounds(timeStr, 0, 0, &x1, &y1, &w1, &h1);
     display.setCursor(display.width() - w1 - 75, 30); // Moved left to make room for battery and WiFi
     display.print(timeStr);
     
@@ -350,6 +497,8 @@ void updateStatusBar(bool refreshDisplay) {
     
     
     
+    drawIndoorClimate(430, 25);
+
     // Draw outdoor temperature (if available)
     if (temp != 0.0) {
         display.setCursor(display.width() - 200, 40);
@@ -358,6 +507,7 @@ void updateStatusBar(bool refreshDisplay) {
     
     if (refreshDisplay) {
         while (display.nextPage());
+        commitFrame();
         Serial.println("Status bar updated with full refresh");
     }
 }
@@ -371,28 +521,48 @@ void performFullRefresh() {
     display.display(false);  // false = full update
     delay(2000);  // Give display time to complete
     
+    shownFrameHash = FrameHasher("blank").value();
+    pendingFrameHash = 0;
+    refreshCounters.executed++;
     lastFullRefresh = millis();
   Serial.println("Full refresh completed");
 }
 
 void checkAndRefresh() {
-    unsigned long currentTime = millis();
+    // The hourly clean takes the place of a minute refresh so it lands on the boundary too
+    bool fullDue = millis() - lastFullRefresh >= FULL_REFRESH_INTERVAL;
+    RefreshType type = fullDue ? REFRESH_FULL : REFRESH_TIME;
+    if (!RefreshTimer::due(type)) return;
     
-    // Check if it's time for a time update (includes full refresh)
-    if (currentTime - lastTimeRefresh >= TIME_REFRESH_INTERVAL) {
-        Serial.println("Time update with full refresh triggered");
-        updateTimeDisplay();
-    }
-    // Check if it's time for a periodic full refresh
-    else if (currentTime - lastFullRefresh >= FULL_REFRESH_INTERVAL) {
+    uint32_t executedBefore = refreshCounters.executed;
+    RefreshTimer::start(type);
+    
+    if (fullDue) {
         Serial.println("Periodic full refresh triggered");
+        Serial.printf("Refreshes so far: %u executed, %u elided\n",
+                      refreshCounters.executed, refreshCounters.elided);
         performFullRefresh();
         showDashboard();
+        lastTimeRefresh = millis();
+    } else {
+        Serial.println("Time update with full refresh triggered");
+        uint32_t timeCalls = ntpClient.getLocalTimeCalls();
+        AllocCounter::begin();
+        updateTimeDisplay();
+        Serial.printf("🧮 Time refresh made %u heap allocations, %u local time conversions\n",
+                      AllocCounter::end(), ntpClient.getLocalTimeCalls() - timeCalls);
     }
+    
+    RefreshTimer::finish(type, refreshCounters.executed != executedBefore);
 }
 
 // Simple status bar only page
 void showDashboard() {
+    HeapScope heapScope(HEAP_DISPLAY);
+    FrameHasher hasher("dashboard");
+    hashStatusBar(hasher);
+    if (!beginFrame(hasher.value(), "Dashboard")) return;
+
     display.setFullWindow();
     display.firstPage();
     do {
@@ -402,6 +572,7 @@ void showDashboard() {
         updateStatusBar(false);
         
     } while (display.nextPage());
+    commitFrame();
     
     Serial.println("Status bar page displayed");
 }
@@ -0,0 +1,137 @@
+#include "FetchScheduler.h"
+#include "Metrics.h"
+
+FetchScheduler::FetchScheduler() : _count(0), _next(0), _maxLoopMs(0), _startedAt(0) {}
+
+int FetchScheduler::addSource(const char* name, bool (*fetch)(), unsigned long ttlMs, unsigned long staleMs,
+                              unsigned long backoffBaseMs, unsigned long backoffMaxMs, uint8_t failureBudget) {
+    if (_count >= MAX_SOURCES) {
+        Serial.printf("❌ Scheduler full, cannot add source %s\n", name);
+        return -1;
+    }
+
+    FetchSource& src = _sources[_count];
+    src.name = name;
+    src.fetch = fetch;
+    src.ttlMs = ttlMs;
+    src.staleMs = staleMs;
+    src.backoffBaseMs = backoffBaseMs;
+    src.backoffMaxMs = backoffMaxMs;
+    src.failureBudget = failureBudget;
+    src.hasData = false;
+    src.lastSuccess = 0;
+    src.nextAttempt = millis();   // Due immediately
+    src.failures = 0;
+    src.paused = false;
+    src.attempts = 0;
+    src.successes = 0;
+
+    if (_count == 0) _startedAt = millis();
+    return _count++;
+}
+
+void FetchScheduler::setTtl(int id, unsigned long ttlMs) {
+    if (id < 0 || id >= _count) return;
+    FetchSource& src = _sources[id];
+    if (src.ttlMs == ttlMs) return;
+    src.ttlMs = ttlMs;
+    if (src.hasData && src.failures == 0) src.nextAttempt = src.lastSuccess + ttlMs;
+}
+
+bool FetchScheduler::attempt(FetchSource& src) {
+    unsigned long start = millis();
+    src.attempts++;
+    Metrics::setSource(src.name);
+    bool ok = src.fetch();
+    Metrics::setSource(nullptr);
+    unsigned long now = millis();
+
+    if (ok) {
+        src.hasData = true;
+        src.lastSuccess = now;
+        src.failures = 0;
+        src.successes++;
+        src.nextAttempt = now + src.ttlMs;
+        Serial.printf("🔄 %s refreshed in %lu ms, next in %lus\n", src.name, now - start, src.ttlMs / 1000);
+        return true;
+    }
+
+    src.failures++;
+    if (src.failures >= src.failureBudget) {
+        // Budget spent: stop hammering the endpoint until the next regular refresh
+        src.failures = 0;
+        src.nextAttempt = now + src.ttlMs;
+        Serial.printf("⚠️ %s failure budget spent, retrying in %lus\n", src.name, src.ttlMs / 1000);
+        return false;
+    }
+
+    unsigned long backoff = src.backoffBaseMs << (src.failures - 1);
+    if (backoff > src.backoffMaxMs || backoff < src.backoffBaseMs) backoff = src.backoffMaxMs;
+    backoff = backoff / 2 + random(backoff + 1);   // +-50% jitter so sources don't retry in lockstep
+    src.nextAttempt = now + backoff;
+    Serial.printf("⚠️ %s fetch failed (%u/%u), retry in %lu ms\n", src.name, src.failures, src.failureBudget, backoff);
+    return false;
+}
+
+int FetchScheduler::tick() {
+    unsigned long now = millis();
+
+    for (int i = 0; i < _count; i++) {
+        int id = (_next + i) % _count;
+        FetchSource& src = _sources[id];
+        if (src.paused || (long)(now - src.nextAttempt) < 0) continue;
+
+        _next = (id + 1) % _count;
+        return attempt(src) ? id : -1;
+    }
+    return -1;
+}
+
+bool FetchScheduler::refreshNow(int id) {
+    if (id < 0 || id >= _count) return false;
+    return attempt(_sources[id]);
+}
+
+void FetchScheduler::markCached(int id) {
+    if (id < 0 || id >= _count) return;
+    FetchSource& src = _sources[id];
+    src.hasData = true;
+    src.lastSuccess = millis() - src.ttlMs;   // Stale: usable, but due for revalidation
+    src.nextAttempt = millis();
+}
+
+void FetchScheduler::pause(int id) {
+    if (id < 0 || id >= _count) return;
+    _sources[id].paused = true;
+}
+
+bool FetchScheduler::isFresh(int id) const {
+    if (id < 0 || id >= _count) return false;
+    const FetchSource& src = _sources[id];
+    return src.hasData && millis() - src.lastSuccess < src.ttlMs;
+}
+
+bool FetchScheduler::isUsable(int id) const {
+    if (id < 0 || id >= _count) return false;
+    const FetchSource& src = _sources[id];
+    return src.hasData && millis() - src.lastSuccess < src.ttlMs + src.staleMs;
+}
+
+void FetchScheduler::recordLoopTime(unsigned long ms) {
+    if (ms > _maxLoopMs) _maxLoopMs = ms;
+}
+
+void FetchScheduler::printStats() const {
+    float hours = (millis() - _startedAt) / 3600000.0f;
+    if (hours < 0.01f) hours = 0.01f;
+
+    Serial.println("\n=== Fetch Scheduler Stats ===");
+    for (int i = 0; i < _count; i++) {
+        const FetchSource& src = _sources[i];
+        const char* state = src.paused ? "paused" : isFresh(i) ? "fresh" : (isUsable(i) ? "stale" : "expired");
+        Serial.printf("%-10s %-7s fetches: %u (%.1f/h), ok: %u\n",
+                      src.name, state, src.attempts, src.attempts / hours, src.successes);
+    }
+    Serial.printf("Worst-case loop latency: %lu ms\n", _maxLoopMs);
+    Serial.println("=============================");
+}
@@ -0,0 +1,133 @@
+#include "HeapTelemetry.h"
+#include "Config.h"
+#include "RefreshArena.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static const char* const TAG_NAMES[HEAP_TAG_COUNT] = {
+    "other", "display", "http", "json", "nfc", "storage"
+};
+
+static HeapTagStats tagStats[HEAP_TAG_COUNT];
+static uint32_t lowestLargestBlock = UINT32_MAX;
+
+// Innermost open scope of each task that has one. FreeRTOS TLS pointer 0 holds
+// the pthread keys lwIP relies on, so the tasks get a small table instead. Only
+// the owning task writes an entry's tag; claiming and releasing an entry is a CAS.
+struct TaskTag {
+    TaskHandle_t task;
+    uint8_t tag;
+};
+static const int MAX_TAGGED_TASKS = 4;    // loop, nfc, dht22 and one spare
+static TaskTag taskTags[MAX_TAGGED_TASKS];
+
+static TaskTag* findTaskTag(TaskHandle_t task) {
+    if (!task) return nullptr;    // Before the scheduler starts
+    for (TaskTag& t : taskTags) {
+        if (__atomic_load_n(&t.task, __ATOMIC_ACQUIRE) == task) return &t;
+    }
+    return nullptr;
+}
+
+static void addStat(uint32_t& counter, uint32_t value) {
+    __atomic_fetch_add(&counter, value, __ATOMIC_RELAXED);
+}
+
+static void addStat(int32_t& counter, int32_t value) {
+    __atomic_fetch_add(&counter, value, __ATOMIC_RELAXED);
+}
+
+void HeapTelemetry::recordAlloc(size_t size) {
+    // Runs inside the allocator on any task: no logging, no allocation, no locks
+    TaskTag* entry = findTaskTag(xTaskGetCurrentTaskHandle());
+    uint8_t tag = entry ? entry->tag : (uint8_t)HEAP_OTHER;
+    addStat(tagStats[tag].allocs, 1);
+    addStat(tagStats[tag].bytes, size);
+}
+
+HeapTag HeapTelemetry::currentTag() {
+    TaskTag* entry = findTaskTag(xTaskGetCurrentTaskHandle());
+    return entry ? (HeapTag)entry->tag : HEAP_OTHER;
+}
+
+void HeapTelemetry::enter(HeapTag tag) {
+    addStat(tagStats[tag].scopes, 1);
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TaskTag* entry = findTaskTag(self);
+    for (int i = 0; !entry && self && i < MAX_TAGGED_TASKS; i++) {
+        TaskHandle_t expected = nullptr;
+        if (__atomic_compare_exchange_n(&taskTags[i].task, &expected, self, false, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE)) {
+            entry = &taskTags[i];
+        }
+    }
+    if (entry) entry->tag = tag;    // Table full: this task's allocations stay "other"
+}
+
+void HeapTelemetry::leave(HeapTag previous) {
+    TaskTag* entry = findTaskTag(xTaskGetCurrentTaskHandle());
+    if (!entry) return;
+    entry->tag = previous;
+    if (previous == HEAP_OTHER) __atomic_store_n(&entry->task, (TaskHandle_t)nullptr, __ATOMIC_RELEASE);
+}
+
+HeapScope::HeapScope(HeapTag tag) : _tag(tag), _prevTag(HeapTelemetry::currentTag()) {
+    _freeBefore = ESP.getFreeHeap();
+    _largestBefore = ESP.getMaxAllocHeap();
+    HeapTelemetry::enter(tag);
+}
+
+HeapScope::~HeapScope() {
+    HeapTelemetry::leave(_prevTag);
+
+    // Free heap is global, so with other tasks running this is only an estimate
+    HeapTagStats& stats = tagStats[_tag];
+    addStat(stats.retained, (int32_t)_freeBefore - (int32_t)ESP.getFreeHeap());
+    addStat(stats.largestBlockLoss, (int32_t)_largestBefore - (int32_t)ESP.getMaxAllocHeap());
+}
+
+const HeapTagStats& HeapTelemetry::getStats(HeapTag tag) {
+    return tagStats[tag];
+}
+
+const char* HeapTelemetry::tagName(HeapTag tag) {
+    return TAG_NAMES[tag];
+}
+
+uint32_t HeapTelemetry::minLargestBlock() {
+    return lowestLargestBlock;
+}
+
+void HeapTelemetry::poll() {
+    static unsigned long lastSnapshot = 0;
+    uint32_t largest = ESP.getMaxAllocHeap();
+    if (largest < lowestLargestBlock) lowestLargestBlock = largest;
+
+    if (millis() - lastSnapshot < HEAP_SNAPSHOT_INTERVAL_MS) return;
+    lastSnapshot = millis();
+    printSnapshot();
+}
+
+void HeapTelemetry::printSnapshot() {
+    uint32_t freeHeap = ESP.getFreeHeap();
+    uint32_t largest = ESP.getMaxAllocHeap();
+    if (largest < lowestLargestBlock) lowestLargestBlock = largest;
+    uint32_t fragmentation = freeHeap ? 100 - (largest * 100) / freeHeap : 0;
+
+    // Called from loop(), so this is the loop task's own stack
+    UBaseType_t stackHeadroom = uxTaskGetStackHighWaterMark(nullptr);
+
+    Serial.printf("\n=== Heap Snapshot (uptime %.1f h) ===\n", millis() / 3600000.0f);
+    Serial.printf("Free: %u B, low-water: %u B, largest block: %u B (min %u B), fragmentation: %u%%\n",
+                  freeHeap, ESP.getMinFreeHeap(), largest, lowestLargestBlock, fragmentation);
+    Serial.printf("Loop stack headroom: %u B\n", (unsigned)stackHeadroom);
+    Serial.printf("Refresh arena peak: %u of %u B\n", (unsigned)RefreshArena::peak(),
+                  (unsigned)RefreshArena::CAPACITY);
+    Serial.println("Subsystem   allocs      bytes  scopes  retained  block loss");
+    for (int i = 0; i < HEAP_TAG_COUNT; i++) {
+        const HeapTagStats& s = tagStats[i];
+        Serial.printf("%-9s %8u %10u %7u %9d %11d\n",
+                      TAG_NAMES[i], s.allocs, s.bytes, s.scopes, s.retained, s.largestBlockLoss);
+    }
+    Serial.println("=====================================");
+}
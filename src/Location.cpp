@@ -1,94 +1,149 @@
 #include "Location.h"
 #include <Arduino.h>
-#include <HTTPClient.h>
+#include "NetTrace.h"
 #include <ArduinoJson.h>
 #include <WiFi.h>
+#include <Preferences.h>
+#include <time.h>
+#include "Config.h"
+#include "HeapTelemetry.h"
+#include "RefreshArena.h"
 
-LocationManager::LocationManager() : _locationValid(false) {
+LocationManager::LocationManager() : _locationValid(false), _resolvedAt(0) {
     _currentLocation.city = "Unknown";
     _currentLocation.country = "Unknown";
     _currentLocation.region = "Unknown";
     _currentLocation.latitude = 0.0;
     _currentLocation.longitude = 0.0;
+    updateLocationString();
+}
+
+bool LocationManager::begin() {
+    Preferences prefs;
+    if (!prefs.begin("location", true)) return false;
+    
+    bool found = prefs.isKey("ip");
+    if (found) {
+        char buf[40];
+        _publicIP = prefs.getString("ip", buf, sizeof(buf)) ? buf : "";
+        _currentLocation.city = prefs.getString("city", buf, sizeof(buf)) ? buf : "Unknown";
+        _currentLocation.country = prefs.getString("country", buf, sizeof(buf)) ? buf : "Unknown";
+        _currentLocation.region = prefs.getString("region", buf, sizeof(buf)) ? buf : "Unknown";
+        _currentLocation.latitude = prefs.getFloat("lat", 0.0);
+        _currentLocation.longitude = prefs.getFloat("lon", 0.0);
+        _resolvedAt = prefs.getUInt("at", 0);
+        _locationValid = true;
+        updateLocationString();
+        Serial.printf("📍 Cached location: %s (IP %s)\n", getLocationString(), _publicIP.c_str());
+    }
+    prefs.end();
+    return found;
+}
+
+void LocationManager::saveCache() {
+    HeapScope heapScope(HEAP_STORAGE);
+    Preferences prefs;
+    if (!prefs.begin("location", false)) {
+        Serial.println("⚠️ Failed to open NVS for location cache");
+        return;
+    }
+    prefs.putString("ip", _publicIP.c_str());
+    prefs.putString("city", _currentLocation.city.c_str());
+    prefs.putString("country", _currentLocation.country.c_str());
+    prefs.putString("region", _currentLocation.region.c_str());
+    prefs.putFloat("lat", _currentLocation.latitude);
+    prefs.putFloat("lon", _currentLocation.longitude);
+    prefs.putUInt("at", _resolvedAt);
+    prefs.end();
 }
 
 bool LocationManager::updateLocation() {
-    const int maxRetries = 3;
-    int retryCount = 0;
-    String publicIP;
-    HTTPClient http;
-    
-    // Get public IP with retries
-    while (retryCount < maxRetries) {
-        http.begin("http://api.ipify.org");
-        int httpCode = http.GET();
-        
-        if (httpCode == HTTP_CODE_OK) {
-            publicIP = http.getString();
-            http.end();
-            Serial.print("📍 Public IP: ");
-            Serial.println(publicIP);
-            break;  // Success, continue with location lookup
-        }
-        
-        Serial.printf("⚠️ Failed to get public IP (attempt %d/%d)\n", retryCount + 1, maxRetries);
-        Serial.printf("HTTP Code: %d\n", httpCode);
+    HeapScope heapScope(HEAP_HTTP);
+    // Single attempt per call; FetchScheduler owns retries and backoff
+    TracedHTTPClient http;
+    http.setTimeout(5000);
+    
+    // Get public IP; the reply is the bare address, read straight off the socket
+    http.useHTTP10(true);
+    http.begin("http://api.ipify.org");
+    int httpCode = http.GET();
+    
+    if (httpCode != HTTP_CODE_OK) {
+        Serial.printf("⚠️ Failed to get public IP, HTTP Code: %d\n", httpCode);
         http.end();
-        retryCount++;
-        
-        if (retryCount < maxRetries) {
-            delay(1000);  // Wait before retry
-            continue;
-        }
-        
-        Serial.println("❌ Failed to get public IP after all retries");
         return false;
     }
     
-    // Reset retry counter for location lookup
-    retryCount = 0;
-    
-    // Get location from IP with retries
-    while (retryCount < maxRetries) {
-        String geoUrl = "http://ipinfo.io/" + publicIP + "/json";
-        http.begin(geoUrl);
-        int httpCode = http.GET();
-        
-        if (httpCode == HTTP_CODE_OK) {
-            String payload = http.getString();
-            Serial.println("Location API Response:");
-            Serial.println(payload);
-            http.end();
-            
-            if (!parseIPGeolocation(payload)) {
-                Serial.println("⚠️ Failed to parse location data");
-                return false;
-            }
-            
-            _locationValid = true;
-            return true;
-        }
-        
-        Serial.printf("⚠️ Location API request failed (attempt %d/%d)\n", retryCount + 1, maxRetries);
-        Serial.printf("HTTP Code: %d\n", httpCode);
+    int size = http.getSize();
+    char publicIP[40];
+    size_t ipLen = size > 0 && size < (int)sizeof(publicIP) ? http.getStream().readBytes(publicIP, size) : 0;
+    http.end();
+    publicIP[ipLen] = '\0';
+    if (!ipLen) {
+        Serial.printf("⚠️ Unexpected public IP reply (%d bytes)\n", size);
+        return false;
+    }
+    Serial.printf("📍 Public IP: %s\n", publicIP);
+    
+    // Same IP as the cached lookup: the geolocation cannot have changed. A lookup
+    // made before the clock was set (_resolvedAt 0) is redone once it is.
+    time_t now = time(nullptr);
+    bool cacheExpired = now >= MIN_VALID_EPOCH &&
+                        (_resolvedAt == 0 || (uint32_t)now - _resolvedAt >= LOCATION_CACHE_TTL_S);
+    if (_locationValid && _publicIP == publicIP && !cacheExpired) {
+        Serial.println("📍 Public IP unchanged, using cached location");
+        return true;
+    }
+    
+    // Get location from IP
+    FixedString<80> geoUrl;
+    geoUrl.appendf("http://ipinfo.io/%s/json", publicIP);
+    http.useHTTP10(true);  // No chunked encoding, so the body can be parsed straight off the socket
+    http.begin(geoUrl.c_str());
+    httpCode = http.GET();
+    
+    if (httpCode != HTTP_CODE_OK) {
+        Serial.printf("⚠️ Location API request failed, HTTP Code: %d\n", httpCode);
         http.end();
-        retryCount++;
-        
-        if (retryCount < maxRetries) {
-            delay(1000);  // Wait before retry
-            continue;
-        }
-        
-        Serial.println("❌ Failed to get location after all retries");
         return false;
     }
     
-    return false;
+    bool parsed = parseIPGeolocation(http.getStream());
+    http.end();
+    
+    if (!parsed) {
+        Serial.println("⚠️ Failed to parse location data");
+        return false;
+    }
+    
+    _locationValid = true;
+    _publicIP = publicIP;
+    updateLocationString();
+    _resolvedAt = now >= MIN_VALID_EPOCH ? (uint32_t)now : 0;
+    saveCache();
+    return true;
 }
 
-bool LocationManager::parseIPGeolocation(String& response) {
-    DynamicJsonDocument doc(1024);
-    DeserializationError error = deserializeJson(doc, response);
+bool LocationManager::parseIPGeolocation(Stream& response) {
+    HeapScope heapScope(HEAP_JSON);
+    // Keep only the fields we use; everything else is skipped while streaming
+    static StaticJsonDocument<JSON_OBJECT_SIZE(5)> filter;
+    if (filter.isNull()) {
+        filter["city"] = true;
+        filter["country"] = true;
+        filter["region"] = true;
+        filter["loc"] = true;
+        filter["error"] = true;
+    }
+    
+    ArenaScope arena("Location", ArenaBudget::LOCATION);
+    ArenaJsonDocument doc(ARENA_LOCATION_JSON);
+    unsigned long startTime = micros();
+    uint32_t heapBefore = ESP.getFreeHeap();
+    DeserializationError error = deserializeJson(doc, response, DeserializationOption::Filter(filter));
+    Serial.printf("📍 Location JSON parsed in %lu us, doc %u/%u bytes, heap delta %d\n",
+                  micros() - startTime, (unsigned)doc.memoryUsage(), (unsigned)doc.capacity(),
+                  (int)(heapBefore - ESP.getFreeHeap()));
     
     if (error) {
         Serial.println("⚠️ JSON parsing failed");
@@ -96,9 +151,14 @@ bool LocationManager::parseIPGeolocation(String& response) {
         return false;
     }
     
+    if (doc.overflowed()) {
+        Serial.println("⚠️ Location JSON did not fit in the document");
+        return false;
+    }
+    
     // Check for error response
     if (doc.containsKey("error")) {
-        Serial.println("⚠️ API Error: " + doc["error"].as<String>());
+        Serial.printf("⚠️ API Error: %s\n", doc["error"]["message"] | "unknown");
         return false;
     }
     
@@ -107,28 +167,36 @@ bool LocationManager::parseIPGeolocation(String& response) {
         return false;
     }
     
-    _currentLocation.city = doc["city"].as<String>();
-    _currentLocation.country = doc["country"].as<String>();
-    _currentLocation.region = doc["region"].as<String>();
+    _currentLocation.city = doc["city"].as<const char*>();
+    _currentLocation.country = doc["country"].as<const char*>();
+    _currentLocation.region = doc["region"] | "";
     
     // Parse location string "lat,lon" into separate values
-    if (doc.containsKey("loc")) {
-        String loc = doc["loc"].as<String>();
-        int commaIndex = loc.indexOf(',');
-        if (commaIndex > 0) {
-            _currentLocation.latitude = loc.substring(0, commaIndex).toFloat();
-            _currentLocation.longitude = loc.substring(commaIndex + 1).toFloat();
+    const char* loc = doc["loc"];
+    if (loc) {
+        const char* comma = strchr(loc, ',');
+        if (comma && comma != loc) {
+            _currentLocation.latitude = atof(loc);
+            _currentLocation.longitude = atof(comma + 1);
         }
     }
     
     return true;
 }
 
-String LocationManager::getLocationString() {
-    if (!_locationValid) return "Location Unknown";
-    return _currentLocation.city + ", " + _currentLocation.country;
+void LocationManager::updateLocationString() {
+    _locationString.clear();
+    if (!_locationValid) {
+        _locationString = "Location Unknown";
+        return;
+    }
+    _locationString.appendf("%s, %s", _currentLocation.city.c_str(), _currentLocation.country.c_str());
+}
+
+const char* LocationManager::getLocationString() const {
+    return _locationString.c_str();
 }
 
-LocationData LocationManager::getCurrentLocation() {
+const LocationData& LocationManager::getCurrentLocation() const {
     return _currentLocation;
 }
\ No newline at end of file
@@ -0,0 +1,368 @@
+#include "Metrics.h"
+#include <WebServer.h>
+#include <WiFi.h>
+#include "Config.h"
+#include "ContentSync.h"
+#include "DisplayManager.h"
+#include "FetchScheduler.h"
+#include "FixedString.h"
+#include "HeapTelemetry.h"
+#include "NFC.h"
+#include "RefreshArena.h"
+#include "RefreshTimer.h"
+
+extern FetchScheduler scheduler;
+
+static WebServer server(METRICS_PORT);
+
+void DurationHistogram::add(uint64_t us) {
+    int i = 0;
+    while (i < METRIC_BUCKET_COUNT && us > METRIC_BUCKET_MS[i] * 1000) i++;
+    buckets[i]++;
+    samples++;
+    sumUs += us;
+}
+
+// ---- Display ----
+static const int FRAME_WINDOWS = 2;
+static const char* const WINDOW_NAMES[FRAME_WINDOWS] = {"full", "partial"};
+static DurationHistogram frameRender[FRAME_WINDOWS];
+static DurationHistogram frameSpi[FRAME_WINDOWS];
+static DurationHistogram frameRefresh[FRAME_WINDOWS];
+
+// ---- HTTP, per fetch source; traffic outside the scheduler is "other" ----
+struct HttpSourceStats {
+    const char* source;
+    uint32_t requests;
+    uint32_t errors;        // Transport failures and 4xx/5xx
+    uint32_t bytes;         // Content-Length of the responses
+    DurationHistogram latency;
+};
+static const int HTTP_SOURCES = FetchScheduler::MAX_SOURCES + 1;
+static HttpSourceStats httpStats[HTTP_SOURCES];
+static int httpSourceCount = 0;
+static const char* currentSource = nullptr;
+
+// ---- WiFi ----
+static bool wifiConnected = false;
+static bool wifiEverConnected = false;
+static uint32_t wifiDisconnects = 0;
+static uint32_t wifiReconnects = 0;
+
+// ---- NFC ----
+static const int NFC_EVENT_TYPES = NFC_EVENT_BENCH_DONE + 1;
+static const char* const NFC_EVENT_NAMES[NFC_EVENT_TYPES] = {
+    "ready", "init_failed", "tag_arrived", "tag_current", "tag_written", "write_failed", "tag_removed",
+    "url_served", "bench_done"
+};
+static uint32_t nfcEvents[NFC_EVENT_TYPES];
+static DurationHistogram nfcOperation;      // Tag arrival to result, or a reader session
+
+static HttpSourceStats& statsFor(const char* source) {
+    if (!source) source = "other";
+    for (int i = 0; i < httpSourceCount; i++) {
+        if (!strcmp(httpStats[i].source, source)) return httpStats[i];
+    }
+    if (httpSourceCount == HTTP_SOURCES) return httpStats[HTTP_SOURCES - 1];   // Full: lumped with the last
+    httpStats[httpSourceCount].source = source;
+    return httpStats[httpSourceCount++];
+}
+
+// Streams samples to the scraper in small chunks, as Prometheus text or JSON
+class MetricsWriter {
+public:
+    MetricsWriter(WebServer& server, bool json) : _server(server), _json(json), _samples(0) {}
+
+    void start() {
+        _server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        _server.send(200, _json ? "application/json" : "text/plain; version=0.0.4", "");
+        if (_json) {
+            _line.appendf("{\"uptime_ms\":%lu,\"samples\":[", millis());
+            emit();
+        }
+    }
+
+    // HELP and TYPE lines ahead of a metric's samples (Prometheus only)
+    void family(const char* name, const char* type, const char* help) {
+        if (_json) return;
+        _line.appendf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+        emit();
+    }
+
+    // labels in Prometheus form: key="value",key2="value2"
+    void sample(const char* name, double value, const char* labels = "") {
+        if (_json) {
+            _line.appendf("%s{\"name\":\"%s\"", _samples ? "," : "", name);
+            appendJsonLabels(labels);
+            _line.appendf(",\"value\":%.10g}", value);
+        } else if (*labels) {
+            _line.appendf("%s{%s} %.10g\n", name, labels, value);
+        } else {
+            _line.appendf("%s %.10g\n", name, value);
+        }
+        _samples++;
+        emit();
+    }
+
+    // Cumulative buckets in seconds, then _sum and _count
+    void histogram(const char* name, const DurationHistogram& h, const char* labels = "") {
+        FixedString<64> series;
+        FixedString<96> bucketLabels;
+        uint32_t cumulative = 0;
+        series.appendf("%s_bucket", name);
+        for (int i = 0; i <= METRIC_BUCKET_COUNT; i++) {
+            cumulative += h.buckets[i];
+            bucketLabels.clear();
+            if (*labels) bucketLabels.appendf("%s,", labels);
+            if (i < METRIC_BUCKET_COUNT) bucketLabels.appendf("le=\"%g\"", METRIC_BUCKET_MS[i] / 1000.0);
+            else bucketLabels.append("le=\"+Inf\"");
+            sample(series.c_str(), cumulative, bucketLabels.c_str());
+        }
+        series.clear();
+        series.appendf("%s_sum", name);
+        sample(series.c_str(), h.sumUs / 1e6, labels);
+        series.clear();
+        series.appendf("%s_count", name);
+        sample(series.c_str(), h.samples, labels);
+    }
+
+    void finish() {
+        if (_json) {
+            _line.append("]}\n");
+            emit();
+        }
+        flush();
+        _server.sendContent("");   // Last chunk
+    }
+
+private:
+    WebServer& _server;
+    bool _json;
+    uint32_t _samples;
+    FixedString<256> _line;
+    FixedString<1024> _chunk;
+
+    void emit() {
+        if (_chunk.length() + _line.length() > _chunk.capacity()) flush();
+        _chunk.append(_line.c_str());
+        _line.clear();
+    }
+
+    void flush() {
+        if (!_chunk.isEmpty()) _server.sendContent(_chunk.c_str(), _chunk.length());
+        _chunk.clear();
+    }
+
+    // key="value",... -> ,"key":"value",...
+    void appendJsonLabels(const char* labels) {
+        while (*labels) {
+            const char* eq = strchr(labels, '=');
+            const char* close = eq ? strchr(eq + 2, '"') : nullptr;
+            if (!close) return;
+            _line.appendf(",\"%.*s\":%.*s", (int)(eq - labels), labels, (int)(close - eq), eq + 1);
+            labels = *(close + 1) == ',' ? close + 2 : close + 1;
+        }
+    }
+};
+
+void Metrics::begin() {
+    if (!METRICS_ENABLED) return;
+    server.on("/metrics", [] { serve(false); });
+    server.on("/metrics.json", [] { serve(true); });
+    server.onNotFound([] { server.send(404, "text/plain", "Try /metrics or /metrics.json\n"); });
+    server.begin();
+    Serial.printf("📈 Metrics on port %u: /metrics (Prometheus), /metrics.json\n", METRICS_PORT);
+}
+
+void Metrics::poll() {
+    bool connected = WiFi.status() == WL_CONNECTED;
+    if (connected != wifiConnected) {
+        if (!connected) wifiDisconnects++;
+        else if (wifiEverConnected) wifiReconnects++;
+        wifiEverConnected |= connected;
+        wifiConnected = connected;
+    }
+    if (METRICS_ENABLED) server.handleClient();
+}
+
+void Metrics::recordFrame(bool partial, uint32_t renderUs, uint32_t spiUs, uint32_t refreshUs) {
+    frameRender[partial].add(renderUs);
+    frameSpi[partial].add(spiUs);
+    frameRefresh[partial].add(refreshUs);
+}
+
+void Metrics::recordHttp(int status, uint32_t latencyUs, int bytes) {
+    HttpSourceStats& stats = statsFor(currentSource);
+    stats.requests++;
+    if (status < 0 || status >= 400) stats.errors++;
+    if (bytes > 0) stats.bytes += bytes;
+    stats.latency.add(latencyUs);
+}
+
+void Metrics::recordNfc(const NfcEvent& event) {
+    if (event.type < NFC_EVENT_TYPES) nfcEvents[event.type]++;
+    if (event.tookMs > 0) nfcOperation.add((uint64_t)event.tookMs * 1000);
+}
+
+void Metrics::setSource(const char* name) {
+    currentSource = name;
+}
+
+void Metrics::serve(bool json) {
+    HeapScope heapScope(HEAP_HTTP);
+    MetricsWriter out(server, json);
+    FixedString<64> labels;
+    out.start();
+
+    out.family("eink_uptime_seconds", "gauge", "Time since boot");
+    out.sample("eink_uptime_seconds", millis() / 1000.0);
+
+    // ---- Display ----
+    out.family("eink_frames_total", "counter", "Frames sent to the panel, by refresh window");
+    for (int w = 0; w < FRAME_WINDOWS; w++) {
+        labels.clear();
+        labels.appendf("window=\"%s\"", WINDOW_NAMES[w]);
+        out.sample("eink_frames_total", frameRefresh[w].samples, labels.c_str());
+    }
+    out.family("eink_frames_elided_total", "counter", "Frames skipped because the panel already showed them");
+    out.sample("eink_frames_elided_total", getRefreshCounters().elided);
+
+    out.family("eink_timed_refreshes_total", "counter", "Minute-aligned refreshes that reached the panel, by type");
+    for (int t = 0; t < REFRESH_TYPE_COUNT; t++) {
+        labels.clear();
+        labels.appendf("type=\"%s\"", RefreshTimer::typeName((RefreshType)t));
+        out.sample("eink_timed_refreshes_total", RefreshTimer::getTiming((RefreshType)t).samples, labels.c_str());
+    }
+    out.family("eink_timed_refresh_latency_ms", "gauge", "Moving average from render start to panel done, by type");
+    for (int t = 0; t < REFRESH_TYPE_COUNT; t++) {
+        labels.clear();
+        labels.appendf("type=\"%s\"", RefreshTimer::typeName((RefreshType)t));
+        out.sample("eink_timed_refresh_latency_ms", RefreshTimer::getTiming((RefreshType)t).latencyMs, labels.c_str());
+    }
+
+    static const struct { const char* name; const char* help; DurationHistogram* histograms; } FRAME_PHASES[] = {
+        {"eink_frame_render_seconds", "Drawing between page writes", frameRender},
+        {"eink_frame_spi_seconds", "Page buffer writes to the controller", frameSpi},
+        {"eink_frame_refresh_seconds", "Panel refresh, mostly waiting on BUSY", frameRefresh},
+    };
+    for (const auto& phase : FRAME_PHASES) {
+        out.family(phase.name, "histogram", phase.help);
+        for (int w = 0; w < FRAME_WINDOWS; w++) {
+            labels.clear();
+            labels.appendf("window=\"%s\"", WINDOW_NAMES[w]);
+            out.histogram(phase.name, phase.histograms[w], labels.c_str());
+        }
+    }
+
+    // ---- Network ----
+    out.family("eink_http_requests_total", "counter", "HTTP requests, by fetch source");
+    for (int i = 0; i < httpSourceCount; i++) {
+        labels.clear();
+        labels.appendf("source=\"%s\"", httpStats[i].source);
+        out.sample("eink_http_requests_total", httpStats[i].requests, labels.c_str());
+    }
+    out.family("eink_http_errors_total", "counter", "HTTP transport failures and 4xx/5xx answers, by fetch source");
+    for (int i = 0; i < httpSourceCount; i++) {
+        labels.clear();
+        labels.appendf("source=\"%s\"", httpStats[i].source);
+        out.sample("eink_http_errors_total", httpStats[i].errors, labels.c_str());
+    }
+    out.family("eink_http_body_bytes_total", "counter", "Content-Length of HTTP responses, by fetch source");
+    for (int i = 0; i < httpSourceCount; i++) {
+        labels.clear();
+        labels.appendf("source=\"%s\"", httpStats[i].source);
+        out.sample("eink_http_body_bytes_total", httpStats[i].bytes, labels.c_str());
+    }
+    out.family("eink_http_latency_seconds", "histogram", "Request sent to response headers, by fetch source");
+    for (int i = 0; i < httpSourceCount; i++) {
+        labels.clear();
+        labels.appendf("source=\"%s\"", httpStats[i].source);
+        out.histogram("eink_http_latency_seconds", httpStats[i].latency, labels.c_str());
+    }
+
+    out.family("eink_fetch_attempts_total", "counter", "Scheduler fetch attempts, by source");
+    for (int i = 0; i < scheduler.sourceCount(); i++) {
+        labels.clear();
+        labels.appendf("source=\"%s\"", scheduler.getSource(i).name);
+        out.sample("eink_fetch_attempts_total", scheduler.getSource(i).attempts, labels.c_str());
+    }
+    out.family("eink_fetch_successes_total", "counter", "Scheduler fetch successes, by source");
+    for (int i = 0; i < scheduler.sourceCount(); i++) {
+        labels.clear();
+        labels.appendf("source=\"%s\"", scheduler.getSource(i).name);
+        out.sample("eink_fetch_successes_total", scheduler.getSource(i).successes, labels.c_str());
+    }
+    out.family("eink_fetch_fresh", "gauge", "1 while a source's data is within its TTL");
+    for (int i = 0; i < scheduler.sourceCount(); i++) {
+        labels.clear();
+        labels.appendf("source=\"%s\"", scheduler.getSource(i).name);
+        out.sample("eink_fetch_fresh", scheduler.isFresh(i), labels.c_str());
+    }
+
+    const SyncStats& sync = ContentSync::getStats();
+    uint32_t pageSyncs = sync.downloads + sync.skipped + sync.tileUpdates;
+    out.family("eink_content_requests_total", "counter", "Manifest and page requests");
+    out.sample("eink_content_requests_total", sync.requests);
+    out.family("eink_content_body_bytes_total", "counter", "Manifest and page body bytes received");
+    out.sample("eink_content_body_bytes_total", sync.bytes);
+    out.family("eink_manifest_not_modified_total", "counter", "Manifest fetches answered with 304");
+    out.sample("eink_manifest_not_modified_total", sync.notModified);
+    out.family("eink_page_syncs_total", "counter", "Page syncs, by how they were satisfied");
+    out.sample("eink_page_syncs_total", sync.downloads, "result=\"download\"");
+    out.sample("eink_page_syncs_total", sync.tileUpdates, "result=\"tiles\"");
+    out.sample("eink_page_syncs_total", sync.skipped, "result=\"cached\"");
+    out.family("eink_page_cache_hit_ratio", "gauge", "Share of page syncs served from the local copy");
+    out.sample("eink_page_cache_hit_ratio", pageSyncs ? (double)sync.skipped / pageSyncs : 0);
+
+    out.family("eink_wifi_connected", "gauge", "1 while associated");
+    out.sample("eink_wifi_connected", wifiConnected);
+    out.family("eink_wifi_rssi_dbm", "gauge", "Signal strength");
+    out.sample("eink_wifi_rssi_dbm", wifiConnected ? WiFi.RSSI() : 0);
+    out.family("eink_wifi_disconnects_total", "counter", "Connection losses seen by loop()");
+    out.sample("eink_wifi_disconnects_total", wifiDisconnects);
+    out.family("eink_wifi_reconnects_total", "counter", "Connections regained after a loss");
+    out.sample("eink_wifi_reconnects_total", wifiReconnects);
+
+    // ---- Memory ----
+    uint32_t lowestLargest = HeapTelemetry::minLargestBlock();
+    out.family("eink_heap_free_bytes", "gauge", "Free heap");
+    out.sample("eink_heap_free_bytes", ESP.getFreeHeap());
+    out.family("eink_heap_min_free_bytes", "gauge", "Free heap low-water mark");
+    out.sample("eink_heap_min_free_bytes", ESP.getMinFreeHeap());
+    out.family("eink_heap_largest_block_bytes", "gauge", "Largest free block");
+    out.sample("eink_heap_largest_block_bytes", ESP.getMaxAllocHeap());
+    out.family("eink_heap_min_largest_block_bytes", "gauge", "Smallest largest free block seen");
+    out.sample("eink_heap_min_largest_block_bytes", lowestLargest != UINT32_MAX ? lowestLargest : ESP.getMaxAllocHeap());
+    out.family("eink_arena_peak_bytes", "gauge", "Refresh arena high-water mark");
+    out.sample("eink_arena_peak_bytes", RefreshArena::peak());
+    out.family("eink_heap_allocs_total", "counter", "Heap allocations, by subsystem");
+    for (int t = 0; t < HEAP_TAG_COUNT; t++) {
+        labels.clear();
+        labels.appendf("subsystem=\"%s\"", HeapTelemetry::tagName((HeapTag)t));
+        out.sample("eink_heap_allocs_total", HeapTelemetry::getStats((HeapTag)t).allocs, labels.c_str());
+    }
+    out.family("eink_heap_alloc_bytes_total", "counter", "Bytes requested from the heap, by subsystem");
+    for (int t = 0; t < HEAP_TAG_COUNT; t++) {
+        labels.clear();
+        labels.appendf("subsystem=\"%s\"", HeapTelemetry::tagName((HeapTag)t));
+        out.sample("eink_heap_alloc_bytes_total", HeapTelemetry::getStats((HeapTag)t).bytes, labels.c_str());
+    }
+    out.family("eink_heap_retained_bytes", "gauge", "Free heap lost across a subsystem's scopes, summed");
+    for (int t = 0; t < HEAP_TAG_COUNT; t++) {
+        labels.clear();
+        labels.appendf("subsystem=\"%s\"", HeapTelemetry::tagName((HeapTag)t));
+        out.sample("eink_heap_retained_bytes", HeapTelemetry::getStats((HeapTag)t).retained, labels.c_str());
+    }
+
+    // ---- NFC ----
+    out.family("eink_nfc_events_total", "counter", "NFC task events, by kind");
+    for (int e = 0; e < NFC_EVENT_TYPES; e++) {
+        labels.clear();
+        labels.appendf("event=\"%s\"", NFC_EVENT_NAMES[e]);
+        out.sample("eink_nfc_events_total", nfcEvents[e], labels.c_str());
+    }
+    out.family("eink_nfc_operation_seconds", "histogram", "Tag arrival to provisioning result, or one reader session");
+    out.histogram("eink_nfc_operation_seconds", nfcOperation);
+
+    out.finish();
+}
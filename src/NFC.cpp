@@ -1,8 +1,49 @@
 #include "NFC.h"
+#include "HeapTelemetry.h"
+#include "Ndef.h"
+#include "Config.h"
+#include <Preferences.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+static const uint32_t NFC_TASK_STACK = 6144;   // readTag keeps a 256-byte URI on the stack
+static const UBaseType_t NFC_TASK_PRIORITY = 1;
+static const BaseType_t NFC_TASK_CORE = 0;     // Arduino loop() runs on core 1
+static const UBaseType_t NFC_EVENT_QUEUE_LEN = 8;
+static const uint16_t NFC_DETECT_TIMEOUT_MS = 50;
+
+static SemaphoreHandle_t irqSemaphore = nullptr;
+
+static uint32_t fnv1a(const uint8_t* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void IRAM_ATTR onNfcIrq() {
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(irqSemaphore, &woken);
+    portYIELD_FROM_ISR(woken);
+}
 
 NFCManager::NFCManager(uint8_t sda, uint8_t scl) : 
-    nfc(PN532_IRQ, PN532_RESET),
-    initialized(false) {
+    nfc(NFC_IRQ_PIN, PN532_RESET),
+    initialized(false),
+    _exchanges(0),
+    _url(nullptr),
+    _urlChanged(false),
+    _benchRequested(false),
+    _bench(),
+    _events(nullptr),
+    _uidLength(0),
+    _tagPresent(false),
+    _savedUidLength(0),
+    _savedHash(0),
+    _writeCount(0),
+    _busyMs(0) {
     Wire.begin(sda, scl);
 }
 
@@ -16,44 +57,61 @@ void NFCManager::printHex(const uint8_t *data, uint32_t numBytes) {
 }
 
 bool NFCManager::writePages(uint8_t startPage, const uint8_t *data, uint16_t length) {
+    // NTAG has no multi-page write; the tag ACKs each page once it is committed
     uint16_t pages = length / 4;
     for (uint16_t p = 0; p < pages; p++) {
         uint8_t pageBuf[4];
         memcpy(pageBuf, data + (p * 4), 4);
+        _exchanges++;
         if (!nfc.ntag2xx_WritePage(startPage + p, pageBuf)) {
             Serial.print("Failed writing page "); Serial.println(startPage + p);
             return false;
         }
-        delay(5);
     }
     return true;
 }
 
-bool NFCManager::readPages(uint8_t startPage, uint8_t numPages, uint8_t *outBuffer) {
-    const uint8_t maxRetries = 3;
+bool NFCManager::readBlock(uint8_t page, uint8_t *out16) {
+    uint8_t cmd[2] = {NTAG_CMD_READ, page};
     
-    for (uint8_t p = 0; p < numPages; p++) {
-        uint8_t pageBuf[4];
-        bool pageRead = false;
-        
-        for (uint8_t retry = 0; retry < maxRetries && !pageRead; retry++) {
-            if (retry > 0) {
-                delay(50);  // Wait between retries
-                Serial.print("Retry "); Serial.print(retry); Serial.print(" for page "); Serial.println(startPage + p);
-            }
-            
-            if (nfc.ntag2xx_ReadPage(startPage + p, pageBuf)) {
-                pageRead = true;
-            }
-        }
-        
-        if (!pageRead) {
-            Serial.print("Failed reading page "); Serial.println(startPage + p);
-            return false;
-        }
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+        uint8_t len = 16;
+        _exchanges++;
+        if (nfc.inDataExchange(cmd, sizeof(cmd), out16, &len) && len == 16) return true;
+    }
+    Serial.print("Failed reading block at page "); Serial.println(page);
+    return false;
+}
+
+bool NFCManager::fastRead(uint8_t startPage, uint8_t numPages, uint8_t *outBuffer) {
+    while (numPages > 0) {
+        uint8_t chunk = numPages < FAST_READ_MAX_PAGES ? numPages : FAST_READ_MAX_PAGES;
+        uint8_t cmd[3] = {NTAG_CMD_FAST_READ, startPage, (uint8_t)(startPage + chunk - 1)};
+        uint8_t len = chunk * 4;
+        _exchanges++;
+        if (!nfc.inDataExchange(cmd, sizeof(cmd), outBuffer, &len) || len != chunk * 4) return false;
         
-        memcpy(outBuffer + (p * 4), pageBuf, 4);
-        delay(10);  // Small delay between pages
+        startPage += chunk;
+        numPages -= chunk;
+        outBuffer += chunk * 4;
+    }
+    return true;
+}
+
+bool NFCManager::readPages(uint8_t startPage, uint8_t numPages, uint8_t *outBuffer) {
+    if (fastRead(startPage, numPages, outBuffer)) return true;
+    
+    // No FAST_READ (e.g. Ultralight/NTAG203): the NAK dropped the tag to IDLE, so
+    // reselect it and fall back to 16-byte READs
+    uint8_t uid[7];
+    uint8_t uidLength;
+    if (!nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, 100)) return false;
+    
+    for (uint8_t p = 0; p < numPages; p += 4) {
+        uint8_t block[16];
+        if (!readBlock(startPage + p, block)) return false;
+        uint8_t pages = numPages - p < 4 ? numPages - p : 4;
+        memcpy(outBuffer + (p * 4), block, pages * 4);
     }
     return true;
 }
@@ -85,7 +143,279 @@ bool NFCManager::isTagPresent(uint32_t timeout) {
     return nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, timeout);
 }
 
+bool NFCManager::startTask(const char* url) {
+    if (_events) return true;
+    _url = url;
+    _events = xQueueCreate(NFC_EVENT_QUEUE_LEN, sizeof(NfcEvent));
+    if (!_events) return false;
+
+    if (NFC_IRQ_PIN >= 0) {
+        irqSemaphore = xSemaphoreCreateBinary();
+        pinMode(NFC_IRQ_PIN, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(NFC_IRQ_PIN), onNfcIrq, FALLING);
+    }
+    return xTaskCreatePinnedToCore(taskEntry, "nfc", NFC_TASK_STACK, this,
+                                   NFC_TASK_PRIORITY, nullptr, NFC_TASK_CORE) == pdPASS;
+}
+
+bool NFCManager::pollEvent(NfcEvent& event) {
+    return _events && xQueueReceive(_events, &event, 0) == pdTRUE;
+}
+
+void NFCManager::post(NfcEventType type, uint32_t tookMs) {
+    NfcEvent event;
+    event.type = type;
+    memcpy(event.uid, _uid, sizeof(_uid));
+    event.uidLength = _uidLength;
+    event.atMs = millis();
+    event.tookMs = tookMs;
+    xQueueSend(_events, &event, 0);   // Dropped if loop() has fallen this far behind
+}
+
+void NFCManager::setURL(const char* url) {
+    _url = url;
+    _urlChanged = true;   // Picked up by the task between reader sessions
+}
+
+bool NFCManager::requestBench() {
+    if (!_events || !initialized) return false;
+    // Picked up after the task's current wait. Waking it early would read a
+    // detection the PN532 hasn't answered yet.
+    _benchRequested = true;
+    return true;
+}
+
+// Times NFC_BENCH_READS reads of the first user pages; the tag must still be selected
+void NFCManager::timeReads(NfcReadTiming& timing, bool fast) {
+    uint8_t buf[FAST_READ_MAX_PAGES * 4];
+    uint32_t totalUs = 0;
+    timing.pages = fast ? FAST_READ_MAX_PAGES : 4;
+    for (uint32_t i = 0; i < NFC_BENCH_READS; i++) {
+        uint32_t start = micros();
+        bool ok = fast ? fastRead(4, FAST_READ_MAX_PAGES, buf) : readBlock(4, buf);
+        uint32_t took = micros() - start;
+        if (!ok) {
+            // A NAK (e.g. no FAST_READ) drops the tag to IDLE; reselect before going on
+            timing.failures++;
+            uint8_t uid[7], uidLength;
+            if (!nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, NFC_DETECT_TIMEOUT_MS)) return;
+            continue;
+        }
+        timing.count++;
+        totalUs += took;
+        if (took > timing.maxUs) timing.maxUs = took;
+    }
+    if (timing.count) timing.avgUs = totalUs / timing.count;
+}
+
+void NFCManager::runBench() {
+    _bench = NfcBenchResult();
+    uint8_t uid[7], uidLength;
+    unsigned long started = millis();
+    do {
+        uint32_t start = micros();
+        _bench.tagFound = nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, NFC_DETECT_TIMEOUT_MS);
+        _bench.selectUs = micros() - start;
+    } while (!_bench.tagFound && millis() - started < NFC_BENCH_TAG_WAIT_MS);
+    if (!_bench.tagFound) return;
+
+    timeReads(_bench.read, false);
+    timeReads(_bench.fastRead, true);
+}
+
+void NFCManager::taskEntry(void* arg) {
+    static_cast<NFCManager*>(arg)->taskLoop();
+}
+
+bool NFCManager::waitForTag(uint32_t intervalMs) {
+    // With the IRQ wired, sleep until the PN532 reports a tag in the field; still
+    // poll while one is present, since removal raises no interrupt
+    if (NFC_IRQ_PIN >= 0 && !_tagPresent) {
+        if (!nfc.startPassiveTargetIDDetection(PN532_MIFARE_ISO14443A)) {
+            vTaskDelay(pdMS_TO_TICKS(intervalMs));
+            return false;
+        }
+        // Every PN532 response pulls IRQ low, so drop edges left over from earlier
+        // exchanges; a response already pending shows as the line still being low
+        xSemaphoreTake(irqSemaphore, 0);
+        if (digitalRead(NFC_IRQ_PIN) != LOW) xSemaphoreTake(irqSemaphore, portMAX_DELAY);
+        return nfc.readDetectedPassiveTargetID(_uid, &_uidLength);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(intervalMs));
+    return nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, _uid, &_uidLength, NFC_DETECT_TIMEOUT_MS);
+}
+
+void NFCManager::taskLoop() {
+    loadProvisioned();
+    if (!begin()) {
+        post(NFC_EVENT_INIT_FAILED);
+        vTaskDelete(nullptr);
+        return;
+    }
+    post(NFC_EVENT_READY);
+
+#if NFC_EMULATE_TAG
+    emulateLoop();
+#endif
+
+    uint32_t interval = NFC_POLL_MIN_MS;
+    uint8_t lastUid[7] = {0};
+    uint8_t lastUidLength = 0;
+
+    for (;;) {
+        bool found = waitForTag(interval);
+
+        // Any detection has been answered by now, so the bench has the PN532 to itself
+        if (_benchRequested) {
+            _benchRequested = false;
+            runBench();
+            post(NFC_EVENT_BENCH_DONE);
+        }
+
+        if (!found) {
+            if (_tagPresent) {
+                _tagPresent = false;
+                post(NFC_EVENT_TAG_REMOVED);
+            }
+            // Nobody is tapping: back off to save I2C traffic and RF power
+            interval = interval * 2 < NFC_POLL_MAX_MS ? interval * 2 : NFC_POLL_MAX_MS;
+            continue;
+        }
+        interval = NFC_POLL_MIN_MS;
+
+        // Handle each tag once per visit to the reader
+        bool sameTag = _tagPresent && _uidLength == lastUidLength && memcmp(_uid, lastUid, _uidLength) == 0;
+        if (sameTag) continue;
+        _tagPresent = true;
+        memcpy(lastUid, _uid, sizeof(lastUid));
+        lastUidLength = _uidLength;
+        post(NFC_EVENT_TAG_ARRIVED);
+
+        // The exact bytes writeURLOnce would put on the tag
+        unsigned long started = millis();
+        NdefWriter writer(_tagBuf, sizeof(_tagBuf));
+        writer.addUri(_url);
+        uint16_t length = writer.finish();
+        uint32_t hash = fnv1a(_tagBuf, length);
+
+        bool knownTag = _savedHash == hash && _savedUidLength == _uidLength &&
+                        memcmp(_savedUid, _uid, _uidLength) == 0;
+        _exchanges = 0;
+        if (knownTag && confirmProvisioned(_tagBuf, length)) {
+            uint32_t took = millis() - started;
+            _busyMs += took;
+            Serial.printf("🏷️ Known tag confirmed in %lu ms (%u exchanges)\n", (unsigned long)took, _exchanges);
+            post(NFC_EVENT_TAG_CURRENT, took);
+            continue;
+        }
+
+        String current;
+        NfcEventType result;
+        if (readTag(current) && current == _url) {
+            result = NFC_EVENT_TAG_CURRENT;
+            saveProvisioned(hash, true);
+        } else {
+            uint32_t writesBefore = _writeCount;
+            bool ok = writeURLOnce(_url, NFC_WRITE_ATTEMPTS);
+            result = ok ? NFC_EVENT_TAG_WRITTEN : NFC_EVENT_WRITE_FAILED;
+            if (ok || _writeCount != writesBefore) saveProvisioned(hash, ok);
+        }
+        uint32_t took = millis() - started;
+        _busyMs += took;
+        post(result, took);
+    }
+}
+
+void NFCManager::emulateLoop() {
+    _urlChanged = true;
+    uint8_t apdu[64];
+    uint8_t response[Type4Tag::MAX_READ + 2];
+
+    for (;;) {
+        if (_benchRequested) {
+            _benchRequested = false;
+            _bench = NfcBenchResult();    // The PN532 is a target here, it can't read tags
+            post(NFC_EVENT_BENCH_DONE);
+        }
+
+        if (_urlChanged) {
+            _urlChanged = false;
+            if (!_emulated.setUri(_url)) Serial.println("⚠️ URL too long for the emulated tag");
+        }
+
+        // TgInitAsTarget: false until a reader activates us
+        if (!nfc.AsTarget()) {
+            vTaskDelay(pdMS_TO_TICKS(NFC_POLL_MIN_MS));
+            continue;
+        }
+
+        _emulated.reset();
+        unsigned long started = millis();
+        uint16_t apdus = 0;
+        for (;;) {
+            uint8_t length = sizeof(apdu);
+            if (!nfc.getDataTarget(apdu, &length)) break;   // Reader left the field
+            size_t responseLength = _emulated.process(apdu, length, response, sizeof(response));
+            apdus++;
+            if (!nfc.setDataTarget(response, responseLength)) break;
+        }
+
+        if (_emulated.served()) {
+            uint32_t took = millis() - started;
+            _busyMs += took;
+            Serial.printf("📡 URL served to a reader in %lu ms (%u APDUs)\n", (unsigned long)took, apdus);
+            post(NFC_EVENT_URL_SERVED, took);
+        }
+    }
+}
+
+void NFCManager::loadProvisioned() {
+    Preferences prefs;
+    if (!prefs.begin("nfc", true)) return;
+    _writeCount = prefs.getUInt("writes", 0);
+    _savedHash = prefs.getUInt("hash", 0);
+    _savedUidLength = prefs.getBytes("uid", _savedUid, sizeof(_savedUid));
+    prefs.end();
+}
+
+void NFCManager::saveProvisioned(uint32_t hash, bool verified) {
+    // A failed write leaves the content unknown: forget the tag so it is read in full next time
+    memcpy(_savedUid, _uid, sizeof(_savedUid));
+    _savedUidLength = verified ? _uidLength : 0;
+    _savedHash = verified ? hash : 0;
+
+    Preferences prefs;
+    if (!prefs.begin("nfc", false)) return;
+    prefs.putUInt("writes", _writeCount);
+    prefs.putUInt("hash", _savedHash);
+    prefs.putBytes("uid", _savedUid, _savedUidLength);
+    prefs.end();
+}
+
+bool NFCManager::confirmProvisioned(const uint8_t* expected, uint16_t length) {
+    // One READ of page 3 returns the capability container plus the first 12 bytes
+    // of NDEF data (TLV header and record header); FAST_READs cover the rest, so
+    // the whole TLV is compared in 2 exchanges up to 60 bytes
+    uint8_t block[16];
+    if (!readBlock(CC_PAGE, block)) return false;
+    if (ndefTagDataSize(block) < length) return false;
+
+    uint16_t headLength = length < 12 ? length : 12;
+    if (memcmp(block + 4, expected, headLength) != 0) return false;
+
+    uint8_t chunk[FAST_READ_MAX_PAGES * 4];
+    for (uint16_t offset = headLength; offset < length; offset += sizeof(chunk)) {
+        uint16_t remaining = length - offset;
+        uint16_t bytes = remaining < sizeof(chunk) ? remaining : sizeof(chunk);
+        if (!readPages(4 + offset / 4, (bytes + 3) / 4, chunk)) return false;
+        if (memcmp(chunk, expected + offset, bytes) != 0) return false;
+    }
+    return true;
+}
+
 bool NFCManager::writeURLOnce(const char* url, uint32_t maxAttempts) {
+    HeapScope heapScope(HEAP_NFC);
     if (!initialized) {
         if (!begin()) return false;
     }
@@ -94,6 +424,15 @@ bool NFCManager::writeURLOnce(const char* url, uint32_t maxAttempts) {
     uint8_t uidLength;
     uint32_t attempts = 0;
 
+    // Dry run for the size: same encoding as the real write below
+    NdefWriter sizing(_tagBuf, sizeof(_tagBuf));
+    sizing.addUri(url);
+    size_t total = sizing.finish();
+    if (total == 0) {
+        Serial.println("❌ URL too long for an NDEF tag");
+        return false;
+    }
+
     Serial.println("Place your NFC tag to write...");
     
     for (attempts = 0; attempts < maxAttempts; attempts++) {
@@ -124,42 +463,34 @@ bool NFCManager::writeURLOnce(const char* url, uint32_t maxAttempts) {
         Serial.println("Tag contains a different URL, overwriting...");
     }
 
-    // Build an NDEF URI record
-    const uint8_t urlLen = strlen(url);
-    const uint8_t uriIdCode = 0x00; // No prefix
-
-    uint8_t payloadLen = 1 + urlLen;     // identifier code + url bytes
-    uint8_t ndefHeaderLen = 4;
-    uint8_t tlvHeaderLen = 2;
-    uint16_t totalPayload = tlvHeaderLen + ndefHeaderLen + payloadLen + 1;
-    uint16_t paddedTotal = totalPayload;
-    if (paddedTotal % 4 != 0) paddedTotal += (4 - (paddedTotal % 4));
-
-    uint8_t buf[paddedTotal];
-    memset(buf, 0x00, paddedTotal);
-
-    uint16_t idx = 0;
-    buf[idx++] = 0x03;              // TLV tag - NDEF
-    buf[idx++] = (uint8_t)(ndefHeaderLen + payloadLen);
-    buf[idx++] = 0xD1;              // NDEF header
-    buf[idx++] = 0x01;              // Type Length = 1
-    buf[idx++] = payloadLen;        // Payload Length
-    buf[idx++] = 'U';               // Type 'U' for URI
-    buf[idx++] = uriIdCode;         // URI Identifier Code
-    
-    memcpy(buf + idx, url, urlLen);
-    idx += urlLen;
-    buf[idx++] = 0xFE;              // Terminator TLV
+    // Refuse up front if the message can't fit this tag's data area
+    uint8_t cc[16];
+    if (!readBlock(CC_PAGE, cc)) {
+        Serial.println("Failed to read capability container, retrying...");
+        delay(1000);
+        continue;
+    }
+    size_t tagCapacity = ndefTagDataSize(cc);
+    if (total > tagCapacity) {
+        Serial.printf("❌ NDEF message needs %u bytes, tag holds %u\n", (unsigned)total, (unsigned)tagCapacity);
+        return false;
+    }
 
-    if (!writePages(4, buf, paddedTotal)) {
+    // readTag above reused the buffer, so encode right before writing
+    NdefWriter writer(_tagBuf, sizeof(_tagBuf));
+    writer.addUri(url);
+    writer.finish();
+
+    unsigned long writeStart = millis();
+    _exchanges = 0;
+    if (!writePages(4, _tagBuf, total)) {
         Serial.println("Failed to write NDEF message, retrying...");
         attempts++;
         delay(1000);
         continue;
     }
-
-    // Add delay after writing before verification
-    delay(100);  // Give the tag time to stabilize
+    _writeCount++;
+    Serial.printf("✏️ Tag written in %lu ms (%u pages, write #%u)\n", millis() - writeStart, _exchanges, _writeCount);
 
     if (!verifyURL(url)) {
         Serial.println("Failed to verify written URL, retrying...");
@@ -177,6 +508,7 @@ bool NFCManager::writeURLOnce(const char* url, uint32_t maxAttempts) {
 }
 
 bool NFCManager::readTag(String& url) {
+    HeapScope heapScope(HEAP_NFC);
     if (!initialized) {
         if (!begin()) return false;
     }
@@ -188,42 +520,54 @@ bool NFCManager::readTag(String& url) {
         return false;
     }
 
-    uint8_t header[16];
-    if (!readPages(4, 4, header)) {
+    unsigned long startTime = millis();
+    _exchanges = 0;
+
+    // Pages 4-7 in one READ: the TLV header and the start of the record
+    uint8_t* data = _tagBuf;
+    if (!readBlock(4, data)) {
         return false;
     }
 
-    if (header[0] != 0x03) {
+    // The TLV header (1- or 3-byte length) may follow lock/memory control TLVs
+    size_t needed = NdefReader::requiredBytes(data, 16);
+    if (needed == 0 || needed > sizeof(_tagBuf)) {
         return false;
     }
 
-    uint8_t ndefLength = header[1];
-    uint8_t totalToRead = ndefLength + 2;
-    uint8_t pagesNeeded = (totalToRead + 3) / 4;
-
-    uint8_t data[pagesNeeded * 4];
-    if (!readPages(4, pagesNeeded, data)) {
-        return false;
+    // Fetch only what the first block didn't cover, in as few exchanges as possible
+    if (needed > 16) {
+        uint8_t morePages = (needed - 16 + 3) / 4;
+        if (!readPages(8, morePages, data + 16)) {
+            return false;
+        }
     }
 
-    if (data[2] == 0xD1 && data[5] == 'U') {
-        uint8_t payloadLength = data[4];
-        uint8_t uriIdCode = data[6];
-        
-        url = "";
-        for (uint8_t i = 0; i < payloadLength - 1; i++) {
-            url += (char)data[7 + i];
+    // First URI record wins; other record types (text, app records) are skipped
+    const uint8_t* message;
+    size_t messageLength;
+    bool found = false;
+    if (NdefReader::findMessage(data, needed, message, messageLength)) {
+        NdefReader reader(message, messageLength);
+        NdefRecord record;
+        char uri[MAX_URL_LENGTH];
+        while (reader.next(record)) {
+            if (ndefDecodeUri(record, uri, sizeof(uri))) {
+                url = uri;
+                found = true;
+                break;
+            }
         }
-        
-        return true;
     }
 
-    return false;
+    Serial.printf("📖 Tag read in %lu ms (%u exchanges)\n", millis() - startTime, _exchanges);
+    return found;
 }
 
 bool NFCManager::verifyURL(const char* written_url) {
     String read_url;
     const uint8_t maxVerifyRetries = 3;
+    unsigned long startTime = millis();
     
     for (uint8_t retry = 0; retry < maxVerifyRetries; retry++) {
         if (retry > 0) {
@@ -233,7 +577,7 @@ bool NFCManager::verifyURL(const char* written_url) {
         
         if (readTag(read_url)) {
             if (read_url == written_url) {
-                Serial.println("✅ URL verified successfully!");
+                Serial.printf("✅ URL verified successfully in %lu ms!\n", millis() - startTime);
                 return true;
             }
         }
@@ -1,84 +1,281 @@
 #include "NTP.h"
 #include <Arduino.h>
+#include <Preferences.h>
+#include <esp_sntp.h>
+#include <esp_timer.h>
+#include <sys/time.h>
+#include "Config.h"
 
-NTPClient::NTPClient() : timeReceived(false) {}
+// Survive deep sleep and soft resets; NVS keeps the drift across power loss
+static const uint32_t RTC_MAGIC = 0x4E545031;   // "NTP1"
+RTC_NOINIT_ATTR static uint32_t rtcMagic;
+RTC_NOINIT_ATTR static float rtcDriftPpm;
+RTC_NOINIT_ATTR static uint32_t rtcLastSync;    // Epoch seconds of the last SNTP sync
+
+// Written by the SNTP callback (lwIP task), picked up by update()
+static volatile bool syncPending = false;
+static volatile unsigned long syncedAtMs = 0;
+static int64_t lastSyncEpochUs = 0;             // Previous sync of this boot, paired with...
+static int64_t lastSyncMonoUs = 0;              // ...the monotonic clock at that moment
+static float driftPpm = 0.0f;                   // Positive: local clock runs fast
+static bool driftKnown = false;
+static uint32_t syncCount = 0;
+static unsigned long validAtMs = 0;
+static const char* validSource = nullptr;
+
+// Minute cache: set by the boundary timer or a clock jump, consumed by tick()
+static esp_timer_handle_t minuteTimer = nullptr;
+static volatile bool minuteElapsed = true;
+static uint32_t localTimeCalls = 0;
+
+static void onMinuteBoundary(void*) {
+    minuteElapsed = true;
+}
+
+// One NTP exchange on the wire: 48-byte payload + UDP + IPv4 headers, both ways
+static const uint32_t NTP_BYTES_PER_SYNC = 2 * (48 + 8 + 20);
+
+// POSIX TZ offsets are west-positive, e.g. IST (+5:30) is "UTC-05:30". A daylight
+// offset adds a "DST" zone on the libc default rules, as configTime() does.
+static void setTimeZone(long gmtOffset, int daylightOffset) {
+    long west = -gmtOffset, westDst = west - daylightOffset;
+    char tz[48];   // Two offsets with a full long's worth of hours, so nothing is cut
+    int length = snprintf(tz, sizeof(tz), "UTC%c%02ld:%02ld", west < 0 ? '-' : '+',
+                          labs(west) / 3600, (labs(west) % 3600) / 60);
+    if (daylightOffset && length > 0 && (size_t)length < sizeof(tz)) {
+        snprintf(tz + length, sizeof(tz) - length, "DST%c%02ld:%02ld", westDst < 0 ? '-' : '+',
+                 labs(westDst) / 3600, (labs(westDst) % 3600) / 60);
+    }
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+NTPClient::NTPClient()
+    : timeReceived(false), _ntpServer("pool.ntp.org"), _gmtOffset(19800), _daylightOffset(0),
+      _timeStr("00:00"), _dateStr("00-00-0000"), _dayStr("Unknown") {}
+
+bool NTPClient::restoreClock() {
+    // Drift coefficient and last sync from RTC memory after deep sleep/reboot, otherwise from NVS
+    uint32_t lastSync = 0;
+    if (rtcMagic == RTC_MAGIC) {
+        driftPpm = rtcDriftPpm;
+        driftKnown = true;
+        lastSync = rtcLastSync;
+    } else {
+        Preferences prefs;
+        if (prefs.begin("ntp", true)) {
+            if (prefs.isKey("drift")) {
+                driftPpm = prefs.getFloat("drift", 0.0f);
+                driftKnown = true;
+            }
+            lastSync = prefs.getUInt("last", 0);
+            prefs.end();
+        }
+    }
+
+    // The RTC keeps system time across deep sleep and soft resets, just not power loss
+    time_t now = time(nullptr);
+    if (now < MIN_VALID_EPOCH) return false;
+
+    // A clock behind the last sync we saw is left over from a bad reset, not kept time
+    if ((uint32_t)now < lastSync) {
+        Serial.printf("⚠️ RTC time is %lu s before the last sync, waiting for SNTP\n",
+                      (unsigned long)(lastSync - (uint32_t)now));
+        struct timeval unset = {0, 0};
+        settimeofday(&unset, nullptr);
+        return false;
+    }
+
+    setTimeZone(_gmtOffset, _daylightOffset);
+    minuteElapsed = true;
+    markValid("RTC", millis());
+    return true;
+}
 
 void NTPClient::begin(const char* ntpServer, long gmtOffset, int daylightOffset) {
     _ntpServer = ntpServer;
     _gmtOffset = gmtOffset;
     _daylightOffset = daylightOffset;
-    
-    // Configure multiple NTP servers for better reliability
-    configTime(_gmtOffset, _daylightOffset, 
-              "pool.ntp.org",          // Primary
+
+    // Syncs complete in the background; onTimeSync reports each one
+    sntp_set_time_sync_notification_cb(onTimeSync);
+    applySyncInterval();
+    configTime(_gmtOffset, _daylightOffset,
+              _ntpServer,              // Primary
               "time.google.com",       // Backup 1
               "time.windows.com");     // Backup 2
-              
+    setTimeZone(_gmtOffset, _daylightOffset);
+
     Serial.println("⏰ Configured NTP servers:");
-    Serial.println(" - pool.ntp.org");
+    Serial.printf(" - %s\n", _ntpServer);
     Serial.println(" - time.google.com");
     Serial.println(" - time.windows.com");
 }
 
-bool NTPClient::update() {
-    const int maxRetries = 3;
-    int retryCount = 0;
-    
-    while (retryCount < maxRetries) {
-        struct tm timeinfo;
-        Serial.printf("⏰ Attempting to sync time (attempt %d/%d)...\n", retryCount + 1, maxRetries);
-        
-        if(getLocalTime(&timeinfo)) {
-            char strftime_buf[64];
-            strftime(strftime_buf, sizeof(strftime_buf), "%c", &timeinfo);
-            Serial.print("✅ Time synchronized: ");
-            Serial.println(strftime_buf);
-            timeReceived = true;
-            return true;
+void NTPClient::onTimeSync(struct timeval* tv) {
+    // Runs on the lwIP task: bookkeeping only, no logging or flash writes
+    int64_t monoUs = esp_timer_get_time();
+    int64_t epochUs = (int64_t)tv->tv_sec * 1000000LL + tv->tv_usec;
+
+    // Drift = how far the local clock ran ahead of NTP since the previous sync this boot
+    if (lastSyncMonoUs != 0) {
+        int64_t trueUs = epochUs - lastSyncEpochUs;
+        if (trueUs >= (int64_t)NTP_MIN_SYNC_INTERVAL_MS * 1000LL / 2) {
+            float ppm = (float)(monoUs - lastSyncMonoUs - trueUs) * 1e6f / (float)trueUs;
+            driftPpm = driftKnown ? 0.7f * driftPpm + 0.3f * ppm : ppm;
+            driftKnown = true;
         }
-        
-        Serial.printf("⚠️ Failed to obtain time (attempt %d/%d)\n", retryCount + 1, maxRetries);
-        retryCount++;
-        delay(2000); // Wait 2 seconds before retry
-        
-        // Force NTP resync on retry
-        configTime(_gmtOffset, _daylightOffset, 
-                  "pool.ntp.org",
-                  "time.google.com",
-                  "time.windows.com");
     }
-    
-    Serial.println("❌ Failed to obtain time after all retries");
+    lastSyncEpochUs = epochUs;
+    lastSyncMonoUs = monoUs;
+    syncCount++;
+
+    rtcDriftPpm = driftPpm;
+    rtcLastSync = tv->tv_sec;
+    rtcMagic = driftKnown ? RTC_MAGIC : 0;
+
+    syncedAtMs = millis();
+    syncPending = true;
+    minuteElapsed = true;   // The clock may have jumped
+}
+
+bool NTPClient::update() {
+    // SNTP runs in the background; this only picks up what its callback recorded
+    if (syncPending) {
+        syncPending = false;
+        markValid("SNTP", syncedAtMs);
+        Serial.printf("✅ Time synchronized (sync #%u, drift %s%.2f ppm)\n",
+                      syncCount, driftKnown ? "" : "unknown, ", driftPpm);
+        applySyncInterval();
+        saveDrift();
+    }
+
+    if (timeReceived) return true;
+
+    // Still unsynced: ask for a request now rather than waiting out the SNTP interval
+    Serial.println("⚠️ Time not synchronized yet");
+    if (sntp_enabled()) sntp_restart();
     return false;
 }
 
-String NTPClient::getTimeString() {
-    struct tm timeinfo;
-    if (!getLocalTime(&timeinfo)) return "00:00";
-    
-    char buffer[6];
-    strftime(buffer, sizeof(buffer), "%H:%M", &timeinfo);
-    return String(buffer);
+void NTPClient::markValid(const char* source, unsigned long atMs) {
+    if (timeReceived) return;
+    timeReceived = true;
+    validAtMs = atMs;
+    validSource = source;
+    Serial.printf("⏱️ Clock valid %lu ms after boot (%s)\n", atMs, source);
 }
 
-String NTPClient::getDateString() {
+void NTPClient::applySyncInterval() {
+    // Resync before the measured drift could put the clock NTP_MAX_CLOCK_ERROR_MS off
+    unsigned long interval = NTP_MIN_SYNC_INTERVAL_MS;
+    if (driftKnown) {
+        float absPpm = fabsf(driftPpm);
+        float ms = absPpm > 0.0f ? NTP_MAX_CLOCK_ERROR_MS / (absPpm * 1e-6f) : (float)NTP_MAX_SYNC_INTERVAL_MS;
+        interval = ms >= NTP_MAX_SYNC_INTERVAL_MS ? NTP_MAX_SYNC_INTERVAL_MS
+                 : ms <= NTP_MIN_SYNC_INTERVAL_MS ? NTP_MIN_SYNC_INTERVAL_MS : (unsigned long)ms;
+    }
+    sntp_set_sync_interval(interval);
+}
+
+void NTPClient::saveDrift() {
+    if (!driftKnown) return;
+    Preferences prefs;
+    if (!prefs.begin("ntp", false)) return;
+    prefs.putFloat("drift", driftPpm);
+    prefs.putUInt("last", rtcLastSync);
+    prefs.end();
+}
+
+void NTPClient::printStats() {
+    float days = millis() / 86400000.0f;
+    if (days < 0.01f) days = 0.01f;
+
+    Serial.println("\n=== Clock Stats ===");
+    if (validSource) {
+        Serial.printf("Valid after: %lu ms (%s)\n", validAtMs, validSource);
+    } else {
+        Serial.println("Valid after: not yet");
+    }
+    Serial.printf("Syncs: %u since boot (%.1f/day, ~%.0f bytes/day)\n",
+                  syncCount, syncCount / days, syncCount * NTP_BYTES_PER_SYNC / days);
+    if (driftKnown) {
+        Serial.printf("Drift: %.2f ppm, resync every %u min\n", driftPpm, sntp_get_sync_interval() / 60000);
+    } else {
+        Serial.println("Drift: not measured yet");
+    }
+    Serial.println("===================");
+}
+
+void NTPClient::tick() {
+    if (!minuteElapsed) return;
+    minuteElapsed = false;   // Cleared first so a boundary passing while formatting isn't lost
+
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    if (tv.tv_sec < MIN_VALID_EPOCH) {
+        localTimeCalls++;
+        _timeStr = "00:00";
+        _dateStr = "00-00-0000";
+        _dayStr = "Unknown";
+        minuteElapsed = true;   // Try again next frame until the clock is set
+        return;
+    }
+    formatMinute(tv.tv_sec, tv);
+}
+
+void NTPClient::formatAt(time_t epoch) {
+    minuteElapsed = false;
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    formatMinute(epoch, tv);
+}
+
+void NTPClient::formatMinute(time_t epoch, const struct timeval& now) {
     struct tm timeinfo;
-    if (!getLocalTime(&timeinfo)) return "00-00-0000";
-    
+    localTimeCalls++;
+    localtime_r(&epoch, &timeinfo);
+
     char buffer[11];
+    strftime(buffer, sizeof(buffer), "%H:%M", &timeinfo);
+    _timeStr = buffer;
     strftime(buffer, sizeof(buffer), "%d-%m-%Y", &timeinfo);
-    return String(buffer);
+    _dateStr = buffer;
+    strftime(buffer, sizeof(buffer), "%A", &timeinfo);
+    _dayStr = buffer;
+
+    // Wake up again at the minute boundary after the one just formatted
+    if (!minuteTimer) {
+        esp_timer_create_args_t args = {};
+        args.callback = onMinuteBoundary;
+        args.name = "minute";
+        esp_timer_create(&args, &minuteTimer);
+    }
+    int64_t toNextMinuteUs = ((int64_t)(epoch - epoch % 60 + 60) - now.tv_sec) * 1000000LL - now.tv_usec;
+    esp_timer_stop(minuteTimer);
+    if (toNextMinuteUs <= 0) {
+        minuteElapsed = true;
+        return;
+    }
+    esp_timer_start_once(minuteTimer, toNextMinuteUs);
 }
 
-String NTPClient::getDayString() {
-    struct tm timeinfo;
-    if (!getLocalTime(&timeinfo)) return "Unknown";
-    
-    char buffer[10];
-    strftime(buffer, sizeof(buffer), "%A", &timeinfo);
-    return String(buffer);
+const char* NTPClient::getTimeString() const {
+    return _timeStr.c_str();
+}
+
+const char* NTPClient::getDateString() const {
+    return _dateStr.c_str();
+}
+
+const char* NTPClient::getDayString() const {
+    return _dayStr.c_str();
+}
+
+uint32_t NTPClient::getLocalTimeCalls() const {
+    return localTimeCalls;
 }
 
 bool NTPClient::isTimeValid() {
     return timeReceived;
-}
\ No newline at end of file
+}
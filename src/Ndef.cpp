@@ -0,0 +1,221 @@
+#include "Ndef.h"
+#include <string.h>
+
+// URI identifier codes (NFC Forum URI RTD), index = code
+static const char* const URI_PREFIXES[] = {
+    "", "http://www.", "https://www.", "http://", "https://", "tel:", "mailto:",
+    "ftp://anonymous:anonymous@", "ftp://ftp.", "ftps://", "sftp://", "smb://",
+    "nfs://", "ftp://", "dav://", "news:", "telnet://", "imap:", "rtsp://", "urn:",
+    "pop:", "sip:", "sips:", "tftp:", "btspp://", "btl2cap://", "btgoep://",
+    "tcpobex://", "irdaobex://", "file://", "urn:epc:id:", "urn:epc:tag:",
+    "urn:epc:pat:", "urn:epc:raw:", "urn:epc:", "urn:nfc:"
+};
+static const uint8_t URI_PREFIX_COUNT = sizeof(URI_PREFIXES) / sizeof(URI_PREFIXES[0]);
+
+NdefWriter::NdefWriter(uint8_t* buf, size_t capacity)
+    : _buf(buf), _capacity(capacity), _len(TLV_HEADER_MAX), _lastHeader(0),
+      _hasRecords(false), _overflow(capacity < TLV_HEADER_MAX) {}
+
+bool NdefWriter::put(const void* data, size_t len) {
+    if (_overflow || len > _capacity - _len) {
+        _overflow = true;
+        return false;
+    }
+    memcpy(_buf + _len, data, len);
+    _len += len;
+    return true;
+}
+
+bool NdefWriter::beginRecord(uint8_t tnf, const uint8_t* type, uint8_t typeLength, uint32_t payloadLength) {
+    // The previous record is no longer the last one
+    if (_hasRecords) _buf[_lastHeader] &= ~NDEF_ME;
+
+    bool shortRecord = payloadLength <= 0xFF;
+    uint8_t header = (_hasRecords ? 0 : NDEF_MB) | NDEF_ME | (shortRecord ? NDEF_SR : 0) | (tnf & NDEF_TNF_MASK);
+    size_t headerAt = _len;
+    if (!put(&header, 1) || !put(&typeLength, 1)) return false;
+
+    if (shortRecord) {
+        uint8_t len8 = payloadLength;
+        if (!put(&len8, 1)) return false;
+    } else {
+        uint8_t len32[4] = {(uint8_t)(payloadLength >> 24), (uint8_t)(payloadLength >> 16),
+                            (uint8_t)(payloadLength >> 8), (uint8_t)payloadLength};
+        if (!put(len32, 4)) return false;
+    }
+    if (!put(type, typeLength)) return false;
+
+    _lastHeader = headerAt;
+    _hasRecords = true;
+    return true;
+}
+
+bool NdefWriter::addRecord(uint8_t tnf, const uint8_t* type, uint8_t typeLength,
+                           const uint8_t* payload, uint32_t payloadLength) {
+    return beginRecord(tnf, type, typeLength, payloadLength) && put(payload, payloadLength);
+}
+
+bool NdefWriter::addUri(const char* uri) {
+    // Longest matching prefix wins ("https://www." over "https://")
+    uint8_t code = 0;
+    size_t prefixLen = 0;
+    for (uint8_t i = 1; i < URI_PREFIX_COUNT; i++) {
+        size_t len = strlen(URI_PREFIXES[i]);
+        if (len > prefixLen && strncmp(uri, URI_PREFIXES[i], len) == 0) {
+            code = i;
+            prefixLen = len;
+        }
+    }
+
+    const char* rest = uri + prefixLen;
+    size_t restLen = strlen(rest);
+    static const uint8_t TYPE_URI = 'U';
+    return beginRecord(NDEF_TNF_WELL_KNOWN, &TYPE_URI, 1, 1 + restLen) &&
+           put(&code, 1) && put(rest, restLen);
+}
+
+bool NdefWriter::addText(const char* text, const char* lang) {
+    size_t langLen = strlen(lang);
+    size_t textLen = strlen(text);
+    if (langLen > 0x3F) return false;
+
+    static const uint8_t TYPE_TEXT = 'T';
+    uint8_t status = langLen;   // UTF-8, language code length
+    return beginRecord(NDEF_TNF_WELL_KNOWN, &TYPE_TEXT, 1, 1 + langLen + textLen) &&
+           put(&status, 1) && put(lang, langLen) && put(text, textLen);
+}
+
+size_t NdefWriter::finish() {
+    if (_overflow || !_hasRecords) return 0;
+
+    // Records were written after a worst-case TLV header; close the gap for short messages
+    size_t messageLen = _len - TLV_HEADER_MAX;
+    size_t headerLen = messageLen < 0xFF ? 2 : 4;
+    if (messageLen > 0xFFFE) return 0;
+    memmove(_buf + headerLen, _buf + TLV_HEADER_MAX, messageLen);
+    _buf[0] = TLV_NDEF;
+    if (headerLen == 2) {
+        _buf[1] = messageLen;
+    } else {
+        _buf[1] = 0xFF;
+        _buf[2] = messageLen >> 8;
+        _buf[3] = messageLen & 0xFF;
+    }
+    _len = headerLen + messageLen;
+
+    uint8_t terminator = TLV_TERMINATOR;
+    if (!put(&terminator, 1)) return 0;
+    while (_len % 4 != 0) {
+        uint8_t pad = 0;
+        if (!put(&pad, 1)) return 0;
+    }
+    return _len;
+}
+
+bool NdefReader::next(NdefRecord& record) {
+    if (_pos >= _len) return false;
+
+    const uint8_t* p = _msg + _pos;
+    size_t left = _len - _pos;
+    if (left < 3) return false;
+
+    uint8_t header = p[0];
+    if (header & NDEF_CF) return false;
+
+    size_t at = 1;
+    record.typeLength = p[at++];
+    if (header & NDEF_SR) {
+        record.payloadLength = p[at++];
+    } else {
+        if (left < at + 4) return false;
+        record.payloadLength = ((uint32_t)p[at] << 24) | ((uint32_t)p[at + 1] << 16) |
+                               ((uint32_t)p[at + 2] << 8) | p[at + 3];
+        at += 4;
+    }
+    record.idLength = 0;
+    if (header & NDEF_IL) {
+        if (left < at + 1) return false;
+        record.idLength = p[at++];
+    }
+
+    if (left - at < (size_t)record.typeLength + record.idLength ||
+        left - at - record.typeLength - record.idLength < record.payloadLength) {
+        return false;
+    }
+    record.tnf = header & NDEF_TNF_MASK;
+    record.type = p + at;
+    at += record.typeLength;
+    record.id = p + at;
+    at += record.idLength;
+    record.payload = p + at;
+    at += record.payloadLength;
+
+    _pos = (header & NDEF_ME) ? _len : _pos + at;
+    return true;
+}
+
+// Skips NULL, lock and memory control TLVs; returns the NDEF TLV's value offset/length
+static bool locateNdefTlv(const uint8_t* mem, size_t len, size_t& valueAt, size_t& valueLen) {
+    size_t pos = 0;
+    while (pos < len) {
+        uint8_t tag = mem[pos];
+        if (tag == TLV_NULL) {
+            pos++;
+            continue;
+        }
+        if (tag == TLV_TERMINATOR || pos + 1 >= len) return false;
+
+        size_t tlvLen = mem[pos + 1];
+        size_t headerLen = 2;
+        if (tlvLen == 0xFF) {
+            if (pos + 3 >= len) return false;
+            tlvLen = ((size_t)mem[pos + 2] << 8) | mem[pos + 3];
+            headerLen = 4;
+        }
+        if (tag == TLV_NDEF) {
+            valueAt = pos + headerLen;
+            valueLen = tlvLen;
+            return true;
+        }
+        pos += headerLen + tlvLen;   // Lock/memory control or proprietary TLV
+    }
+    return false;
+}
+
+size_t NdefReader::requiredBytes(const uint8_t* mem, size_t len) {
+    size_t valueAt, valueLen;
+    if (!locateNdefTlv(mem, len, valueAt, valueLen)) return 0;
+    return valueAt + valueLen;
+}
+
+bool NdefReader::findMessage(const uint8_t* mem, size_t len, const uint8_t*& message, size_t& messageLength) {
+    size_t valueAt, valueLen;
+    if (!locateNdefTlv(mem, len, valueAt, valueLen) || valueAt + valueLen > len) return false;
+    message = mem + valueAt;
+    messageLength = valueLen;
+    return true;
+}
+
+bool ndefDecodeUri(const NdefRecord& record, char* out, size_t outSize) {
+    if (record.tnf != NDEF_TNF_WELL_KNOWN || record.typeLength != 1 || record.type[0] != 'U' ||
+        record.payloadLength < 1) {
+        return false;
+    }
+
+    uint8_t code = record.payload[0];
+    const char* prefix = code < URI_PREFIX_COUNT ? URI_PREFIXES[code] : "";
+    size_t prefixLen = strlen(prefix);
+    size_t restLen = record.payloadLength - 1;
+    if (prefixLen + restLen + 1 > outSize) return false;
+
+    memcpy(out, prefix, prefixLen);
+    memcpy(out + prefixLen, record.payload + 1, restLen);
+    out[prefixLen + restLen] = '\0';
+    return true;
+}
+
+size_t ndefTagDataSize(const uint8_t cc[4]) {
+    // CC: magic 0xE1, version, data area size / 8, access
+    if (cc[0] != 0xE1) return 0;
+    return (size_t)cc[2] * 8;
+}
@@ -0,0 +1,461 @@
+#include "NetTrace.h"
+#include "FrameHash.h"
+#include "Metrics.h"
+
+static const uint8_t TRACE_MAGIC[4] = {'N', 'T', 'R', '1'};
+static const size_t HEX_LINE_BYTES = 48;
+static const size_t CHUNK_MAX = 256;            // Capture coalesces reads up to this...
+static const uint32_t CHUNK_GAP_US = 2000;      // ...or until a pause this long
+static const int MAX_EXCHANGES = 128;           // Replay index size
+
+// Capture state (one exchange at a time: the firmware never overlaps requests)
+static File traceFile;
+static uint32_t traceBytes = 0;
+static bool traceFull = false;
+static uint8_t chunk[CHUNK_MAX];
+static size_t chunkLen = 0;
+static uint32_t chunkAtUs = 0;          // Arrival of the chunk's first byte
+static uint32_t responseUs = 0;         // micros() when GET returned
+static uint32_t lastReadUs = 0;
+static uint32_t sinkUs = 0;             // Time spent writing the trace, kept out of the stamps
+
+// Replay index: where each exchange starts and which URL it answers
+struct IndexEntry {
+    uint32_t offset;
+    uint32_t urlHash;
+    bool used;
+};
+static IndexEntry entries[MAX_EXCHANGES];
+static int entryCount = 0;
+
+static uint32_t urlHash(const char* url) {
+    return (uint32_t)FrameHasher("url").add(url).value();
+}
+
+static void printHexLine(Print& out, const uint8_t* data, size_t len) {
+    static const char digits[] = "0123456789abcdef";
+    char line[3 + 2 * HEX_LINE_BYTES + 1];
+    memcpy(line, "NT:", 3);
+    for (size_t i = 0; i < len; i++) {
+        line[3 + 2 * i] = digits[data[i] >> 4];
+        line[4 + 2 * i] = digits[data[i] & 0x0F];
+    }
+    line[3 + 2 * len] = '\n';
+    out.write((const uint8_t*)line, 4 + 2 * len);
+}
+
+#if NET_TRACE == NET_TRACE_CAPTURE_SERIAL
+static uint8_t hexLine[HEX_LINE_BYTES];
+static size_t hexLen = 0;
+
+static void flushHexLine() {
+    if (!hexLen) return;
+    printHexLine(Serial, hexLine, hexLen);
+    hexLen = 0;
+}
+#endif
+
+void NetTrace::begin() {
+#if NET_TRACE == NET_TRACE_CAPTURE_SPIFFS
+    traceFile = SPIFFS.open(NET_TRACE_PATH, "a");
+    if (!traceFile) {
+        Serial.printf("❌ Cannot open %s, HTTP capture off\n", NET_TRACE_PATH);
+        traceFull = true;
+        return;
+    }
+    traceBytes = traceFile.size();
+    if (traceBytes == 0) put(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    Serial.printf("📼 Capturing HTTP to %s (%u bytes so far, limit %u)\n", NET_TRACE_PATH, traceBytes,
+                  NET_TRACE_MAX_BYTES);
+#elif NET_TRACE == NET_TRACE_CAPTURE_SERIAL
+    Serial.println("📼 Capturing HTTP to Serial (NT: lines)");
+    put(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    flushHexLine();
+#elif NET_TRACE == NET_TRACE_REPLAY
+    File file = SPIFFS.open(NET_TRACE_PATH, "r");
+    uint8_t magic[4];
+    if (!file || file.read(magic, 4) != 4 || memcmp(magic, TRACE_MAGIC, 4) != 0) {
+        Serial.printf("❌ No trace at %s, every request will fail\n", NET_TRACE_PATH);
+        return;
+    }
+    // Index the exchanges: offset and URL hash, bodies are skipped
+    entryCount = 0;
+    int tag;
+    while ((tag = file.read()) == 'X' && entryCount < MAX_EXCHANGES) {
+        IndexEntry& entry = entries[entryCount++];
+        entry.offset = file.position() - 1;
+        entry.used = false;
+        uint16_t urlLen = 0;
+        file.read((uint8_t*)&urlLen, 2);
+        FrameHasher hasher("url");
+        for (uint16_t i = 0; i < urlLen; i++) {
+            uint8_t c = file.read();
+            hasher.add(&c, 1);
+        }
+        uint8_t nul = 0;
+        entry.urlHash = (uint32_t)hasher.add(&nul, 1).value();   // Same as add(const char*)
+        file.seek(file.position() + 4 + 4 + 2 + 4);               // startMs, latencyUs, status, size
+        uint8_t headerCount = file.read();
+        for (uint8_t i = 0; i < headerCount; i++) {
+            uint8_t nameLen = file.read();
+            file.seek(file.position() + nameLen);
+            uint16_t valueLen = 0;
+            file.read((uint8_t*)&valueLen, 2);
+            file.seek(file.position() + valueLen);
+        }
+        while ((tag = file.read()) == 'C') {
+            uint16_t len = 0;
+            file.seek(file.position() + 4);
+            file.read((uint8_t*)&len, 2);
+            file.seek(file.position() + len);
+        }
+        if (tag != 'E') break;   // Cut short (power loss while capturing): keep what we have
+    }
+    Serial.printf("📼 Replaying %d HTTP exchanges from %s\n", entryCount, NET_TRACE_PATH);
+    file.close();
+#endif
+}
+
+void NetTrace::dump(Print& out) {
+    if (traceFile) traceFile.flush();
+    File file = SPIFFS.open(NET_TRACE_PATH, "r");
+    if (!file) {
+        out.printf("📼 No trace at %s\n", NET_TRACE_PATH);
+        return;
+    }
+    out.printf("📼 NET TRACE BEGIN %u bytes\n", (unsigned)file.size());
+    uint8_t buf[HEX_LINE_BYTES];
+    size_t n;
+    while ((n = file.read(buf, sizeof(buf))) > 0) printHexLine(out, buf, n);
+    out.println("📼 NET TRACE END");
+    file.close();
+}
+
+// ---- Capture ----
+
+void NetTrace::put(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    traceBytes += len;
+#if NET_TRACE == NET_TRACE_CAPTURE_SERIAL
+    while (len) {
+        size_t n = min(len, HEX_LINE_BYTES - hexLen);
+        memcpy(hexLine + hexLen, p, n);
+        hexLen += n;
+        p += n;
+        len -= n;
+        if (hexLen == HEX_LINE_BYTES) flushHexLine();
+    }
+#else
+    traceFile.write(p, len);
+#endif
+}
+
+bool NetTrace::beginExchange(const char* url, uint32_t latencyUs, int status, int size,
+                             const char* const* headerNames, const String* headerValues, size_t headerCount) {
+    if (traceFull) return false;
+    if (NET_TRACE == NET_TRACE_CAPTURE_SPIFFS && traceBytes >= NET_TRACE_MAX_BYTES) {
+        traceFull = true;
+        Serial.printf("📼 %s is full (%u bytes), capture stopped\n", NET_TRACE_PATH, traceBytes);
+        return false;
+    }
+
+    uint16_t urlLen = strlen(url);
+    put8('X');
+    put16(urlLen);
+    put(url, urlLen);
+    put32(millis());
+    put32(latencyUs);
+    put16((uint16_t)(int16_t)status);
+    put32((uint32_t)size);
+    put8(headerCount);
+    for (size_t i = 0; i < headerCount; i++) {
+        uint8_t nameLen = min<size_t>(strlen(headerNames[i]), 255);
+        put8(nameLen);
+        put(headerNames[i], nameLen);
+        put16(headerValues[i].length());
+        put(headerValues[i].c_str(), headerValues[i].length());
+    }
+
+    // Body stamps start once the header is written, which keeps its cost out of them
+    chunkLen = 0;
+    sinkUs = 0;
+    responseUs = lastReadUs = micros();
+    return true;
+}
+
+void NetTrace::flushChunk() {
+    if (!chunkLen) return;
+    uint32_t start = micros();
+    put8('C');
+    put32(chunkAtUs);
+    put16(chunkLen);
+    put(chunk, chunkLen);
+    chunkLen = 0;
+    sinkUs += micros() - start;
+}
+
+void NetTrace::record(const uint8_t* data, size_t len) {
+    if (!len) return;
+    uint32_t now = micros();
+    if (chunkLen && now - lastReadUs > CHUNK_GAP_US) flushChunk();
+    lastReadUs = now;
+    uint32_t atUs = now - responseUs - sinkUs;
+    while (len) {
+        if (!chunkLen) chunkAtUs = atUs;
+        size_t n = min(len, CHUNK_MAX - chunkLen);
+        memcpy(chunk + chunkLen, data, n);
+        chunkLen += n;
+        data += n;
+        len -= n;
+        if (chunkLen == CHUNK_MAX) flushChunk();
+    }
+}
+
+void NetTrace::endExchange() {
+    flushChunk();
+    put8('E');
+#if NET_TRACE == NET_TRACE_CAPTURE_SERIAL
+    flushHexLine();
+#else
+    traceFile.flush();
+#endif
+}
+
+// ---- Replay ----
+
+int NetTrace::findExchange(const char* url) {
+    uint32_t hash = urlHash(url);
+    int first = -1;
+    for (int i = 0; i < entryCount; i++) {
+        if (entries[i].urlHash != hash) continue;
+        if (!entries[i].used) {
+            entries[i].used = true;
+            return entries[i].offset;
+        }
+        if (first < 0) first = i;
+    }
+    if (first < 0) return -1;
+    // Every exchange for this URL was served: start over
+    for (int i = 0; i < entryCount; i++) {
+        if (entries[i].urlHash == hash) entries[i].used = false;
+    }
+    entries[first].used = true;
+    return entries[first].offset;
+}
+
+bool ReplayStream::open(uint32_t offset) {
+    close();
+    _file = SPIFFS.open(NET_TRACE_PATH, "r");
+    if (!_file || !_file.seek(offset) || _file.read() != 'X') return false;
+
+    uint16_t urlLen = 0;
+    _file.read((uint8_t*)&urlLen, 2);
+    _file.seek(_file.position() + urlLen + 4);   // URL, startMs
+    int16_t status = 0;
+    int32_t size = -1;
+    _file.read((uint8_t*)&_latencyUs, 4);
+    _file.read((uint8_t*)&status, 2);
+    _file.read((uint8_t*)&size, 4);
+    _status = status;
+    _size = size;
+
+    uint8_t headerCount = _file.read();
+    _headerCount = 0;
+    for (uint8_t i = 0; i < headerCount; i++) {
+        char text[97];
+        uint8_t nameLen = _file.read();
+        _file.read((uint8_t*)text, min<size_t>(nameLen, 24));
+        if (nameLen > 24) _file.seek(_file.position() + nameLen - 24);
+        text[min<size_t>(nameLen, 24)] = '\0';
+        bool keep = _headerCount < MAX_HEADERS;
+        if (keep) _headerNames[_headerCount] = text;
+
+        uint16_t valueLen = 0;
+        _file.read((uint8_t*)&valueLen, 2);
+        _file.read((uint8_t*)text, min<size_t>(valueLen, 96));
+        if (valueLen > 96) _file.seek(_file.position() + valueLen - 96);
+        text[min<size_t>(valueLen, 96)] = '\0';
+        if (keep) _headerValues[_headerCount++] = text;
+    }
+
+    _left = 0;
+    _ended = false;
+    _startUs = micros();
+    return true;
+}
+
+void ReplayStream::close() {
+    if (_file) _file.close();
+    _left = 0;
+    _ended = true;
+}
+
+String ReplayStream::header(const char* name) const {
+    for (uint8_t i = 0; i < _headerCount; i++) {
+        if (strcasecmp(_headerNames[i].c_str(), name) == 0) return String(_headerValues[i].c_str());
+    }
+    return String();
+}
+
+bool ReplayStream::nextChunk() {
+    if (_ended) return false;
+    if (_file.read() != 'C') {
+        _ended = true;
+        return false;
+    }
+    _file.read((uint8_t*)&_dueUs, 4);
+    _file.read((uint8_t*)&_left, 2);
+    return true;
+}
+
+bool ReplayStream::waitChunk() {
+    while (!_left) {
+        if (!nextChunk()) return false;
+    }
+    if (NET_TRACE_REPLAY_REALTIME) {
+        for (uint32_t elapsed; (elapsed = micros() - _startUs) < _dueUs;) {
+            uint32_t wait = _dueUs - elapsed;
+            if (wait >= 1000) delay(1);
+            else delayMicroseconds(wait);
+        }
+    }
+    return true;
+}
+
+bool ReplayStream::more() {
+    if (!_left) nextChunk();
+    return _left > 0;
+}
+
+int ReplayStream::available() {
+    if (!more()) return 0;
+    if (NET_TRACE_REPLAY_REALTIME && micros() - _startUs < _dueUs) return 0;   // Not "arrived" yet
+    return _left;
+}
+
+int ReplayStream::read() {
+    if (!waitChunk()) return -1;
+    _left--;
+    return _file.read();
+}
+
+int ReplayStream::peek() {
+    if (!waitChunk()) return -1;
+    return _file.peek();
+}
+
+size_t ReplayStream::readBytes(char* buffer, size_t length) {
+    size_t total = 0;
+    while (total < length && waitChunk()) {
+        size_t n = _file.read((uint8_t*)buffer + total, min<size_t>(length - total, _left));
+        if (!n) break;
+        _left -= n;
+        total += n;
+    }
+    return total;
+}
+
+// ---- Streams and client ----
+
+int CaptureStream::read() {
+    int c = _source->read();
+    if (c >= 0) {
+        uint8_t b = c;
+        NetTrace::record(&b, 1);
+    }
+    return c;
+}
+
+size_t CaptureStream::readBytes(char* buffer, size_t length) {
+    size_t n = _source->readBytes(buffer, length);
+    NetTrace::record((const uint8_t*)buffer, n);
+    return n;
+}
+
+bool TracedHTTPClient::begin(const String& url) {
+    end();
+    _url = url;
+    _open = NetTrace::replaying() || _http.begin(url);   // Replay never touches the network
+    return _open;
+}
+
+void TracedHTTPClient::collectHeaders(const char* headerKeys[], size_t count) {
+    _headerCount = count < MAX_COLLECTED ? count : MAX_COLLECTED;
+    for (size_t i = 0; i < _headerCount; i++) _headerKeys[i] = headerKeys[i];
+    _http.collectHeaders(headerKeys, count);
+}
+
+int TracedHTTPClient::GET() {
+    if (NetTrace::replaying()) {
+        int offset = NetTrace::findExchange(_url.c_str());
+        if (offset < 0 || !_replay.open(offset)) {
+            Serial.printf("📼 No recorded exchange for %s\n", _url.c_str());
+            return HTTPC_ERROR_CONNECTION_REFUSED;
+        }
+        _replaying = true;
+        if (NET_TRACE_REPLAY_REALTIME) {
+            delay(_replay.latencyUs() / 1000);
+            delayMicroseconds(_replay.latencyUs() % 1000);
+        }
+        _replay._startUs = micros();
+        Metrics::recordHttp(_replay.status(), _replay.latencyUs(), _replay.size());
+        return _replay.status();
+    }
+
+    uint32_t start = micros();
+    int code = _http.GET();
+    uint32_t latencyUs = micros() - start;
+    Metrics::recordHttp(code, latencyUs, _http.getSize());
+    if (NetTrace::capturing()) {
+        String values[MAX_COLLECTED];
+        for (size_t i = 0; i < _headerCount; i++) values[i] = _http.header(_headerKeys[i]);
+        _capturing = NetTrace::beginExchange(_url.c_str(), latencyUs, code, _http.getSize(), _headerKeys, values,
+                                             _headerCount);
+    }
+    return code;
+}
+
+int TracedHTTPClient::getSize() {
+    return _replaying ? _replay.size() : _http.getSize();
+}
+
+String TracedHTTPClient::header(const char* name) {
+    return _replaying ? _replay.header(name) : _http.header(name);
+}
+
+bool TracedHTTPClient::connected() {
+    return _replaying ? _replay.more() : _http.connected();
+}
+
+Stream& TracedHTTPClient::getStream() {
+    if (_replaying) return _replay;
+    if (_capturing) {
+        _capture.attach(&_http.getStream());
+        return _capture;
+    }
+    return _http.getStream();
+}
+
+String TracedHTTPClient::getString() {
+    if (_replaying) {
+        String body;
+        if (_replay.size() > 0) body.reserve(_replay.size());
+        char buf[65];
+        size_t n;
+        while ((n = _replay.readBytes(buf, sizeof(buf) - 1)) > 0) {
+            buf[n] = '\0';
+            body += buf;
+        }
+        return body;
+    }
+    String body = _http.getString();
+    if (_capturing) NetTrace::record((const uint8_t*)body.c_str(), body.length());
+    return body;
+}
+
+void TracedHTTPClient::end() {
+    if (_capturing) NetTrace::endExchange();
+    if (_replaying) _replay.close();
+    if (_open && !NetTrace::replaying()) _http.end();
+    _capturing = _replaying = _open = false;
+}
@@ -1,70 +1,79 @@
 #include "OpenWeather.h"
+#include "HeapTelemetry.h"
+#include "RefreshArena.h"
 #include <Arduino.h>
-#include <HTTPClient.h>
+#include "NetTrace.h"
 #include <ArduinoJson.h>
 
 OpenWeather::OpenWeather() : _temperature(0.0) {}
 
 bool OpenWeather::updateWeather(const LocationData& location) {
-    const int maxRetries = 3;
-    int retryCount = 0;
-    HTTPClient http;
+    HeapScope heapScope(HEAP_HTTP);
+    // Single attempt per call; FetchScheduler owns retries and backoff
+    TracedHTTPClient http;
+    http.setTimeout(5000);
     
     if (!location.latitude || !location.longitude) {
         Serial.println("⚠️ Invalid location for weather update");
         return false;
     }
     
-    String url = "http://api.openweathermap.org/data/2.5/weather?";
-    url += "lat=" + String(location.latitude, 6);
-    url += "&lon=" + String(location.longitude, 6);
-    url += "&appid=" + String(OPENWEATHER_API_KEY);
-    url += "&units=metric";  // Use Celsius
+    FixedString<160> url;
+    url.appendf("http://api.openweathermap.org/data/2.5/weather?lat=%.6f&lon=%.6f&appid=%s&units=metric",
+                location.latitude, location.longitude, OPENWEATHER_API_KEY);  // Celsius
     
-    while (retryCount < maxRetries) {
-        http.begin(url);
-        int httpCode = http.GET();
-        
-        if (httpCode == HTTP_CODE_OK) {
-            String payload = http.getString();
-            http.end();
-            return parseWeatherData(payload);
-        }
-        
-        Serial.printf("⚠️ Weather API request failed (attempt %d/%d)\n", retryCount + 1, maxRetries);
-        Serial.printf("HTTP Code: %d\n", httpCode);
+    http.useHTTP10(true);  // No chunked encoding, so the body can be parsed straight off the socket
+    http.begin(url.c_str());
+    int httpCode = http.GET();
+    
+    if (httpCode != HTTP_CODE_OK) {
+        Serial.printf("⚠️ Weather API request failed, HTTP Code: %d\n", httpCode);
         http.end();
-        retryCount++;
-        
-        if (retryCount < maxRetries) {
-            delay(1000);  // Wait before retry
-            continue;
-        }
-        
-        Serial.println("❌ Failed to get weather after all retries");
         return false;
     }
     
-    return false;
+    bool parsed = parseWeatherData(http.getStream());
+    http.end();
+    return parsed;
 }
 
-bool OpenWeather::parseWeatherData(String& response) {
-    DynamicJsonDocument doc(1024);
-    DeserializationError error = deserializeJson(doc, response);
+bool OpenWeather::parseWeatherData(Stream& response) {
+    HeapScope heapScope(HEAP_JSON);
+    // Keep only main.temp and weather[].icon; everything else is skipped while streaming.
+    // Sized in slots: a slot is 16 bytes on the ESP32 and 32 on a 64-bit host.
+    static StaticJsonDocument<JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(1) + JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(1)> filter;
+    if (filter.isNull()) {
+        filter["main"]["temp"] = true;
+        filter["weather"][0]["icon"] = true;
+    }
+    
+    ArenaScope arena("Weather", ArenaBudget::WEATHER);
+    ArenaJsonDocument doc(ARENA_WEATHER_JSON);
+    unsigned long startTime = micros();
+    uint32_t heapBefore = ESP.getFreeHeap();
+    DeserializationError error = deserializeJson(doc, response, DeserializationOption::Filter(filter));
+    Serial.printf("🌤️ Weather JSON parsed in %lu us, doc %u/%u bytes, heap delta %d\n",
+                  micros() - startTime, (unsigned)doc.memoryUsage(), (unsigned)doc.capacity(),
+                  (int)(heapBefore - ESP.getFreeHeap()));
     
-    if (error) {
+    if (error || doc.overflowed()) {
         Serial.println("⚠️ Weather JSON parsing failed");
         return false;
     }
     
+    if (doc["main"]["temp"].isNull()) {
+        Serial.println("⚠️ Weather response has no temperature");
+        return false;
+    }
+    
     _temperature = doc["main"]["temp"].as<float>();
-    _weatherIcon = doc["weather"][0]["icon"].as<String>();
+    _weatherIcon = doc["weather"][0]["icon"] | "";
     
     return true;
 }
 
-String OpenWeather::getWeatherIcon() {
-    return _weatherIcon;
+const char* OpenWeather::getWeatherIcon() const {
+    return _weatherIcon.c_str();
 }
 
 float OpenWeather::getTemperature() {
@@ -0,0 +1,87 @@
+#include "PageDownload.h"
+#include <SPIFFS.h>
+#include "NetTrace.h"
+#include "RefreshArena.h"
+
+bool downloadToFile(const char* url, const char* path) {
+    Serial.printf("🔗 URL: %s\n", url);
+    
+    TracedHTTPClient http;
+    http.setTimeout(15000);
+    
+    if (!http.begin(url)) {
+        Serial.println("❌ Failed to begin HTTP request");
+        return false;
+    }
+    
+    Serial.println("📡 Sending GET request...");
+    int httpCode = http.GET();
+    Serial.printf("📡 Response Code: %d\n", httpCode);
+    
+    if (httpCode != HTTP_CODE_OK) {
+        Serial.printf("❌ HTTP Error: %d\n", httpCode);
+        http.end();
+        return false;
+    }
+    
+    int contentLength = http.getSize();
+    Serial.printf("📄 Content Length: %d bytes (%.1f KB)\n", 
+                 contentLength, contentLength/1024.0);
+    
+    // Remove old file
+    if (SPIFFS.exists(path)) {
+        SPIFFS.remove(path);
+    }
+    
+    // Create new file
+    File file = SPIFFS.open(path, "w");
+    if (!file) {
+        Serial.println("❌ Failed to create file");
+        http.end();
+        return false;
+    }
+    
+    // Download
+    Stream* stream = http.getStreamPtr();
+    ArenaScope arena("Page download", ArenaBudget::PAGE_DOWNLOAD);
+    uint8_t* buf = (uint8_t*)RefreshArena::alloc(ARENA_DOWNLOAD_CHUNK);
+    if (!buf) {
+        file.close();
+        http.end();
+        return false;
+    }
+    size_t totalBytes = 0;
+    
+    Serial.println("⬇️ Downloading...");
+    while (http.connected() && (contentLength <= 0 || totalBytes < (size_t)contentLength)) {
+        size_t available = stream->available();
+        if (available) {
+            size_t readBytes = stream->readBytes(buf, min(ARENA_DOWNLOAD_CHUNK, available));
+            if (readBytes == 0) break;
+            
+            file.write(buf, readBytes);
+            totalBytes += readBytes;
+            
+            // Progress
+            if (contentLength > 0) {
+                int progress = (totalBytes * 100) / contentLength;
+                if (progress % 25 == 0) {
+                    Serial.printf("⬇️ Progress: %d%%\n", progress);
+                }
+            }
+        } else {
+            delay(10);
+        }
+    }
+    
+    file.close();
+    http.end();
+    
+    if (contentLength > 0 && totalBytes != (size_t)contentLength) {
+        Serial.printf("❌ Incomplete download: %u of %d bytes\n", (unsigned)totalBytes, contentLength);
+        return false;
+    }
+    
+    Serial.printf("✅ Downloaded: %u bytes\n", (unsigned)totalBytes);
+    return true;
+}
@@ -4,6 +4,10 @@
 #include <Fonts/FreeMonoBold9pt7b.h>    // Labels
 
 void showQRCode(const char* text) {
+  FrameHasher hasher("qr");
+  hasher.add(text);
+  if (!beginFrame(hasher.value(), "QR code")) return;
+
   QRCode qrcode;
   uint8_t qrcodeData[qrcode_getBufferSize(6)];
   qrcode_initText(&qrcode, qrcodeData, 6, 0, text);
@@ -64,5 +68,6 @@ void showQRCode(const char* text) {
     display.print(pass);
 
   } while (display.nextPage());
+  commitFrame();
 }
 
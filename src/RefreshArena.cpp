@@ -0,0 +1,49 @@
+#include "RefreshArena.h"
+
+uint8_t RefreshArena::_block[RefreshArena::CAPACITY];
+size_t RefreshArena::_top = 0;
+size_t RefreshArena::_peak = 0;
+size_t RefreshArena::_scopePeak = 0;
+
+void* RefreshArena::alloc(size_t size) {
+    size = arenaSize(size);
+    if (size > CAPACITY - _top) {
+        Serial.printf("❌ Refresh arena exhausted: %u bytes requested, %u of %u used\n",
+                      (unsigned)size, (unsigned)_top, (unsigned)CAPACITY);
+        return nullptr;
+    }
+    void* block = _block + _top;
+    _top += size;
+    if (_top > _peak) _peak = _top;
+    if (_top > _scopePeak) _scopePeak = _top;
+    return block;
+}
+
+size_t RefreshArena::used() {
+    return _top;
+}
+
+size_t RefreshArena::peak() {
+    return _peak;
+}
+
+ArenaScope::ArenaScope(const char* view, size_t budget)
+    : _view(view), _budget(budget), _mark(RefreshArena::_top), _outerPeak(RefreshArena::_scopePeak) {
+    RefreshArena::_scopePeak = _mark;
+}
+
+ArenaScope::~ArenaScope() {
+    size_t scopeUsed = used();
+    if (scopeUsed > _budget) {
+        Serial.printf("⚠️ %s used %u arena bytes, budget is %u\n", _view, (unsigned)scopeUsed,
+                      (unsigned)_budget);
+    }
+
+    // Release everything this view allocated; the enclosing scope keeps its own peak
+    RefreshArena::_top = _mark;
+    if (_outerPeak > RefreshArena::_scopePeak) RefreshArena::_scopePeak = _outerPeak;
+}
+
+size_t ArenaScope::used() const {
+    return RefreshArena::_scopePeak - _mark;
+}
@@ -0,0 +1,108 @@
+#include "RefreshTimer.h"
+#include "Config.h"
+#include "DisplayManager.h"
+#include "NTP.h"
+#include <inttypes.h>
+#include <sys/time.h>
+
+extern NTPClient ntpClient;
+
+static const char* const TYPE_NAMES[REFRESH_TYPE_COUNT] = {"time", "full"};
+static const char* const BUCKET_NAMES[REFRESH_ERROR_BUCKETS] = {
+    "<-5s", "-5..-2s", "-2..-1s", "-1..0s", "0..1s", "1..2s", "2..5s", ">5s"
+};
+
+// Until measured: a full-window 3-color refresh takes ~16 s, the hourly clean adds ~4 s
+static RefreshTiming timings[REFRESH_TYPE_COUNT] = {
+    {16000.0f, 0, 0, 0, {0}},
+    {20000.0f, 0, 0, 0, {0}},
+};
+
+static time_t lastTarget = 0;          // Minute the panel was last rendered for
+static time_t currentTarget = 0;       // Minute being rendered (0 = no wall clock)
+static unsigned long startedAt = 0;
+
+static int64_t epochMs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000LL + tv.tv_usec / 1000;
+}
+
+// Aim to land in the middle of the tolerance window after the boundary
+static int64_t leadMs(RefreshType type) {
+    float lead = timings[type].latencyMs - REFRESH_TARGET_TOLERANCE_MS / 2.0f;
+    return lead > 0.0f ? (int64_t)lead : 0;
+}
+
+// Minute to render now, or 0 if none is due
+static time_t targetMinute(RefreshType type) {
+    int64_t now = epochMs();
+    time_t minute = (time_t)(now / 60000) * 60;
+    time_t next = minute + 60;
+
+    if (now + leadMs(type) >= (int64_t)next * 1000LL) {
+        return lastTarget != next ? next : 0;
+    }
+    // Missed the current minute (boot, long download): render it late rather than not at all
+    return lastTarget < minute ? minute : 0;
+}
+
+bool RefreshTimer::due(RefreshType type) {
+    if (time(nullptr) < MIN_VALID_EPOCH) {
+        // No wall clock yet, nothing to align to
+        return millis() - lastTimeRefresh >= TIME_REFRESH_INTERVAL;
+    }
+    return targetMinute(type) != 0;
+}
+
+void RefreshTimer::start(RefreshType type) {
+    startedAt = millis();
+    currentTarget = time(nullptr) < MIN_VALID_EPOCH ? 0 : targetMinute(type);
+    if (currentTarget) ntpClient.formatAt(currentTarget);
+}
+
+void RefreshTimer::finish(RefreshType type, bool executed) {
+    if (!currentTarget) return;
+    lastTarget = currentTarget;
+    if (!executed) return;   // Elided: nothing reached the glass, nothing to measure
+
+    RefreshTiming& t = timings[type];
+    float latency = millis() - startedAt;
+    t.latencyMs = t.samples ? 0.8f * t.latencyMs + 0.2f * latency : latency;
+
+    int32_t error = (int32_t)(epochMs() - (int64_t)currentTarget * 1000LL);
+    int bucket = 0;
+    while (bucket < REFRESH_ERROR_BUCKETS - 1 && error >= REFRESH_ERROR_EDGES[bucket]) bucket++;
+    t.errorHistogram[bucket]++;
+    t.errorSumMs += error;
+    if (abs(error) > t.worstErrorMs) t.worstErrorMs = abs(error);
+    t.samples++;
+
+    Serial.printf("⏱️ %s refresh took %.0f ms, landed %+d ms from the minute (next lead %" PRId64 " ms)\n",
+                  TYPE_NAMES[type], latency, error, leadMs(type));
+}
+
+const RefreshTiming& RefreshTimer::getTiming(RefreshType type) {
+    return timings[type];
+}
+
+const char* RefreshTimer::typeName(RefreshType type) {
+    return TYPE_NAMES[type];
+}
+
+void RefreshTimer::printStats() {
+    Serial.println("\n=== Refresh Timing ===");
+    for (int i = 0; i < REFRESH_TYPE_COUNT; i++) {
+        const RefreshTiming& t = timings[i];
+        if (t.samples == 0) {
+            Serial.printf("%-5s no samples yet\n", TYPE_NAMES[i]);
+            continue;
+        }
+        Serial.printf("%-5s latency %.0f ms, landing error mean %+" PRId64 " ms, worst %d ms (n=%u)\n",
+                      TYPE_NAMES[i], t.latencyMs, t.errorSumMs / t.samples, t.worstErrorMs, t.samples);
+        for (int b = 0; b < REFRESH_ERROR_BUCKETS; b++) {
+            Serial.printf("  %-8s %u\n", BUCKET_NAMES[b], t.errorHistogram[b]);
+        }
+    }
+    Serial.println("======================");
+}
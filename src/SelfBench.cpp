@@ -0,0 +1,323 @@
+#include "SelfBench.h"
+#include <SPIFFS.h>
+#include <WiFi.h>
+#include "Config.h"
+#include "DisplayManager.h"
+#include "FixedString.h"
+#include "HeapTelemetry.h"
+#include "NFC.h"
+#include "NetTrace.h"
+#include "RefreshArena.h"
+#include "RefreshTimer.h"
+
+static NFCManager* nfcManager = nullptr;
+static void (*forwardNfcEvent)(const NfcEvent&) = nullptr;
+
+static const char* const BENCH_FILE = "/bench.tmp";
+static const size_t LINE_MAX = 127;
+
+// One result line: BENCH {"test":"...","ok":...,<fields>}
+class BenchLine {
+public:
+    BenchLine(const char* test, bool ok) {
+        _json.appendf("{\"test\":\"%s\",\"ok\":%s", test, ok ? "true" : "false");
+    }
+
+    BenchLine& num(const char* key, long value) {
+        _json.appendf(",\"%s\":%ld", key, value);
+        return *this;
+    }
+
+    BenchLine& real(const char* key, double value) {
+        _json.appendf(",\"%s\":%.3f", key, value);
+        return *this;
+    }
+
+    BenchLine& text(const char* key, const char* value) {
+        _json.appendf(",\"%s\":\"", key);
+        for (const char* c = value; *c; c++) {
+            if (*c == '"' || *c == '\\') _json.append("\\");
+            char ch[2] = {*c >= ' ' ? *c : '?', '\0'};
+            _json.append(ch);
+        }
+        _json.append("\"");
+        return *this;
+    }
+
+    void print() { Serial.printf("BENCH %s}\n", _json.c_str()); }
+
+private:
+    FixedString<320> _json;
+};
+
+// Bytes per microsecond is MB/s
+static double mbPerSec(uint32_t bytes, uint32_t us) {
+    return us ? (double)bytes / us : 0;
+}
+
+void SelfBench::begin(NFCManager& nfc, void (*onNfcEvent)(const NfcEvent&)) {
+    nfcManager = &nfc;
+    forwardNfcEvent = onNfcEvent;
+}
+
+bool SelfBench::poll() {
+    static char line[LINE_MAX + 1];
+    static size_t length = 0;
+    bool drew = false;
+
+    while (Serial.available() > 0) {
+        int c = Serial.read();
+        if (c == '\r' || c == '\n') {
+            line[length] = '\0';
+            if (length) drew |= run(line);
+            length = 0;
+        } else if (length < LINE_MAX) {
+            line[length++] = (char)c;
+        }
+    }
+    return drew;
+}
+
+bool SelfBench::run(const char* line) {
+    char command[16] = "", what[16] = "", arg[LINE_MAX + 1] = "";
+    sscanf(line, "%15s %15s %127s", command, what, arg);
+
+    if (!strcmp(command, "trace") && !strcmp(what, "dump")) {
+        NetTrace::dump(Serial);
+        return false;
+    }
+    bool known = !strcmp(command, "bench") &&
+                 (!strcmp(what, "display") || !strcmp(what, "spiffs") || !strcmp(what, "http") ||
+                  !strcmp(what, "nfc") || !strcmp(what, "all"));
+    if (!known) {
+        Serial.println("⌨️ Commands: bench display | bench spiffs | bench http [url] | bench nfc | bench all | trace dump");
+        return false;
+    }
+
+    Serial.printf("⏱️ Running bench %s\n", what);
+    unitInfo();
+    bool all = !strcmp(what, "all");
+    bool drew = false;
+    if (all || !strcmp(what, "spiffs")) benchSpiffs();
+    if (all || !strcmp(what, "http")) benchHttp(*arg && !all ? arg : SELF_BENCH_HTTP_URL);
+    if (all || !strcmp(what, "nfc")) benchNfc();
+    if (all || !strcmp(what, "display")) drew = benchDisplay();   // Last: the panel needs a redraw after it
+    Serial.println("✅ Bench done");
+    return drew;
+}
+
+// Identifies the unit and the conditions the numbers were taken under
+void SelfBench::unitInfo() {
+    BenchLine("unit", true)
+        .text("mac", WiFi.macAddress().c_str())
+        .text("sdk", ESP.getSdkVersion())
+        .num("cpu_mhz", ESP.getCpuFreqMHz())
+        .num("rssi", WiFi.status() == WL_CONNECTED ? WiFi.RSSI() : 0)
+        .num("free_heap", ESP.getFreeHeap())
+        .num("uptime_ms", millis())
+        .print();
+}
+
+// A blank frame through writeImage() in bands (pure SPI), then each refresh
+// type on its own (BUSY time). The panel is left blank and the frame unknown.
+bool SelfBench::benchDisplay() {
+    HeapScope heapScope(HEAP_DISPLAY);
+    ArenaScope arena("Bench display", ArenaBudget::SELF_BENCH);
+    uint8_t* black = (uint8_t*)RefreshArena::alloc(ARENA_BENCH_BAND);
+    uint8_t* color = (uint8_t*)RefreshArena::alloc(ARENA_BENCH_BAND);
+    if (!black || !color) {
+        BenchLine("display_push", false).text("error", "no arena").print();
+        return false;
+    }
+    memset(black, 0xFF, ARENA_BENCH_BAND);   // 1 = white in both planes
+    memset(color, 0xFF, ARENA_BENCH_BAND);
+
+    const int16_t width = EpdPanel::WIDTH, height = EpdPanel::HEIGHT;
+    const int16_t bandRows = ARENA_BENCH_BAND * 8 / width;
+    invalidateFrame();
+
+    uint32_t start = micros();
+    for (int16_t y = 0; y < height; y += bandRows) {
+        int16_t rows = height - y < bandRows ? height - y : bandRows;
+        display.writeImage(black, color, 0, y, width, rows);
+    }
+    uint32_t pushUs = micros() - start;
+    const uint32_t frameBytes = 2UL * width * height / 8;
+    BenchLine("display_push", true)
+        .num("bytes", frameBytes)
+        .num("us", pushUs)
+        .real("mb_s", mbPerSec(frameBytes, pushUs))
+        .print();
+
+    start = micros();
+    display.refresh(false);
+    BenchLine("display_refresh_full", true).num("us", micros() - start).print();
+
+    for (int16_t y = 0; y < STATUS_BAR_HEIGHT; y += bandRows) {
+        int16_t rows = STATUS_BAR_HEIGHT - y < bandRows ? STATUS_BAR_HEIGHT - y : bandRows;
+        display.writeImage(black, color, 0, y, width, rows);
+    }
+    start = micros();
+    display.refresh(0, 0, width, STATUS_BAR_HEIGHT);
+    BenchLine("display_refresh_partial", true)
+        .num("us", micros() - start)
+        .num("rows", STATUS_BAR_HEIGHT)
+        .print();
+
+    // What the minute and hourly refreshes have cost in service, render included
+    for (int type = 0; type < REFRESH_TYPE_COUNT; type++) {
+        const RefreshTiming& timing = RefreshTimer::getTiming((RefreshType)type);
+        BenchLine("refresh_latency", timing.samples > 0)
+            .text("type", RefreshTimer::typeName((RefreshType)type))
+            .real("avg_ms", timing.latencyMs)
+            .num("samples", timing.samples)
+            .num("worst_error_ms", timing.worstErrorMs)
+            .print();
+    }
+
+    invalidateFrame();
+    return true;
+}
+
+void SelfBench::benchSpiffs() {
+    HeapScope heapScope(HEAP_STORAGE);
+    ArenaScope arena("Bench SPIFFS", ArenaBudget::PAGE_DOWNLOAD);
+    uint8_t* chunk = (uint8_t*)RefreshArena::alloc(ARENA_DOWNLOAD_CHUNK);
+    size_t freeBytes = SPIFFS.totalBytes() - SPIFFS.usedBytes();
+    if (!chunk || freeBytes < SELF_BENCH_SPIFFS_BYTES + ARENA_DOWNLOAD_CHUNK) {
+        BenchLine("spiffs_write", false).num("free", freeBytes).text("error", chunk ? "no space" : "no arena").print();
+        return;
+    }
+    for (size_t i = 0; i < ARENA_DOWNLOAD_CHUNK; i++) chunk[i] = (uint8_t)(i * 31 + 7);
+
+    // Write: open, SELF_BENCH_SPIFFS_BYTES in download-sized chunks, close (flush)
+    uint32_t start = micros();
+    File file = SPIFFS.open(BENCH_FILE, "w");
+    uint32_t openUs = micros() - start;
+    uint32_t written = 0;
+    while (file && written < SELF_BENCH_SPIFFS_BYTES) {
+        size_t left = SELF_BENCH_SPIFFS_BYTES - written;
+        size_t n = file.write(chunk, left < ARENA_DOWNLOAD_CHUNK ? left : ARENA_DOWNLOAD_CHUNK);
+        if (!n) break;
+        written += n;
+    }
+    if (file) file.close();
+    uint32_t writeUs = micros() - start;
+    BenchLine("spiffs_write", written == SELF_BENCH_SPIFFS_BYTES)
+        .num("bytes", written)
+        .num("us", writeUs)
+        .num("open_us", openUs)
+        .real("mb_s", mbPerSec(written, writeUs))
+        .print();
+
+    start = micros();
+    file = SPIFFS.open(BENCH_FILE, "r");
+    openUs = micros() - start;
+    uint32_t readTotal = 0;
+    while (file) {
+        size_t n = file.read(chunk, ARENA_DOWNLOAD_CHUNK);
+        if (!n) break;
+        readTotal += n;
+    }
+    if (file) file.close();
+    uint32_t readUs = micros() - start;
+    BenchLine("spiffs_read", written > 0 && readTotal == written)
+        .num("bytes", readTotal)
+        .num("us", readUs)
+        .num("open_us", openUs)
+        .real("mb_s", mbPerSec(readTotal, readUs))
+        .print();
+
+    SPIFFS.remove(BENCH_FILE);
+}
+
+// GET and read the whole body, discarding it; the rate leaves out the time to first byte
+void SelfBench::benchHttp(const char* url) {
+    HeapScope heapScope(HEAP_HTTP);
+    ArenaScope arena("Bench HTTP", ArenaBudget::PAGE_DOWNLOAD);
+    uint8_t* chunk = (uint8_t*)RefreshArena::alloc(ARENA_DOWNLOAD_CHUNK);
+    if (WiFi.status() != WL_CONNECTED || !chunk) {
+        BenchLine("http", false).text("url", url).text("error", chunk ? "no wifi" : "no arena").print();
+        return;
+    }
+
+    TracedHTTPClient http;
+    http.setTimeout(SELF_BENCH_HTTP_STALL_MS);
+    uint32_t start = micros();
+    int code = http.begin(url) ? http.GET() : HTTPC_ERROR_CONNECTION_REFUSED;
+    uint32_t firstByteUs = micros() - start;
+    int size = http.getSize();
+
+    uint32_t bytes = 0;
+    if (code == HTTP_CODE_OK) {
+        Stream* stream = http.getStreamPtr();
+        unsigned long lastData = millis();
+        while (size < 0 || bytes < (uint32_t)size) {
+            size_t available = stream->available();
+            if (available) {
+                size_t n = stream->readBytes(chunk, min(ARENA_DOWNLOAD_CHUNK, available));
+                if (!n) break;
+                bytes += n;
+                lastData = millis();
+            } else if (!http.connected() || millis() - lastData > SELF_BENCH_HTTP_STALL_MS) {
+                break;
+            } else {
+                delay(1);
+            }
+        }
+    }
+    uint32_t totalUs = micros() - start;
+    http.end();
+
+    BenchLine("http", code == HTTP_CODE_OK && (size < 0 || bytes == (uint32_t)size))
+        .text("url", url)
+        .num("status", code)
+        .num("bytes", bytes)
+        .num("first_byte_us", firstByteUs)
+        .num("us", totalUs)
+        .real("mb_s", mbPerSec(bytes, totalUs - firstByteUs))
+        .num("rssi", WiFi.RSSI())
+        .print();
+}
+
+// The PN532 belongs to the NFC task: ask it to run the reads and wait for the result
+void SelfBench::benchNfc() {
+    bool done = false;
+    if (nfcManager && nfcManager->requestBench()) {
+        Serial.println("🏷️ Hold a tag on the reader");
+        unsigned long started = millis();
+        while (!done && millis() - started < NFC_BENCH_TAG_WAIT_MS + NFC_POLL_MAX_MS + 5000) {
+            NfcEvent event;
+            if (!nfcManager->pollEvent(event)) {
+                delay(10);
+            } else if (event.type == NFC_EVENT_BENCH_DONE) {
+                done = true;
+            } else if (forwardNfcEvent) {
+                forwardNfcEvent(event);
+            }
+        }
+    }
+
+    if (!done || !nfcManager->getBenchResult().tagFound) {
+        const char* error = !done ? "nfc task not answering" : NFC_EMULATE_TAG ? "emulating a tag" : "no tag";
+        BenchLine("nfc_select", false).text("error", error).print();
+        return;
+    }
+    const NfcBenchResult& result = nfcManager->getBenchResult();
+    BenchLine("nfc_select", true).num("us", result.selectUs).print();
+
+    const struct { const char* test; const NfcReadTiming& timing; } reads[] = {
+        {"nfc_read", result.read},
+        {"nfc_fast_read", result.fastRead},
+    };
+    for (const auto& r : reads) {
+        BenchLine(r.test, r.timing.count > 0)
+            .num("pages", r.timing.pages)
+            .num("count", r.timing.count)
+            .num("failures", r.timing.failures)
+            .num("avg_us", r.timing.avgUs)
+            .num("max_us", r.timing.maxUs)
+            .real("us_per_page", r.timing.pages ? (double)r.timing.avgUs / r.timing.pages : 0)
+            .print();
+    }
+}
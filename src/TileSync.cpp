@@ -0,0 +1,189 @@
+#include "TileSync.h"
+#include "BMPHandler.h"
+#include "HeapTelemetry.h"
+#include "NetTrace.h"
+#include <SPIFFS.h>
+
+int TileSync::fetchTileHashes(const String& tilesUrl, uint32_t* hashes, int maxTiles, SyncStats& stats) {
+    HeapScope heapScope(HEAP_HTTP);
+    TracedHTTPClient http;
+    http.setTimeout(10000);
+    if (!http.begin(tilesUrl)) {
+        Serial.println("❌ Failed to begin tile hash request");
+        return -1;
+    }
+
+    stats.requests++;
+    int httpCode = http.GET();
+    if (httpCode != HTTP_CODE_OK) {
+        Serial.printf("⚠️ Tile hash request failed, HTTP code: %d\n", httpCode);
+        http.end();
+        return -1;
+    }
+
+    int contentLength = http.getSize();
+    if (contentLength <= 0 || contentLength % 4 != 0 || contentLength / 4 > maxTiles) {
+        Serial.printf("⚠️ Unexpected tile hash list size: %d bytes\n", contentLength);
+        http.end();
+        return -1;
+    }
+
+    Stream* stream = http.getStreamPtr();
+    size_t bytesRead = stream->readBytes((uint8_t*)hashes, contentLength);
+    http.end();
+    stats.bytes += bytesRead;
+
+    if (bytesRead != (size_t)contentLength) {
+        Serial.printf("⚠️ Tile hash list truncated: %u of %d bytes\n", (unsigned)bytesRead, contentLength);
+        return -1;
+    }
+    return contentLength / 4;
+}
+
+int TileSync::loadTileHashes(const char* path, uint32_t* hashes, int maxTiles) {
+    String tilesPath = String(path) + ".tiles";
+    File f = SPIFFS.open(tilesPath, "r");
+    if (!f) return -1;
+
+    int count = f.size() / 4;
+    if (count > maxTiles) {
+        f.close();
+        return -1;
+    }
+    f.read((uint8_t*)hashes, count * 4);
+    f.close();
+    return count;
+}
+
+bool TileSync::saveTileHashes(const char* path, const uint32_t* hashes, int count) {
+    HeapScope heapScope(HEAP_STORAGE);
+    String tilesPath = String(path) + ".tiles";
+    File f = SPIFFS.open(tilesPath, "w");
+    if (!f) {
+        Serial.println("⚠️ Failed to store tile hashes");
+        return false;
+    }
+    f.write((const uint8_t*)hashes, count * 4);
+    f.close();
+    return true;
+}
+
+bool TileSync::storeTileHashes(const char* path, const String& tilesUrl, SyncStats& stats) {
+    static uint32_t hashes[MAX_TILES];
+    int count = fetchTileHashes(tilesUrl, hashes, MAX_TILES, stats);
+    if (count <= 0) {
+        SPIFFS.remove((String(path) + ".tiles").c_str());
+        return false;
+    }
+    return saveTileHashes(path, hashes, count);
+}
+
+SyncResult TileSync::syncTiles(const char* path, const String& tilesUrl, DirtyRect& dirty, SyncStats& stats) {
+    HeapScope heapScope(HEAP_HTTP);
+    static uint32_t localHashes[MAX_TILES];
+    static uint32_t remoteHashes[MAX_TILES];
+
+    // Validate the cached image first; only byte-aligned 1-bit grids can be patched in place
+    File file = SPIFFS.open(path, "r+");
+    if (!file) return SYNC_FAILED;
+
+    BMPHeader header;
+    if (file.read((uint8_t*)&header, sizeof(BMPHeader)) != sizeof(BMPHeader) ||
+        header.signature != 0x4D42 || header.bitsPerPixel != 1 ||
+        header.width % TILE_W != 0 || header.height % TILE_H != 0) {
+        Serial.println("⚠️ Cached BMP cannot be tile-patched, falling back to full download");
+        file.close();
+        return SYNC_FAILED;
+    }
+
+    const int cols = header.width / TILE_W;
+    const int tileCount = cols * (header.height / TILE_H);
+    const int rowSize = bmpRowSize(header);
+
+    if (tileCount > MAX_TILES || loadTileHashes(path, localHashes, MAX_TILES) != tileCount) {
+        file.close();
+        return SYNC_FAILED;
+    }
+    if (fetchTileHashes(tilesUrl, remoteHashes, MAX_TILES, stats) != tileCount) {
+        file.close();
+        return SYNC_FAILED;
+    }
+
+    // Collect changed tiles
+    String query = tilesUrl + "?ids=";
+    int changed = 0;
+    for (int t = 0; t < tileCount; t++) {
+        if (localHashes[t] == remoteHashes[t]) continue;
+        if (changed > 0) query += ',';
+        query += String(t);
+        changed++;
+    }
+
+    if (changed == 0) {
+        file.close();
+        return SYNC_UNCHANGED;
+    }
+    if (changed > MAX_DELTA_TILES) {
+        Serial.printf("📦 %d tiles changed, full download is cheaper\n", changed);
+        file.close();
+        return SYNC_FAILED;
+    }
+
+    Serial.printf("🧩 Fetching %d of %d tiles\n", changed, tileCount);
+
+    TracedHTTPClient http;
+    http.setTimeout(15000);
+    if (!http.begin(query)) {
+        file.close();
+        return SYNC_FAILED;
+    }
+    stats.requests++;
+    int httpCode = http.GET();
+    if (httpCode != HTTP_CODE_OK) {
+        Serial.printf("⚠️ Tile request failed, HTTP code: %d\n", httpCode);
+        http.end();
+        file.close();
+        return SYNC_FAILED;
+    }
+
+    // Patch each tile row straight into the BMP (rows are stored bottom-up)
+    Stream* stream = http.getStreamPtr();
+    const int tileRowBytes = TILE_W / 8;
+    uint8_t rowBuf[TILE_W / 8];
+    bool ok = true;
+    dirty = {0, 0, 0, 0};
+
+    for (int t = 0; t < tileCount && ok; t++) {
+        if (localHashes[t] == remoteHashes[t]) continue;
+
+        int tileX = (t % cols) * TILE_W;
+        int tileY = (t / cols) * TILE_H;
+        for (int r = 0; r < TILE_H; r++) {
+            if (stream->readBytes(rowBuf, tileRowBytes) != (size_t)tileRowBytes) {
+                Serial.printf("❌ Tile %d truncated at row %d\n", t, r);
+                ok = false;
+                break;
+            }
+            uint32_t offset = header.dataOffset + (uint32_t)(header.height - 1 - (tileY + r)) * rowSize + tileX / 8;
+            file.seek(offset);
+            file.write(rowBuf, tileRowBytes);
+        }
+        stats.bytes += TILE_H * tileRowBytes;
+        dirty.add(tileX, tileY, TILE_W, TILE_H);
+    }
+
+    http.end();
+    file.close();
+
+    if (!ok) {
+        // The image is now a mix of old and new tiles; forget the tile state so the next
+        // sync does a full download
+        SPIFFS.remove((String(path) + ".tiles").c_str());
+        return SYNC_FAILED;
+    }
+
+    saveTileHashes(path, remoteHashes, tileCount);
+    stats.tileUpdates++;
+    Serial.printf("✅ Patched %d tiles, dirty area %d,%d %dx%d\n", changed, dirty.x, dirty.y, dirty.w, dirty.h);
+    return SYNC_UPDATED;
+}
@@ -0,0 +1,140 @@
+#include "Type4Tag.h"
+#include "Ndef.h"
+#include <string.h>
+
+static const uint8_t NDEF_APP_AID[] = {0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01};
+static const uint16_t CC_FILE_ID = 0xE103;
+static const uint16_t NDEF_FILE_ID = 0xE104;
+
+static const uint8_t INS_SELECT = 0xA4;
+static const uint8_t INS_READ_BINARY = 0xB0;
+static const uint8_t INS_UPDATE_BINARY = 0xD6;
+
+// Status words
+static const uint16_t SW_OK = 0x9000;
+static const uint16_t SW_WRONG_LENGTH = 0x6700;
+static const uint16_t SW_SECURITY = 0x6982;           // Writes: the emulated tag is read-only
+static const uint16_t SW_NO_FILE_SELECTED = 0x6986;
+static const uint16_t SW_NOT_FOUND = 0x6A82;
+static const uint16_t SW_WRONG_OFFSET = 0x6B00;
+static const uint16_t SW_INS_NOT_SUPPORTED = 0x6D00;
+static const uint16_t SW_CLA_NOT_SUPPORTED = 0x6E00;
+
+static size_t status(uint8_t* response, size_t at, uint16_t sw) {
+    response[at] = sw >> 8;
+    response[at + 1] = sw & 0xFF;
+    return at + 2;
+}
+
+Type4Tag::Type4Tag() : _selected(SEL_NONE), _ndefLength(2), _served(false) {
+    const uint16_t maxNdef = sizeof(_ndef);
+    const uint8_t cc[sizeof(_cc)] = {
+        0x00, 0x0F,                           // CCLEN
+        0x20,                                 // Mapping version 2.0
+        0x00, MAX_READ,                       // MLe
+        0x00, 0x34,                           // MLc (UPDATE BINARY is refused anyway)
+        0x04, 0x06,                           // NDEF File Control TLV
+        NDEF_FILE_ID >> 8, NDEF_FILE_ID & 0xFF,
+        (uint8_t)(maxNdef >> 8), (uint8_t)(maxNdef & 0xFF),
+        0x00,                                 // Read access: granted
+        0xFF                                  // Write access: none
+    };
+    memcpy(_cc, cc, sizeof(_cc));
+    memset(_ndef, 0, sizeof(_ndef));          // NLEN 0 = empty until a URI is set
+}
+
+bool Type4Tag::setUri(const char* uri) {
+    // Encode as a Type 2 TLV, then keep only the message behind a 2-byte NLEN
+    uint8_t tlv[4 + MAX_NDEF_SIZE + 4];
+    NdefWriter writer(tlv, sizeof(tlv));
+    writer.addUri(uri);
+    size_t total = writer.finish();
+
+    const uint8_t* message;
+    size_t messageLength;
+    if (!total || !NdefReader::findMessage(tlv, total, message, messageLength) ||
+        messageLength > MAX_NDEF_SIZE) {
+        return false;
+    }
+    _ndef[0] = messageLength >> 8;
+    _ndef[1] = messageLength & 0xFF;
+    memcpy(_ndef + 2, message, messageLength);
+    _ndefLength = 2 + messageLength;
+    return true;
+}
+
+void Type4Tag::reset() {
+    _selected = SEL_NONE;
+    _served = false;
+}
+
+size_t Type4Tag::process(const uint8_t* apdu, size_t length, uint8_t* response, size_t responseSize) {
+    if (responseSize < 2) return 0;
+    if (length < 4) return status(response, 0, SW_WRONG_LENGTH);
+    if (apdu[0] != 0x00) return status(response, 0, SW_CLA_NOT_SUPPORTED);
+
+    switch (apdu[1]) {
+        case INS_SELECT:        return select(apdu, length, response);
+        case INS_READ_BINARY:   return readBinary(apdu, length, response, responseSize);
+        case INS_UPDATE_BINARY: return status(response, 0, SW_SECURITY);
+        default:                return status(response, 0, SW_INS_NOT_SUPPORTED);
+    }
+}
+
+size_t Type4Tag::select(const uint8_t* apdu, size_t length, uint8_t* response) {
+    if (length < 5 || length < 5 + (size_t)apdu[4]) return status(response, 0, SW_WRONG_LENGTH);
+    const uint8_t* data = apdu + 5;
+    uint8_t lc = apdu[4];
+
+    // By name (P1 = 04): the NDEF tag application
+    if (apdu[2] == 0x04) {
+        if (lc == sizeof(NDEF_APP_AID) && memcmp(data, NDEF_APP_AID, lc) == 0) {
+            _selected = SEL_APP;
+            return status(response, 0, SW_OK);
+        }
+        _selected = SEL_NONE;
+        return status(response, 0, SW_NOT_FOUND);
+    }
+
+    // By file id (P1 = 00), only inside the application
+    if (apdu[2] == 0x00 && lc == 2 && _selected != SEL_NONE) {
+        uint16_t fileId = (data[0] << 8) | data[1];
+        if (fileId == CC_FILE_ID) {
+            _selected = SEL_CC;
+            return status(response, 0, SW_OK);
+        }
+        if (fileId == NDEF_FILE_ID) {
+            _selected = SEL_NDEF;
+            return status(response, 0, SW_OK);
+        }
+    }
+    return status(response, 0, SW_NOT_FOUND);
+}
+
+size_t Type4Tag::readBinary(const uint8_t* apdu, size_t length, uint8_t* response, size_t responseSize) {
+    const uint8_t* file;
+    size_t fileLength;
+    if (_selected == SEL_CC) {
+        file = _cc;
+        fileLength = sizeof(_cc);
+    } else if (_selected == SEL_NDEF) {
+        file = _ndef;
+        fileLength = _ndefLength;
+    } else {
+        return status(response, 0, SW_NO_FILE_SELECTED);
+    }
+
+    size_t offset = ((apdu[2] & 0x7F) << 8) | apdu[3];
+    if (offset > fileLength) return status(response, 0, SW_WRONG_OFFSET);
+
+    // Le absent or 0 asks for as much as possible
+    size_t wanted = length >= 5 && apdu[4] ? apdu[4] : 256;
+    size_t count = fileLength - offset;
+    if (count > wanted) count = wanted;
+    if (count > MAX_READ) count = MAX_READ;
+    if (count > responseSize - 2) count = responseSize - 2;
+
+    memcpy(response, file + offset, count);
+    if (_selected == SEL_NDEF && offset + count > 2) _served = true;
+    return status(response, count, SW_OK);
+}
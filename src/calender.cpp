@@ -2,93 +2,18 @@
 #include "DisplayManager.h"
 #include <SPIFFS.h>
 #include <WiFi.h>
-#include <HTTPClient.h>
+#include "PageDownload.h"
+#include "BMPHandler.h"
+#include "HeapTelemetry.h"
+#include "RefreshArena.h"
 
-const char* CalendarManager::CALENDAR_BMP_URL = "http://192.168.1.4:3000/calendar.bmp";
+const char* CalendarManager::CALENDAR_BMP_URL = CALENDAR_BMP_URL_DEFAULT;
 
-// BMP header structure
-struct BMPHeader {
-    uint16_t signature;
-    uint32_t fileSize;
-    uint32_t reserved;
-    uint32_t dataOffset;
-    uint32_t headerSize;
-    int32_t width;
-    int32_t height;
-    uint16_t planes;
-    uint16_t bitsPerPixel;
-} __attribute__((packed));
+bool CalendarManager::downloadCalendarBMP(const char* url) {
+    if (!url) url = CALENDAR_BMP_URL;
 
-void CalendarManager::downloadCalendarBMP() {
     Serial.println("\n=== Downloading Calendar ===");
-    Serial.printf("🔗 URL: %s\n", CALENDAR_BMP_URL);
-    
-    HTTPClient http;
-    http.setTimeout(15000);
-    
-    if (!http.begin(CALENDAR_BMP_URL)) {
-        Serial.println("❌ Failed to begin HTTP request");
-        return;
-    }
-    
-    Serial.println("📡 Sending GET request...");
-    int httpCode = http.GET();
-    Serial.printf("📡 Response Code: %d\n", httpCode);
-    
-    if (httpCode != HTTP_CODE_OK) {
-        Serial.printf("❌ HTTP Error: %d\n", httpCode);
-        http.end();
-        return;
-    }
-    
-    int contentLength = http.getSize();
-    Serial.printf("📄 Content Length: %d bytes (%.1f KB)\n", 
-                 contentLength, contentLength/1024.0);
-    
-    // Remove old file
-    if (SPIFFS.exists("/calendar.bmp")) {
-        SPIFFS.remove("/calendar.bmp");
-    }
-    
-    // Create new file
-    File file = SPIFFS.open("/calendar.bmp", "w");
-    if (!file) {
-        Serial.println("❌ Failed to create file");
-        http.end();
-        return;
-    }
-    
-    // Download
-    WiFiClient* stream = http.getStreamPtr();
-    uint8_t buf[1024];
-    size_t totalBytes = 0;
-    
-    Serial.println("⬇️ Downloading...");
-    while (http.connected() && (contentLength <= 0 || totalBytes < contentLength)) {
-        size_t available = stream->available();
-        if (available) {
-            size_t readBytes = stream->readBytes(buf, min(sizeof(buf), available));
-            if (readBytes == 0) break;
-            
-            file.write(buf, readBytes);
-            totalBytes += readBytes;
-            
-            // Progress
-            if (contentLength > 0) {
-                int progress = (totalBytes * 100) / contentLength;
-                if (progress % 25 == 0) {
-                    Serial.printf("⬇️ Progress: %d%%\n", progress);
-                }
-            }
-        } else {
-            delay(10);
-        }
-    }
-    
-    file.close();
-    http.end();
-    
-    Serial.printf("✅ Downloaded: %u bytes\n", totalBytes);
+    return downloadToFile(url, CALENDAR_BMP_PATH);
 }
 
 void CalendarManager::displayCalendar() {
@@ -96,36 +21,67 @@ void CalendarManager::displayCalendar() {
     Serial.println("Using full display area (800x480)");
     
     // Use full window for calendar page
+    FrameHasher hasher("calendar");
+    hashFile(hasher, CALENDAR_BMP_PATH);
+    if (!beginFrame(hasher.value(), "Calendar page")) return;
+    
+    bool drawn = true;
     display.setFullWindow();
     display.firstPage();
     do {
         display.fillScreen(GxEPD_WHITE);
         
         // Draw calendar full screen
-        if (SPIFFS.exists("/calendar.bmp")) {
-            drawBMPFromFile("/calendar.bmp");
+        if (SPIFFS.exists(CALENDAR_BMP_PATH)) {
+            drawn = drawBMPFromFile(CALENDAR_BMP_PATH) && drawn;
         } else {
             display.setTextColor(GxEPD_BLACK);
             display.setCursor(10, 30);  // Position near top of screen
             display.print("Calendar not available");
         }
     } while (display.nextPage());
+    if (drawn) commitFrame();
+    else invalidateFrame();   // A page bailed out part way
     
     Serial.println("✅ Calendar page displayed!");
 }
 
-void CalendarManager::drawBMPFromFile(const char* filename) {
+void CalendarManager::displayCalendarRegion(int16_t x, int16_t y, int16_t w, int16_t h) {
+    Serial.printf("\n=== Partial Calendar Refresh: %d,%d %dx%d ===\n", x, y, w, h);
+    // The region refresh leaves the panel showing the full page, so elide against that
+    FrameHasher hasher("calendar");
+    hashFile(hasher, CALENDAR_BMP_PATH);
+    if (!beginFrame(hasher.value(), "Calendar page")) return;
+    
+    unsigned long startTime = millis();
+    
+    // Only the changed window is transferred and refreshed
+    display.setPartialWindow(x, y, w, h);
+    bool drawn = true;
+    display.firstPage();
+    do {
+        display.fillScreen(GxEPD_WHITE);
+        drawn = drawBMPFromFile(CALENDAR_BMP_PATH, y, y + h - 1) && drawn;
+    } while (display.nextPage());
+    if (drawn) commitFrame();
+    else invalidateFrame();
+    
+    Serial.printf("✅ Partial refresh done in %lu ms\n", millis() - startTime);
+}
+
+bool CalendarManager::drawBMPFromFile(const char* filename, int16_t rowFrom, int16_t rowTo) {
+    HeapScope heapScope(HEAP_DISPLAY);
     File file = SPIFFS.open(filename, "r");
     if (!file) {
         Serial.println("❌ Failed to open BMP file");
-        return;
+        return false;
     }
     
     BMPHeader header;
     if (file.size() < sizeof(BMPHeader)) {
         Serial.println("❌ Invalid BMP file size");
         file.close();
-        return;
+        return false;
     }
     
     file.read((uint8_t*)&header, sizeof(BMPHeader));
@@ -133,7 +89,7 @@ void CalendarManager::drawBMPFromFile(const char* filename) {
     if (header.signature != 0x4D42) {
         Serial.printf("❌ Invalid BMP signature: 0x%04X\n", header.signature);
         file.close();
-        return;
+        return false;
     }
     
     Serial.printf("🖼️ BMP: %dx%d, %d-bit\n", 
@@ -144,36 +100,35 @@ void CalendarManager::drawBMPFromFile(const char* filename) {
         Serial.printf("\u26a0️ Warning: Calendar BMP should be 800x480, got %dx%d\n", header.width, header.height);
     }
     
-    // Seek to image data
-    file.seek(header.dataOffset);
-    
     // Calculate row size (padded to 4 bytes)
-    int rowSize = ((header.width * header.bitsPerPixel + 31) / 32) * 4;
-    uint8_t* rowBuffer = (uint8_t*)malloc(rowSize);
+    int rowSize = bmpRowSize(header);
+    ArenaScope arena("Page draw", ArenaBudget::PAGE_DRAW);
+    uint8_t* rowBuffer = (uint8_t*)RefreshArena::alloc(rowSize);
     
     if (!rowBuffer) {
-        Serial.println("❌ Memory allocation failed");
+        Serial.println("❌ BMP row does not fit the refresh arena");
         file.close();
-        return;
+        return false;
     }
     
-    // Draw BMP (bottom-to-top)
-    for (int y = header.height - 1; y >= 0; y--) {
-        file.read(rowBuffer, rowSize);
+    // Draw BMP (bottom-to-top), only rows rowFrom..rowTo
+    if (rowFrom < 0) rowFrom = 0;
+    if (rowTo < 0 || rowTo >= header.height) rowTo = header.height - 1;
+    file.seek(header.dataOffset + (uint32_t)(header.height - 1 - rowTo) * rowSize);
+    
+    for (int y = rowTo; y >= rowFrom; y--) {
+        if (file.read(rowBuffer, rowSize) != (size_t)rowSize) {
+            Serial.printf("❌ BMP truncated at row %d\n", y);
+            file.close();
+            return false;
+        }
         
-        for (int x = 0; x < header.width; x++) {
-            if (header.bitsPerPixel == 1) {
-                int byteIndex = x / 8;
-                int bitIndex = 7 - (x % 8);
-                bool pixel = (rowBuffer[byteIndex] >> bitIndex) & 1;
-                
-                uint16_t color = pixel ? GxEPD_WHITE : GxEPD_BLACK;
-                // Direct pixel mapping - no scaling
-                display.drawPixel(x, y, color);
-            }
+        if (header.bitsPerPixel == 1) {
+            // Direct pixel mapping - no scaling
+            bmpDrawRow1(display, rowBuffer, header.width, y);
         }
     }
     
-    free(rowBuffer);
     file.close();
+    return true;
 }
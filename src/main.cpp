@@ -1,9 +1,11 @@
 #include <Arduino.h>
 #include <HardwareSerial.h>
+#include <inttypes.h>
 #include "DisplayManager.h"
 #include "calender.h"
 #include "800x420.h"
 #include "800x480.h"
+#include "BMPHandler.h"
 #include "QRCodeManager.h"
 #include "WifiPortal.h"
 #include "Location.h"
@@ -11,48 +13,145 @@
 #include "OpenWeather.h"
 #include "NFC.h"
 #include "DHT22.h"
+#include "ClimateLog.h"
+#include "Config.h"
+#include "ContentSync.h"
+#include "FetchScheduler.h"
+#include "FixedString.h"
+#include "HeapTelemetry.h"
+#include "RefreshArena.h"
+#include "RefreshTimer.h"
+#include "SelfBench.h"
+#include "Metrics.h"
 #include <WiFi.h>
-#include <HTTPClient.h>
+#include "NetTrace.h"
 #include <Fonts/FreeSansBold12pt7b.h>
 #include <Fonts/FreeSans9pt7b.h>
 
-
-// Constants for refresh intervals
-const unsigned long MIN_REFRESH_INTERVAL = 20000;     // Minimum time between any refresh (20s)
-
 // Global instances
 LocationManager locationManager;
 NTPClient ntpClient;
 OpenWeather weather;
 NFCManager nfcManager;
 DHT22Manager dht22;
+FetchScheduler scheduler;
+
+// Scheduler source ids
+int srcTime = -1;
+int srcLocation = -1;
+int srcWeather = -1;
+int srcManifest = -1;
+int srcContent = -1;
+int srcCalendar = -1;
+int srcFullScreen = -1;
 
 // Flag to indicate all pages have been shown
 bool allPagesDisplayed = false;
 
-// No global variables needed for basic display functionality
+// Set once the NFC task reports any tag, to tell boot times with and without one apart
+bool nfcTagSeen = false;
+
+void handleNfcEvent(const NfcEvent& event) {
+    Metrics::recordNfc(event);
+    switch (event.type) {
+        case NFC_EVENT_READY:        Serial.printf("✅ NFC ready at %" PRIu32 " ms\n", event.atMs); break;
+        case NFC_EVENT_INIT_FAILED:  Serial.println("⚠️ NFC initialization failed, tags won't be provisioned"); break;
+        case NFC_EVENT_TAG_ARRIVED:  nfcTagSeen = true; Serial.printf("🏷️ NFC tag arrived at %" PRIu32 " ms\n", event.atMs); break;
+        case NFC_EVENT_TAG_CURRENT:  Serial.printf("✅ Tag already contains the correct URL (%" PRIu32 " ms)\n", event.tookMs); break;
+        case NFC_EVENT_TAG_WRITTEN:  Serial.printf("✅ Tag provisioned in %" PRIu32 " ms (%u writes total)\n", event.tookMs, nfcManager.getWriteCount()); break;
+        case NFC_EVENT_WRITE_FAILED: Serial.println("⚠️ Failed to write/verify the tag URL"); break;
+        case NFC_EVENT_TAG_REMOVED:  Serial.println("🏷️ NFC tag removed"); break;
+        case NFC_EVENT_URL_SERVED:   nfcTagSeen = true; Serial.printf("📡 Card URL read by a phone (%" PRIu32 " ms)\n", event.tookMs); break;
+        case NFC_EVENT_BENCH_DONE:   break;   // SelfBench waits for it; only a late one ends up here
+    }
+}
 
-// No helper functions needed for basic display functionality
+void drainNfcEvents() {
+    NfcEvent event;
+    while (nfcManager.pollEvent(event)) {
+        handleNfcEvent(event);
+    }
+}
+
+// ---- Scheduler fetch functions (one attempt each) ----
+bool fetchTime() {
+    return ntpClient.update();
+}
+
+bool fetchLocation() {
+    return locationManager.updateLocation();
+}
+
+bool fetchWeather() {
+    return weather.updateWeather(locationManager.getCurrentLocation());
+}
+
+bool fetchManifest() {
+    if (!ContentSync::fetchManifest()) return false;
+
+    // Follow the TTLs the server advertises
+    scheduler.setTtl(srcManifest, ContentSync::getManifestTtlMs());
+    scheduler.setTtl(srcContent, ContentSync::getTtlMs("content"));
+    scheduler.setTtl(srcCalendar, ContentSync::getTtlMs("calendar"));
+    scheduler.setTtl(srcFullScreen, ContentSync::getTtlMs("fullscreen"));
+    return true;
+}
+
+bool fetchContentPage() {
+    return ContentSync::syncPage("content") != SYNC_FAILED;
+}
+
+bool fetchCalendarPage() {
+    return ContentSync::syncPage("calendar") != SYNC_FAILED;
+}
+
+bool fetchFullScreenPage() {
+    SyncResult result = ContentSync::syncPage("fullscreen");
+
+    // The full screen page stays visible once the sequence is done; redraw what changed
+    if (result == SYNC_UPDATED && allPagesDisplayed) {
+        DirtyRect dirty = ContentSync::getDirtyRect("fullscreen");
+        if (dirty.isEmpty()) {
+            FullScreenManager::displayFullScreen();
+        } else {
+            FullScreenManager::displayFullScreenRegion(dirty.x, dirty.y, dirty.w, dirty.h);
+        }
+    }
+    return result != SYNC_FAILED;
+}
+
+void setupScheduler() {
+    srcTime     = scheduler.addSource("time", fetchTime, TIME_TTL_MS, TIME_STALE_MS);
+    srcLocation = scheduler.addSource("location", fetchLocation, LOCATION_TTL_MS, LOCATION_STALE_MS);
+    srcWeather  = scheduler.addSource("weather", fetchWeather, WEATHER_TTL_MS, WEATHER_STALE_MS);
+#if USE_CONTENT_MANIFEST
+    srcManifest = scheduler.addSource("manifest", fetchManifest, DEFAULT_MANIFEST_TTL_S * 1000UL, PAGE_STALE_MS);
+#endif
+    srcContent    = scheduler.addSource("content", fetchContentPage, DEFAULT_PAGE_TTL_S * 1000UL, PAGE_STALE_MS);
+    srcCalendar   = scheduler.addSource("calendar", fetchCalendarPage, DEFAULT_PAGE_TTL_S * 1000UL, PAGE_STALE_MS);
+    srcFullScreen = scheduler.addSource("fullscreen", fetchFullScreenPage, DEFAULT_PAGE_TTL_S * 1000UL, PAGE_STALE_MS);
+}
 
 bool updateDashboardBMP() {
+    HeapScope heapScope(HEAP_HTTP);
     // Step 1: Update location
     if (!locationManager.updateLocation()) {
         Serial.println("❌ Failed to get location");
         return false;
     }
 
-    LocationData loc = locationManager.getCurrentLocation();
-    Serial.println("🌍 Location detected: " + locationManager.getLocationString());
+    const LocationData& loc = locationManager.getCurrentLocation();
+    Serial.printf("🌍 Location detected: %s\n", locationManager.getLocationString());
 
     // Step 2: Build dashboard URL
-    String dashboardURL = "http://192.168.1.4:5000/dashboard?lat=" + String(loc.latitude, 6) +
-                          "&lon=" + String(loc.longitude, 6);
+    FixedString<128> dashboardURL;
+    dashboardURL.appendf("%s?lat=%.6f&lon=%.6f", DASHBOARD_BMP_URL, loc.latitude, loc.longitude);
 
-    Serial.println("📥 Downloading BMP from: " + dashboardURL);
+    Serial.printf("📥 Downloading BMP from: %s\n", dashboardURL.c_str());
 
     // Step 3: HTTP GET request to fetch BMP
-    HTTPClient http;
-    http.begin(dashboardURL);
+    TracedHTTPClient http;
+    http.begin(dashboardURL.c_str());
     
     bool success = false;
     
@@ -65,7 +164,7 @@ bool updateDashboardBMP() {
             Serial.printf("Content length: %d bytes\n", contentLength);
 
             if (contentLength > 0) {
-                WiFiClient* stream = http.getStreamPtr();
+                Stream* stream = http.getStreamPtr();
                 if (stream) {
                     // Read BMP header (54 bytes)
                     uint8_t header[54];
@@ -77,15 +176,14 @@ bool updateDashboardBMP() {
                         display.setPartialWindow(0, MAIN_CONTENT_Y, 800, MAIN_CONTENT_HEIGHT);
                         
                         // Read and write image data in chunks
-                        uint8_t buffer[800];  // One row at a time
-                        bool dataError = false;
+                        ArenaScope arena("Dashboard", ArenaBudget::DASHBOARD);
+                        uint8_t* buffer = (uint8_t*)RefreshArena::alloc(ARENA_DASHBOARD_ROW);  // One row at a time
+                        bool dataError = !buffer;
                         
                         for (int y = 0; y < MAIN_CONTENT_HEIGHT && !dataError; y++) {
                             size_t bytesRead = stream->readBytes(buffer, 800);
                             if (bytesRead == 800) {
-                                for (int x = 0; x < 800; x++) {
-                                    display.drawPixel(x, MAIN_CONTENT_Y + y, buffer[x] < 128 ? GxEPD_BLACK : GxEPD_WHITE);
-                                }
+                                bmpDrawRow8(display, buffer, 800, MAIN_CONTENT_Y + y);
                             } else {
                                 Serial.printf("❌ Data read error at row %d: got %d bytes\n", y, bytesRead);
                                 dataError = true;
@@ -93,6 +191,7 @@ bool updateDashboardBMP() {
                         }
                         
                         if (!dataError) {
+                            invalidateFrame();  // Streamed straight to the panel, not hashed
                             display.display(false);
                             Serial.println("✅ Dashboard BMP downloaded and displayed successfully!");
                             success = true;
@@ -107,7 +206,7 @@ bool updateDashboardBMP() {
                 Serial.println("❌ Invalid content length");
             }
         } else {
-            Serial.println("⚠️ Failed to download BMP, HTTP code: " + String(httpCode));
+            Serial.printf("⚠️ Failed to download BMP, HTTP code: %d\n", httpCode);
         }
     } catch (const std::exception& e) {
         Serial.printf("❌ Exception during BMP download: %s\n", e.what());
@@ -117,13 +216,19 @@ bool updateDashboardBMP() {
     return success;
 }
 
-bool updateWakeImageBMP(String imageURL) {
+bool updateWakeImageBMP(const char* imageURL) {
+    HeapScope heapScope(HEAP_HTTP);
     // Fetch wake-up image (800x420)
-    String wakeURL = "http://192.168.1.4:5000/wake_image?url=" + imageURL;
-    Serial.println("📥 Downloading wake-up BMP from: " + wakeURL);
+    FixedString<256> wakeURL;
+    wakeURL.appendf("%s?url=%s", WAKE_IMAGE_URL, imageURL);
+    if (wakeURL.truncated()) {
+        Serial.println("❌ Wake image URL too long");
+        return false;
+    }
+    Serial.printf("📥 Downloading wake-up BMP from: %s\n", wakeURL.c_str());
 
-    HTTPClient http;
-    http.begin(wakeURL);
+    TracedHTTPClient http;
+    http.begin(wakeURL.c_str());
     bool success = false;
 
     try {
@@ -135,7 +240,7 @@ bool updateWakeImageBMP(String imageURL) {
             Serial.printf("Content length: %d bytes\n", contentLength);
 
             if (contentLength > 0) {
-                WiFiClient* stream = http.getStreamPtr();
+                Stream* stream = http.getStreamPtr();
                 if (stream) {
                     // Read BMP header (54 bytes)
                     uint8_t header[54] = {0};
@@ -149,16 +254,14 @@ bool updateWakeImageBMP(String imageURL) {
                             display.setPartialWindow(0, 0, 800, 420);  // Full width, wake image height
                             
                             // Read and write image data in chunks
-                            uint8_t buffer[800] = {0};  // One row at a time
-                            bool dataError = false;
+                            ArenaScope arena("Wake image", ArenaBudget::DASHBOARD);
+                            uint8_t* buffer = (uint8_t*)RefreshArena::alloc(ARENA_DASHBOARD_ROW);  // One row at a time
+                            bool dataError = !buffer;
                             
                             for (int y = 0; y < 420 && !dataError; y++) {
                                 size_t bytesRead = stream->readBytes(buffer, 800);
                                 if (bytesRead == 800) {
-                                    for (int x = 0; x < 800; x++) {
-                                        display.drawPixel(x, y, 
-                                            buffer[x] < 128 ? GxEPD_BLACK : GxEPD_WHITE);
-                                    }
+                                    bmpDrawRow8(display, buffer, 800, y);
                                 } else {
                                     Serial.printf("❌ Data read error at row %d: got %d bytes\n", 
                                         y, bytesRead);
@@ -167,6 +270,7 @@ bool updateWakeImageBMP(String imageURL) {
                             }
                             
                             if (!dataError) {
+                                invalidateFrame();  // Streamed straight to the panel, not hashed
                                 display.display(false);
                                 Serial.println("✅ Wake-up BMP downloaded and displayed successfully!");
                                 success = true;
@@ -184,7 +288,7 @@ bool updateWakeImageBMP(String imageURL) {
                 Serial.println("❌ Invalid content length");
             }
         } else {
-            Serial.println("⚠️ Failed to download wake BMP, HTTP code: " + String(httpCode));
+            Serial.printf("⚠️ Failed to download wake BMP, HTTP code: %d\n", httpCode);
         }
     } catch (const std::exception& e) {
         Serial.printf("❌ Exception during BMP download: %s\n", e.what());
@@ -198,11 +302,29 @@ void setup() {
   Serial.begin(115200);
   delay(200);
 
+  setupScheduler();
+
+  // The RTC keeps the clock across deep sleep and reboots: valid before WiFi is up
+  if (ntpClient.restoreClock()) {
+    scheduler.markCached(srcTime);
+  }
+
+  // Last known location from NVS: the status bar has it before any network traffic
+  if (locationManager.begin()) {
+    scheduler.markCached(srcLocation);
+  }
+
+  // Tags are provisioned from the NFC task; boot and rendering never wait on it
+  if (!nfcManager.startTask(NFC_CARD_URL)) {
+    Serial.println("⚠️ NFC task could not be started");
+  }
+  SelfBench::begin(nfcManager, handleNfcEvent);
+
   // Initialize DHT22
   if (!DHT22Manager::begin()) {
     Serial.println("❌ DHT22 initialization failed");
   } else {
-    Serial.println("✅ DHT22 initialized");
+    Serial.println("✅ DHT22 sampling in the background");
   }
 
   // Initialize SPIFFS
@@ -211,6 +333,8 @@ void setup() {
       return;
   }
   Serial.println("✅ SPIFFS initialized");
+  ClimateLog::begin();
+  NetTrace::begin();
   
   Serial.println("Starting E-ink Display Setup");
   
@@ -237,134 +361,107 @@ void setup() {
 
     delay(1000); // stabilize
 
-    // Initialize NFC first after WiFi
-    Serial.println("Initializing NFC...");
-    if (!nfcManager.begin()) {
-      Serial.println("⚠️ NFC initialization failed");
-      return;  // Don't proceed if NFC init fails
-    }
-    Serial.println("✅ NFC initialized");
-    
-    // Write URL to the first detected tag - 3 attempts only
-    const char* url = "http://192.168.1.4:3000/Bcard";
-
-    // const char* url = "http://192.168.3.120:3000/Bcard";
-    String current_url;
-    Serial.println("Waiting for NFC tag to write URL (3 attempts)...");
-    
-    // First try to read the current URL
-    if (nfcManager.readTag(current_url)) {
-      if (current_url == url) {
-        Serial.println("✅ Tag already contains the correct URL - proceeding with setup");
-      } else {
-        // URL is different, try to write the new one
-        if (!nfcManager.writeURLOnce(url, 3)) {  // Try 3 times only
-          Serial.println("⚠️ Failed to write/verify URL after 3 attempts. System cannot proceed.");
-          return;  // Don't proceed if we can't write the tag
-        }
-      }
-    } else {
-      // Couldn't read the tag, try to write the new URL
-      if (!nfcManager.writeURLOnce(url, 3)) {  // Try 3 times only
-        Serial.println("⚠️ Failed to write/verify URL after 3 attempts. System cannot proceed.");
-        return;  // Don't proceed if we can't write the tag
-      }
-    }
-
-    delay(1000); // stabilize
-
     // Initialize NTP client for IST (GMT+5:30)
     Serial.println("⏰ Initializing NTP...");
-    ntpClient.begin("pool.ntp.org", 19800, 0);
-    delay(1000);
+    ntpClient.begin("pool.ntp.org", 19800, 0);  // Syncs in the background, never blocks
 
-    if (ntpClient.update()) {
-      Serial.println("✅ Time synchronized");
-    } else {
-      Serial.println("⚠️ Initial time sync failed, will retry in loop");
-    }
+    // One attempt each on boot; failures are retried from loop() with backoff
 
-    // Location + weather once on boot
+    // Location + weather once on boot; a cached location is revalidated later from loop()
     Serial.println("📍 Getting location...");
-    if (locationManager.updateLocation()) {
+    if (scheduler.isUsable(srcLocation) || scheduler.refreshNow(srcLocation)) {
       Serial.println("✅ Location obtained");
       Serial.println("🌤️ Getting weather...");
-      LocationData loc = locationManager.getCurrentLocation();
-      if (weather.updateWeather(loc)) {
+      if (scheduler.refreshNow(srcWeather)) {
         Serial.println("✅ Weather obtained");
       }
     }
 
+#if USE_CONTENT_MANIFEST
+    // One request tells us which page images changed since they were cached
+    if (!scheduler.refreshNow(srcManifest)) {
+      Serial.println("⚠️ Manifest unavailable, downloading pages from fixed URLs");
+    }
+#endif
+
     // Show dashboard with content image below status bar (3rd page)
-    ContentManager::downloadContentBMP();  // Download the 800x420 image
+    scheduler.refreshNow(srcContent);      // Download the 800x420 image if it changed
     ContentManager::displayContent();      // Display status bar and content image
-    delay(60000);  // Show for 60 seconds
+    delay(ContentSync::getDwellMs("content"));
 
     // Download and show calendar as the fourth page
     Serial.println("Loading calendar page...");
-    CalendarManager::downloadCalendarBMP();
+    scheduler.refreshNow(srcCalendar);
     CalendarManager::displayCalendar();
-    delay(60000);  // Show calendar for 60 seconds
+    delay(ContentSync::getDwellMs("calendar"));
 
     // Download and show full screen image as the fifth page
     Serial.println("Loading full screen page...");
-    FullScreenManager::downloadFullScreenBMP();
+    scheduler.refreshNow(srcFullScreen);
     FullScreenManager::displayFullScreen();
+    ContentSync::printStats();
     
     // Mark that all pages have been displayed
     allPagesDisplayed = true;
+    // Only the full screen page is drawn from here on: stop fetching what no page shows.
+    // Time keeps the clock for logs and refresh timing; the manifest drives the full screen page.
+    scheduler.pause(srcLocation);
+    scheduler.pause(srcWeather);
+    scheduler.pause(srcContent);
+    scheduler.pause(srcCalendar);
     Serial.println("✅ All pages have been displayed. Display sequence complete.");
   } else {
     Serial.println("⚠️ Not connected to WiFi; QR screen will remain visible until connected.");
   }
+  Metrics::begin();
 
-  Serial.println("Setup complete!");
+  drainNfcEvents();
+  Serial.printf("Setup complete in %lu ms (NFC tag %s, %" PRIu32 " ms on tags, %" PRIu32 " writes total)\n", millis(),
+                nfcTagSeen ? "seen during boot" : "not present", nfcManager.getBusyMs(), nfcManager.getWriteCount());
 }
 
 void loop() {
-    // If all pages have been displayed, do nothing
-    if (allPagesDisplayed) {
-        delay(1000);  // Just keep the system alive
-        return;
-    }
+    unsigned long loopStart = millis();
     
-    unsigned long currentMillis = millis();
+    drainNfcEvents();
     
-    static unsigned long lastRefreshCheck = 0;
-    // Enforce minimum time between any refresh operations
-    if (currentMillis - lastRefreshCheck < MIN_REFRESH_INTERVAL) {
-        delay(100);
-        return;
-    }
-    lastRefreshCheck = currentMillis;
-    
-    // Check if it's time for full refresh (every hour)
-    checkAndRefresh();  // This function in DisplayManager handles the timing check
-    
-
-
-    // Additional periodic updates if needed
+    // At most one due fetch per pass; each source follows its own TTL and backoff
     if (WiFi.status() == WL_CONNECTED) {
-        Serial.println("Hourly refresh cycle starting...");
+        int refreshed = scheduler.tick();
         
-        // Update location first
-        if (locationManager.updateLocation()) {
-            Serial.println("✅ Location updated");
-            
-            // Then update weather using new location
-            if (WiFi.status() == WL_CONNECTED) {
-                LocationData loc = locationManager.getCurrentLocation();
-                if (weather.updateWeather(loc)) {
-                    Serial.println("✅ Weather updated");
-                }
-            }
-            
-            // Finally, refresh the display with new data
-            showDashboard();
-            lastFullRefresh = currentMillis;
-            Serial.println("Location and weather updates completed");
+        // Location and weather only show up on the status bar pages
+        if (!allPagesDisplayed && (refreshed == srcLocation || refreshed == srcWeather)) {
+            showDashboard();  // Elided when nothing visible changed
+            lastFullRefresh = millis();
         }
     }
     
+    if (!allPagesDisplayed) {
+        // Check if it's time for full refresh (every hour)
+        checkAndRefresh();  // This function in DisplayManager handles the timing check
+    }
+    
+    static unsigned long lastStatsPrint = 0;
+    if (millis() - lastStatsPrint >= 3600000UL) {
+        lastStatsPrint = millis();
+        scheduler.printStats();
+        ContentSync::printStats();
+        ntpClient.printStats();
+        RefreshTimer::printStats();
+        DHT22Manager::printStats();
+        ClimateLog::printStats();
+    }
+    HeapTelemetry::poll();
+    ClimateLog::poll();
+    Metrics::poll();
+
+    // Serial bench commands; the display bench leaves the panel blank
+    if (SelfBench::poll()) {
+        if (allPagesDisplayed) FullScreenManager::displayFullScreen();
+        else if (WiFi.status() == WL_CONNECTED) showDashboard();
+        else showQRCode("WIFI:T:nopass;S:ThumbstackTech;;");
+    }
+    
+    scheduler.recordLoopTime(millis() - loopStart);
     delay(100);  // Small delay for loop responsiveness
 }
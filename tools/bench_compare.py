@@ -0,0 +1,44 @@
+"""Compares two result files written by the host benchmarks (bench/bench.cpp).
+
+    python bench_compare.py base.json new.json --threshold 10
+
+Prints the change per benchmark and exits with 1 when any got slower by more
+than the threshold (percent of ns/op) or started allocating.
+"""
+import argparse
+import json
+
+
+def load(path):
+    with open(path) as f:
+        return {r["name"]: r for r in json.load(f)["results"]}
+
+
+def compare(args):
+    base, new = load(args.base), load(args.new)
+    failed = False
+    print(f"{'benchmark':22} {'base ns/op':>12} {'new ns/op':>12} {'change':>8}  allocs")
+    for name, r in new.items():
+        b = base.get(name)
+        if not b:
+            print(f"{name:22} {'-':>12} {r['ns_per_op']:12.0f} {'new':>8}  {r['allocs_per_run']:.2f}")
+            continue
+        change = (r["ns_per_op"] / b["ns_per_op"] - 1) * 100
+        slower = change > args.threshold
+        allocs = r["allocs_per_run"] > b["allocs_per_run"]
+        failed |= slower or allocs
+        mark = " <-- slower" if slower else ""
+        mark += " <-- allocates" if allocs else ""
+        print(f"{name:22} {b['ns_per_op']:12.0f} {r['ns_per_op']:12.0f} {change:+7.1f}%  "
+              f"{b['allocs_per_run']:.2f} -> {r['allocs_per_run']:.2f}{mark}")
+    for name in base.keys() - new.keys():
+        print(f"{name:22} missing from {args.new}")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("base")
+    parser.add_argument("new")
+    parser.add_argument("--threshold", type=float, default=10.0, help="allowed slowdown in percent")
+    raise SystemExit(compare(parser.parse_args()))
@@ -0,0 +1,262 @@
+"""Local stand-in for the content server (port 3000).
+
+Serves the page BMPs from a directory together with a generated /manifest.json,
+and counts requests and bytes so firmware traffic can be compared with and
+without the manifest (USE_CONTENT_MANIFEST in include/Config.h).
+
+    python content_server.py serve --dir pages/          # point the device at this host
+    python content_server.py bench --hours 1 --poll 300  # emulate the device modes locally
+
+Tile endpoints (see include/TileSync.h): /tiles/<file> returns one little-endian
+CRC32 per 80x30 tile, /tiles/<file>?ids=1,2 returns those tiles' rows.
+
+The native simulator (pio run -e native, lib/HostSim) sends every request here with
+the original Host header, so the public APIs it calls are answered from UPSTREAM.
+"""
+import argparse
+import hashlib
+import http.server
+import json
+import os
+import struct
+import tempfile
+import threading
+import urllib.error
+import urllib.request
+import zlib
+
+# Page id -> (file name, format, ttl seconds, dwell seconds), mirrors include/Config.h
+PAGES = {
+    "content": ("image_800x420.bmp", "bmp1", 3600, 60),
+    "calendar": ("calendar.bmp", "bmp1", 3600, 60),
+    "fullscreen": ("image_800x480.bmp", "bmp1", 3600, 60),
+}
+MANIFEST_TTL = 300
+
+# Canned replies for the public APIs, keyed by Host header (simulator only)
+UPSTREAM = {
+    "api.ipify.org": (b"203.0.113.7", "text/plain"),
+    "ipinfo.io": (b'{"ip":"203.0.113.7","city":"Amsterdam","region":"North Holland",'
+                  b'"country":"NL","loc":"52.3740,4.8897"}', "application/json"),
+    "api.openweathermap.org": (b'{"weather":[{"id":803,"main":"Clouds","icon":"04d"}],'
+                               b'"main":{"temp":14.2,"humidity":71},"name":"Amsterdam"}', "application/json"),
+}
+TILE_W, TILE_H = 80, 30
+
+
+def content_hash(data):
+    return hashlib.sha1(data).hexdigest()[:16]
+
+
+def build_manifest(directory):
+    pages = []
+    for page_id, (name, fmt, ttl, dwell) in PAGES.items():
+        path = os.path.join(directory, name)
+        if not os.path.exists(path):
+            continue
+        with open(path, "rb") as f:
+            data = f.read()
+        pages.append({"id": page_id, "url": "/" + name, "hash": content_hash(data),
+                      "size": len(data), "format": fmt, "ttl": ttl, "dwell": dwell,
+                      "tiles": "/tiles/" + name})
+    return json.dumps({"ttl": MANIFEST_TTL, "pages": pages}, separators=(",", ":")).encode()
+
+
+def read_tiles(path):
+    """Split a 1-bit BMP into top-down tile byte strings, row-major."""
+    with open(path, "rb") as f:
+        data = f.read()
+    offset, = struct.unpack_from("<I", data, 10)
+    width, height = struct.unpack_from("<ii", data, 18)
+    row_size = ((width + 31) // 32) * 4
+    tiles = []
+    for ty in range(height // TILE_H):
+        for tx in range(width // TILE_W):
+            rows = []
+            for r in range(TILE_H):
+                y = ty * TILE_H + r
+                start = offset + (height - 1 - y) * row_size + tx * TILE_W // 8
+                rows.append(data[start:start + TILE_W // 8])
+            tiles.append(b"".join(rows))
+    return tiles
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.reset()
+
+    def reset(self):
+        self.requests = 0
+        self.body_bytes = 0
+        self.not_modified = 0
+
+    def add(self, body_len, status):
+        with self.lock:
+            self.requests += 1
+            self.body_bytes += body_len
+            if status == 304:
+                self.not_modified += 1
+
+
+def make_handler(directory, stats):
+    class Handler(http.server.BaseHTTPRequestHandler):
+        def log_message(self, fmt, *args):
+            pass
+
+        def send_body(self, status, body, content_type, etag=None):
+            stats.add(len(body), status)  # Count before replying so the client never races the counters
+            self.send_response(status)
+            self.send_header("Content-Type", content_type)
+            self.send_header("Content-Length", str(len(body)))
+            if etag:
+                self.send_header("ETag", etag)
+            self.end_headers()
+            self.wfile.write(body)
+
+        def do_GET(self):
+            path = self.path.split("?")[0]
+            upstream = UPSTREAM.get(self.headers.get("Host", "").split(":")[0])
+            if upstream:
+                return self.send_body(200, upstream[0], upstream[1])
+            if path == "/manifest.json":
+                body = build_manifest(directory)
+                etag = '"%s"' % content_hash(body)
+                if self.headers.get("If-None-Match") == etag:
+                    return self.send_body(304, b"", "application/json", etag)
+                return self.send_body(200, body, "application/json", etag)
+            if path.startswith("/tiles/"):
+                file_path = os.path.join(directory, os.path.basename(path))
+                if not os.path.isfile(file_path):
+                    return self.send_body(404, b"", "text/plain")
+                tiles = read_tiles(file_path)
+                query = self.path.partition("?ids=")[2]
+                if not query:
+                    body = b"".join(struct.pack("<I", zlib.crc32(t)) for t in tiles)
+                else:
+                    body = b"".join(tiles[int(i)] for i in query.split(","))
+                return self.send_body(200, body, "application/octet-stream")
+            if path == "/stats":
+                body = json.dumps({"requests": stats.requests, "bytes": stats.body_bytes,
+                                   "not_modified": stats.not_modified}).encode()
+                return self.send_body(200, body, "application/json")
+            file_path = os.path.join(directory, os.path.basename(path))
+            if not os.path.isfile(file_path):
+                return self.send_body(404, b"", "text/plain")
+            with open(file_path, "rb") as f:
+                return self.send_body(200, f.read(), "image/bmp")
+
+    return Handler
+
+
+def write_test_bmp(path, width, height, seed):
+    """1-bit BMP whose 80x30 'cell' at the top left changes with seed (a typical one-cell edit)."""
+    row_size = ((width + 31) // 32) * 4
+    palette = b"\x00\x00\x00\x00\xff\xff\xff\x00"
+    offset = 14 + 40 + len(palette)
+    pixels = bytearray(row_size * height)
+    for y in range(height):
+        for x in range(0, width // 8):
+            cell = x < TILE_W // 8 and (height - 1 - y) < TILE_H
+            pixels[y * row_size + x] = (x * 7 + y * 3 + (seed if cell else 0)) & 0xFF
+    header = struct.pack("<2sIHHI", b"BM", offset + len(pixels), 0, 0, offset)
+    info = struct.pack("<IiiHHIIiiII", 40, width, height, 1, 1, 0, len(pixels), 2835, 2835, 2, 0)
+    with open(path, "wb") as f:
+        f.write(header + info + palette + pixels)
+
+
+class EmulatedDevice:
+    """Replays the firmware's sync logic for one mode: "fixed", "manifest" or "tiles"."""
+
+    def __init__(self, base, mode):
+        self.base = base
+        self.mode = mode
+        self.cache = {}
+        self.tile_cache = {}
+        self.etag = None
+
+    def get(self, url, headers=None):
+        req = urllib.request.Request(self.base + url, headers=headers or {})
+        return urllib.request.urlopen(req)
+
+    def poll(self):
+        if self.mode == "fixed":
+            for name, _, _, _ in PAGES.values():
+                self.get("/" + name).read()
+            return
+        try:
+            resp = self.get("/manifest.json", {"If-None-Match": self.etag} if self.etag else None)
+        except urllib.error.HTTPError as e:
+            if e.code == 304:
+                return
+            raise
+        self.etag = resp.headers.get("ETag")
+        for page in json.loads(resp.read())["pages"]:
+            if self.cache.get(page["id"]) == page["hash"]:
+                continue
+            self.cache[page["id"]] = page["hash"]
+            if self.mode == "tiles" and page["id"] in self.tile_cache:
+                remote = self.get(page["tiles"]).read()
+                local = self.tile_cache[page["id"]]
+                ids = [str(i // 4) for i in range(0, len(remote), 4) if remote[i:i + 4] != local[i:i + 4]]
+                self.get(page["tiles"] + "?ids=" + ",".join(ids)).read()
+                self.tile_cache[page["id"]] = remote
+                continue
+            self.get(page["url"]).read()
+            if self.mode == "tiles":
+                self.tile_cache[page["id"]] = self.get(page["tiles"]).read()
+
+
+def bench(args):
+    directory = tempfile.mkdtemp()
+    stats = Stats()
+    server = http.server.ThreadingHTTPServer(("127.0.0.1", 0), make_handler(directory, stats))
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    base = "http://127.0.0.1:%d" % server.server_address[1]
+    calendar = os.path.join(directory, PAGES["calendar"][0])
+
+    polls = int(args.hours * 3600 / args.poll)
+    print("Emulating %.1f h, poll every %d s (%d polls), one calendar cell edited every %d polls"
+          % (args.hours, args.poll, polls, args.edit_every))
+    for mode in ("fixed", "manifest", "tiles"):
+        write_test_bmp(os.path.join(directory, PAGES["content"][0]), 800, 420, 0)
+        write_test_bmp(calendar, 800, 480, 0)
+        write_test_bmp(os.path.join(directory, PAGES["fullscreen"][0]), 800, 480, 0)
+        stats.reset()
+        device = EmulatedDevice(base, mode)
+        for poll in range(polls):
+            if args.edit_every and poll and poll % args.edit_every == 0:
+                write_test_bmp(calendar, 800, 480, poll)
+            device.poll()
+        hourly = (stats.requests / args.hours, stats.body_bytes / 1024.0 / args.hours)
+
+        # Cost of a single one-cell edit on a warm cache
+        stats.reset()
+        write_test_bmp(calendar, 800, 480, polls + 1)
+        device.poll()
+        print("%-10s requests/h: %6.1f  KB/h: %8.1f  | per edit: %d requests, %d bytes"
+              % ((mode,) + hourly + (stats.requests, stats.body_bytes)))
+    server.shutdown()
+
+
+def serve(args):
+    stats = Stats()
+    server = http.server.ThreadingHTTPServer(("0.0.0.0", args.port), make_handler(args.dir, stats))
+    print("Serving %s on port %d (manifest at /manifest.json, counters at /stats)" % (args.dir, args.port))
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    p = sub.add_parser("serve")
+    p.add_argument("--dir", default=".")
+    p.add_argument("--port", type=int, default=3000)
+    p.set_defaults(func=serve)
+    p = sub.add_parser("bench")
+    p.add_argument("--hours", type=float, default=1.0)
+    p.add_argument("--poll", type=int, default=MANIFEST_TTL)
+    p.add_argument("--edit-every", type=int, default=6)
+    p.set_defaults(func=bench)
+    args = parser.parse_args()
+    args.func(args)
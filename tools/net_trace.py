@@ -0,0 +1,90 @@
+"""Works with the HTTP traces written by NetTrace (include/NetTrace.h).
+
+    python net_trace.py extract monitor.log net.trace   # "NT:" lines of a serial log -> trace file
+    python net_trace.py list net.trace                  # One line per recorded exchange
+
+A trace extracted from a NET_TRACE_CAPTURE_SERIAL log, or dumped from the device,
+is replayed by copying it to NET_TRACE_PATH on SPIFFS (or SIM_FS_DIR on the host)
+and building with NET_TRACE=NET_TRACE_REPLAY.
+"""
+import argparse
+import re
+import struct
+
+MAGIC = b"NTR1"
+HEX_LINE = re.compile(r"NT:([0-9a-f]+)\s*$")   # Monitor timestamps may precede it
+
+
+def extract(args):
+    data = bytearray()
+    with open(args.log, errors="replace") as f:
+        for line in f:
+            m = HEX_LINE.search(line)
+            if m:
+                data += bytes.fromhex(m.group(1))
+    if not data.startswith(MAGIC):
+        print(f"{args.log}: no trace found (missing {MAGIC.decode()} header)")
+        return 1
+    with open(args.trace, "wb") as f:
+        f.write(data)
+    print(f"{args.trace}: {len(data)} bytes")
+    return 0
+
+
+def exchanges(data):
+    pos = len(MAGIC)
+    while pos < len(data) and data[pos:pos + 1] == b"X":
+        (url_len,) = struct.unpack_from("<H", data, pos + 1)
+        pos += 3
+        url = data[pos:pos + url_len].decode(errors="replace")
+        pos += url_len
+        start_ms, latency_us, status, size, header_count = struct.unpack_from("<IIhiB", data, pos)
+        pos += 15
+        headers = {}
+        for _ in range(header_count):
+            name_len = data[pos]
+            name = data[pos + 1:pos + 1 + name_len].decode(errors="replace")
+            pos += 1 + name_len
+            (value_len,) = struct.unpack_from("<H", data, pos)
+            headers[name] = data[pos + 2:pos + 2 + value_len].decode(errors="replace")
+            pos += 2 + value_len
+        body, chunks, last_us = 0, 0, 0
+        while pos < len(data) and data[pos:pos + 1] == b"C":
+            last_us, length = struct.unpack_from("<IH", data, pos + 1)
+            pos += 7 + length
+            body += length
+            chunks += 1
+        if data[pos:pos + 1] != b"E":
+            yield url, start_ms, latency_us, status, size, headers, body, chunks, last_us, False
+            return
+        pos += 1
+        yield url, start_ms, latency_us, status, size, headers, body, chunks, last_us, True
+
+
+def list_trace(args):
+    with open(args.trace, "rb") as f:
+        data = f.read()
+    if not data.startswith(MAGIC):
+        print(f"{args.trace}: not a trace")
+        return 1
+    print(f"{'start ms':>9} {'status':>6} {'latency':>9} {'body':>8} {'chunks':>6} {'read':>9}  url")
+    for url, start_ms, latency_us, status, size, headers, body, chunks, last_us, complete in exchanges(data):
+        extra = " ".join(f"{k}={v}" for k, v in headers.items() if v)
+        mark = "" if complete else "  (truncated)"
+        print(f"{start_ms:9} {status:6} {latency_us / 1000:7.1f}ms {body:8} {chunks:6} {last_us / 1000:7.1f}ms  "
+              f"{url} {extra}{mark}")
+    return 0
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+    p = sub.add_parser("extract", help="serial log -> trace file")
+    p.add_argument("log")
+    p.add_argument("trace")
+    p.set_defaults(func=extract)
+    p = sub.add_parser("list", help="print the recorded exchanges")
+    p.add_argument("trace")
+    p.set_defaults(func=list_trace)
+    args = parser.parse_args()
+    raise SystemExit(args.func(args))